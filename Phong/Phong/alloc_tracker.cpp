@@ -0,0 +1,167 @@
+#include "alloc_tracker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+thread_local unsigned long long tAllocationCount = 0;
+// NOTE: Set while reporting a strict mode violation, so the report itself may allocate
+static thread_local bool tReporting = false;
+
+std::atomic<unsigned long long> AllocationTracker::sAllocations(0);
+std::atomic<unsigned long long> AllocationTracker::sBytes(0);
+std::atomic<unsigned long long> AllocationTracker::sFrees(0);
+thread_local unsigned long long AllocationTracker::tBytes = 0;
+thread_local bool AllocationTracker::tStrictArmed = false;
+unsigned long long AllocationTracker::sFrameStartAllocations = 0;
+unsigned long long AllocationTracker::sFrameStartBytes = 0;
+FrameAllocationStats AllocationTracker::sLastFrame = { 0 };
+FrameAllocationStats AllocationTracker::sFrameTotal = { 0 };
+unsigned AllocationTracker::sFrameCount = 0;
+unsigned AllocationTracker::sAllocatingFrames = 0;
+unsigned AllocationTracker::sWarmupFrames = 0;
+bool AllocationTracker::sStrict = false;
+
+void
+AllocationTracker::BeginFrame() {
+    sFrameStartAllocations = tAllocationCount;
+    sFrameStartBytes = tBytes;
+    if (sStrict && sFrameCount >= sWarmupFrames) {
+        tStrictArmed = true;
+    }
+}
+
+void
+AllocationTracker::EndFrame() {
+    tStrictArmed = false;
+    sLastFrame.mAllocations = tAllocationCount - sFrameStartAllocations;
+    sLastFrame.mBytes = tBytes - sFrameStartBytes;
+    sFrameTotal.mAllocations += sLastFrame.mAllocations;
+    sFrameTotal.mBytes += sLastFrame.mBytes;
+    if (sLastFrame.mAllocations && sFrameCount >= sWarmupFrames) {
+        ++sAllocatingFrames;
+    }
+    ++sFrameCount;
+}
+
+void
+AllocationTracker::SetStrict(unsigned warmupFrames) {
+    sStrict = true;
+    sWarmupFrames = warmupFrames;
+}
+
+unsigned long long
+AllocationTracker::GetAllocationCount() {
+    return sAllocations.load(std::memory_order_relaxed);
+}
+
+unsigned long long
+AllocationTracker::GetAllocatedBytes() {
+    return sBytes.load(std::memory_order_relaxed);
+}
+
+unsigned long long
+AllocationTracker::GetFreeCount() {
+    return sFrees.load(std::memory_order_relaxed);
+}
+
+const FrameAllocationStats&
+AllocationTracker::GetLastFrame() {
+    return sLastFrame;
+}
+
+const FrameAllocationStats&
+AllocationTracker::GetFrameTotal() {
+    return sFrameTotal;
+}
+
+unsigned
+AllocationTracker::GetAllocatingFrames() {
+    return sAllocatingFrames;
+}
+
+unsigned
+AllocationTracker::GetFrameCount() {
+    return sFrameCount;
+}
+
+#ifndef PHONG_DISABLE_ALLOC_TRACKING
+
+static void*
+TrackedAllocate(std::size_t size) {
+    AllocationTracker::OnAllocate(size);
+    if (!tReporting && AllocationTracker::IsStrictArmed()) {
+        tReporting = true;
+        // NOTE: stdio, not iostream, and no exceptions. Break here in a debugger to see the culprit
+        fprintf(stderr, "[Err] Heap allocation of %llu bytes inside steady state frame %u\n",
+            (unsigned long long)size, AllocationTracker::GetFrameCount());
+        fflush(stderr);
+        abort();
+    }
+    return malloc(size ? size : 1);
+}
+
+void*
+operator new(std::size_t size) {
+    void* Memory = TrackedAllocate(size);
+    if (!Memory) {
+        throw std::bad_alloc();
+    }
+    return Memory;
+}
+
+void*
+operator new[](std::size_t size) {
+    void* Memory = TrackedAllocate(size);
+    if (!Memory) {
+        throw std::bad_alloc();
+    }
+    return Memory;
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return TrackedAllocate(size);
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return TrackedAllocate(size);
+}
+
+void
+operator delete(void* memory) noexcept {
+    if (memory) {
+        AllocationTracker::OnFree();
+        free(memory);
+    }
+}
+
+void
+operator delete[](void* memory) noexcept {
+    if (memory) {
+        AllocationTracker::OnFree();
+        free(memory);
+    }
+}
+
+void
+operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+void
+operator delete[](void* memory, std::size_t) noexcept {
+    operator delete[](memory);
+}
+
+void
+operator delete(void* memory, const std::nothrow_t&) noexcept {
+    operator delete(memory);
+}
+
+void
+operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    operator delete[](memory);
+}
+
+#endif
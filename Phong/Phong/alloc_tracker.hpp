@@ -0,0 +1,110 @@
+/**
+ * @file alloc_tracker.hpp
+ * @brief Heap allocation counting through global operator new/delete, per frame and per profiler zone
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <atomic>
+
+// NOTE: Allocations made by the calling thread, read by profiler zones to attribute allocations
+extern thread_local unsigned long long tAllocationCount;
+
+struct FrameAllocationStats {
+    unsigned long long mAllocations;
+    unsigned long long mBytes;
+};
+
+/**
+ * @brief Counts every allocation going through operator new on any thread. Define
+ * PHONG_DISABLE_ALLOC_TRACKING to keep the standard operators and count nothing
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief Opens a frame on the calling thread. Only that thread's allocations until EndFrame are
+     * charged to it, workers, the simulation and loading jobs keep allocating freely
+     *
+     */
+    static void BeginFrame();
+
+    /**
+     * @brief Closes the frame opened by BeginFrame, on the same thread
+     *
+     */
+    static void EndFrame();
+
+    /**
+     * @brief Makes any allocation of the frame's thread inside a frame fatal once warmup frames have passed.
+     * The first frames fill caches, reserve vectors and register threads, steady state must not allocate
+     *
+     * @param warmupFrames Frames allowed to allocate
+     */
+    static void SetStrict(unsigned warmupFrames);
+
+    static unsigned long long GetAllocationCount();
+    static unsigned long long GetAllocatedBytes();
+    static unsigned long long GetFreeCount();
+    static const FrameAllocationStats& GetLastFrame();
+    static const FrameAllocationStats& GetFrameTotal();
+
+    /**
+     * @brief Frames that allocated at all, after warmup when strict mode is set
+     *
+     */
+    static unsigned GetAllocatingFrames();
+    static unsigned GetFrameCount();
+    static bool IsStrictArmed();
+
+    /**
+     * @brief Called by operator new, not meant to be used directly
+     *
+     * @param size Requested size in bytes
+     */
+    static void OnAllocate(unsigned long long size);
+
+    /**
+     * @brief Called by operator delete, not meant to be used directly
+     *
+     */
+    static void OnFree();
+
+private:
+    static std::atomic<unsigned long long> sAllocations;
+    static std::atomic<unsigned long long> sBytes;
+    static std::atomic<unsigned long long> sFrees;
+    // NOTE: Bytes allocated by the calling thread, the frame's share is taken from these
+    static thread_local unsigned long long tBytes;
+    // NOTE: Only ever set on the thread between BeginFrame and EndFrame
+    static thread_local bool tStrictArmed;
+    static unsigned long long sFrameStartAllocations;
+    static unsigned long long sFrameStartBytes;
+    static FrameAllocationStats sLastFrame;
+    static FrameAllocationStats sFrameTotal;
+    static unsigned sFrameCount;
+    static unsigned sAllocatingFrames;
+    static unsigned sWarmupFrames;
+    static bool sStrict;
+};
+
+inline void
+AllocationTracker::OnAllocate(unsigned long long size) {
+    ++tAllocationCount;
+    tBytes += size;
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+    sBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+inline void
+AllocationTracker::OnFree() {
+    sFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline bool
+AllocationTracker::IsStrictArmed() {
+    return tStrictArmed;
+}
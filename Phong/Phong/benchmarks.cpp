@@ -0,0 +1,585 @@
+#include "benchmarks.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "jobs.hpp"
+#include "command_buffer.hpp"
+#include "upload_ring.hpp"
+#include "shader.hpp"
+#include "scene.hpp"
+#include "profiler.hpp"
+#include "mesh.hpp"
+#include "linear_arena.hpp"
+#include "alloc_tracker.hpp"
+#include "index_encoding.hpp"
+#include "gl_handle.hpp"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+
+struct BenchmarkObject {
+    glm::vec3 mPosition;
+    glm::vec3 mScale;
+    float mYaw;
+    float mRadius;
+};
+
+struct BenchmarkDrawData {
+    glm::mat4 mModel;
+    glm::mat4 mNormalMatrix;
+    bool mVisible;
+};
+
+// NOTE: Same kind of work Scene does per draw, scaled up to a scene size where it matters
+static void
+PrepareObjects(const BenchmarkObject* objects, BenchmarkDrawData* out, const glm::vec4* planes, unsigned begin, unsigned end) {
+    for (unsigned ObjectIdx = begin; ObjectIdx < end; ++ObjectIdx) {
+        const BenchmarkObject& Object = objects[ObjectIdx];
+        BenchmarkDrawData& Data = out[ObjectIdx];
+
+        bool Visible = true;
+        for (unsigned PlaneIdx = 0; PlaneIdx < 6 && Visible; ++PlaneIdx) {
+            const glm::vec4& Plane = planes[PlaneIdx];
+            Visible = glm::dot(glm::vec3(Plane.x, Plane.y, Plane.z), Object.mPosition) + Plane.w > -Object.mRadius;
+        }
+        Data.mVisible = Visible;
+        if (!Visible) {
+            continue;
+        }
+
+        glm::mat4 Model = glm::translate(glm::mat4(1.0f), Object.mPosition);
+        Model = glm::rotate(Model, Object.mYaw, glm::vec3(0.0f, 1.0f, 0.0f));
+        Model = glm::scale(Model, Object.mScale);
+        Data.mModel = Model;
+        Data.mNormalMatrix = glm::transpose(glm::inverse(Model));
+    }
+}
+
+static void
+ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4* planes) {
+    const glm::mat4& M = viewProjection;
+    for (unsigned Axis = 0; Axis < 3; ++Axis) {
+        glm::vec4 Row(M[0][Axis], M[1][Axis], M[2][Axis], M[3][Axis]);
+        glm::vec4 W(M[0][3], M[1][3], M[2][3], M[3][3]);
+        planes[Axis * 2] = W + Row;
+        planes[Axis * 2 + 1] = W - Row;
+    }
+    for (unsigned PlaneIdx = 0; PlaneIdx < 6; ++PlaneIdx) {
+        glm::vec4& Plane = planes[PlaneIdx];
+        float Length = glm::length(glm::vec3(Plane.x, Plane.y, Plane.z));
+        Plane = Plane * (1.0f / Length);
+    }
+}
+
+void
+Benchmarks::RunJobScaling(unsigned maxThreads) {
+    const unsigned ObjectCount = 200000;
+    const unsigned Iterations = 20;
+    const unsigned Grain = 512;
+    if (!maxThreads) {
+        maxThreads = std::thread::hardware_concurrency();
+    }
+    maxThreads = maxThreads < 1 ? 1 : maxThreads;
+
+    std::vector<BenchmarkObject> Objects(ObjectCount);
+    std::vector<BenchmarkDrawData> DrawData(ObjectCount);
+    // NOTE: Deterministic layout so every thread count does identical work
+    unsigned Seed = 12345;
+    for (unsigned ObjectIdx = 0; ObjectIdx < ObjectCount; ++ObjectIdx) {
+        Seed = Seed * 1664525 + 1013904223;
+        float X = (Seed >> 8 & 0xFFFF) / 65535.0f * 200.0f - 100.0f;
+        Seed = Seed * 1664525 + 1013904223;
+        float Z = (Seed >> 8 & 0xFFFF) / 65535.0f * 200.0f - 100.0f;
+        Objects[ObjectIdx].mPosition = glm::vec3(X, 0.0f, Z);
+        Objects[ObjectIdx].mScale = glm::vec3(1.0f + (ObjectIdx % 7) * 0.1f);
+        Objects[ObjectIdx].mYaw = (ObjectIdx % 360) * 0.0174f;
+        Objects[ObjectIdx].mRadius = 1.5f;
+    }
+
+    glm::mat4 Projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 150.0f);
+    glm::mat4 View = glm::lookAt(glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(0.0f, 5.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec4 Planes[6];
+    ExtractFrustumPlanes(Projection * View, Planes);
+
+    std::cout << "Job system scaling: " << ObjectCount << " objects, " << Iterations << " iterations, grain " << Grain << std::endl;
+    double SingleThreadTime = 0.0;
+    for (unsigned ThreadCount = 1; ThreadCount <= maxThreads; ++ThreadCount) {
+        JobSystem Jobs;
+        Jobs.Init(ThreadCount);
+
+        const BenchmarkObject* ObjectData = Objects.data();
+        BenchmarkDrawData* OutData = DrawData.data();
+        const glm::vec4* PlaneData = Planes;
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+        for (unsigned Iteration = 0; Iteration < Iterations; ++Iteration) {
+            Jobs.ParallelFor(ObjectCount, Grain, [ObjectData, OutData, PlaneData](unsigned begin, unsigned end) {
+                PrepareObjects(ObjectData, OutData, PlaneData, begin, end);
+            });
+        }
+        double Elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count() / Iterations;
+        Jobs.Shutdown();
+
+        if (ThreadCount == 1) {
+            SingleThreadTime = Elapsed;
+        }
+        std::cout << std::fixed << std::setprecision(3) << "  " << std::setw(2) << ThreadCount << " thread(s): "
+            << Elapsed * 1000.0 << " ms/iteration, speedup " << SingleThreadTime / Elapsed << "x" << std::endl;
+    }
+
+    unsigned VisibleCount = 0;
+    for (unsigned ObjectIdx = 0; ObjectIdx < ObjectCount; ++ObjectIdx) {
+        VisibleCount += DrawData[ObjectIdx].mVisible;
+    }
+    std::cout << "  " << VisibleCount << " objects visible" << std::endl;
+}
+
+struct RecordBenchmarkJobData {
+    CommandBuffer* mCommands;
+    unsigned mBegin;
+    unsigned mEnd;
+    unsigned mVAO;
+    unsigned mProgram;
+};
+
+static void
+RecordDraws(CommandBuffer& commands, unsigned begin, unsigned end, unsigned vao, unsigned program) {
+    commands.Reset();
+    commands.UseProgram(program);
+    commands.BindVertexArray(vao);
+    PerDrawBlock Block;
+    Block.NormalMatrix = glm::mat4(1.0f);
+    for (unsigned DrawIdx = begin; DrawIdx < end; ++DrawIdx) {
+        Block.Model = glm::translate(glm::mat4(1.0f), glm::vec3(DrawIdx % 100 * 0.01f, DrawIdx / 100 * 0.01f, 0.0f));
+        Block.Color = glm::vec4(1.0f, DrawIdx % 2, 0.0f, 1.0f);
+        commands.SetUniformBlock(Shader::PER_DRAW_BINDING, &Block, sizeof(Block));
+        commands.DrawArrays(GL_TRIANGLES, 0, 3);
+    }
+}
+
+static void
+RecordDrawsJob(void* data) {
+    RecordBenchmarkJobData Data;
+    memcpy(&Data, data, sizeof(Data));
+    RecordDraws(*Data.mCommands, Data.mBegin, Data.mEnd, Data.mVAO, Data.mProgram);
+}
+
+void
+Benchmarks::RunCommandReplay(unsigned drawCount) {
+    const unsigned Iterations = 50;
+    drawCount = drawCount ? drawCount : 10000;
+
+    float Triangle[] = { -0.01f, -0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                          0.01f, -0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+                          0.0f,   0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 0.5f, 1.0f };
+    unsigned VAO = 0;
+    unsigned VBO = 0;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Triangle), Triangle, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    Shader ColorShader("shaders/color.vert", "shaders/color.frag");
+    ColorShader.SetUniformBlockBinding("PerFrame", Shader::PER_FRAME_BINDING);
+    ColorShader.SetUniformBlockBinding("PerDraw", Shader::PER_DRAW_BINDING);
+
+    // NOTE: Every draw gets its own aligned block, so size the ring from the real alignment
+    int Alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+    Alignment = Alignment > (int)sizeof(PerDrawBlock) ? Alignment : 256;
+    UploadRing Ring;
+    if (!Ring.Init((drawCount + 1) * Alignment, 1)) {
+        glDeleteBuffers(1, &VBO);
+        glDeleteVertexArrays(1, &VAO);
+        return;
+    }
+
+    PerFrameBlock FrameUniforms;
+    FrameUniforms.Projection = glm::mat4(1.0f);
+    FrameUniforms.View = glm::mat4(1.0f);
+    FrameUniforms.ViewPos = glm::vec4(0.0f);
+
+    JobSystem Jobs;
+    Jobs.Init(0);
+    std::vector<CommandBuffer> Chunks(Jobs.GetThreadCount());
+    CommandBuffer Serial;
+
+    double DirectTime = 0.0;
+    double RecordTime = 0.0;
+    double ParallelRecordTime = 0.0;
+    double ReplayTime = 0.0;
+    typedef std::chrono::high_resolution_clock Clock;
+    for (unsigned Iteration = 0; Iteration < Iterations; ++Iteration) {
+        // NOTE: Direct submission, what Scene did before command buffers
+        Ring.BeginFrame();
+        Ring.WriteUniform(Shader::PER_FRAME_BINDING, &FrameUniforms, sizeof(FrameUniforms));
+        Clock::time_point Start = Clock::now();
+        glUseProgram(ColorShader.GetId());
+        glBindVertexArray(VAO);
+        PerDrawBlock Block;
+        Block.NormalMatrix = glm::mat4(1.0f);
+        for (unsigned DrawIdx = 0; DrawIdx < drawCount; ++DrawIdx) {
+            Block.Model = glm::translate(glm::mat4(1.0f), glm::vec3(DrawIdx % 100 * 0.01f, DrawIdx / 100 * 0.01f, 0.0f));
+            Block.Color = glm::vec4(1.0f, DrawIdx % 2, 0.0f, 1.0f);
+            Ring.WriteUniform(Shader::PER_DRAW_BINDING, &Block, sizeof(Block));
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        DirectTime += std::chrono::duration<double>(Clock::now() - Start).count();
+        Ring.EndFrame();
+        glFinish();
+
+        Start = Clock::now();
+        RecordDraws(Serial, 0, drawCount, VAO, ColorShader.GetId());
+        RecordTime += std::chrono::duration<double>(Clock::now() - Start).count();
+
+        Start = Clock::now();
+        JobCounter Counter;
+        unsigned ChunkSize = (drawCount + Chunks.size() - 1) / Chunks.size();
+        for (unsigned ChunkIdx = 0; ChunkIdx < Chunks.size(); ++ChunkIdx) {
+            unsigned Begin = ChunkIdx * ChunkSize < drawCount ? ChunkIdx * ChunkSize : drawCount;
+            unsigned End = Begin + ChunkSize < drawCount ? Begin + ChunkSize : drawCount;
+            RecordBenchmarkJobData Data = { &Chunks[ChunkIdx], Begin, End, VAO, ColorShader.GetId() };
+            Jobs.Run(RecordDrawsJob, &Data, sizeof(Data), &Counter);
+        }
+        Jobs.Wait(&Counter);
+        ParallelRecordTime += std::chrono::duration<double>(Clock::now() - Start).count();
+
+        Ring.BeginFrame();
+        Ring.WriteUniform(Shader::PER_FRAME_BINDING, &FrameUniforms, sizeof(FrameUniforms));
+        Start = Clock::now();
+        for (unsigned ChunkIdx = 0; ChunkIdx < Chunks.size(); ++ChunkIdx) {
+            Chunks[ChunkIdx].Execute(Ring);
+        }
+        ReplayTime += std::chrono::duration<double>(Clock::now() - Start).count();
+        Ring.EndFrame();
+        glFinish();
+    }
+    Jobs.Shutdown();
+
+    unsigned CommandCount = Serial.GetCommandCount();
+    double ToNs = 1e9 / Iterations;
+    std::cout << "Command replay: " << drawCount << " draws, " << CommandCount << " commands, "
+        << Serial.GetSize() / 1024 << " KB per frame, " << Iterations << " iterations" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << "  direct submission: " << DirectTime * ToNs / drawCount << " ns/draw" << std::endl
+        << "  record, 1 thread: " << RecordTime * ToNs / CommandCount << " ns/command" << std::endl
+        << "  record, " << Chunks.size() << " threads: " << ParallelRecordTime * ToNs / CommandCount << " ns/command" << std::endl
+        << "  replay: " << ReplayTime * ToNs / CommandCount << " ns/command, "
+        << ReplayTime * ToNs / drawCount << " ns/draw" << std::endl;
+    if (Ring.GetTotalStats().mOverflows) {
+        std::cerr << "[Warn] Upload ring overflowed " << Ring.GetTotalStats().mOverflows << " times, results include dropped draws" << std::endl;
+    }
+
+    Ring.Destroy();
+    glDeleteBuffers(1, &VBO);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void
+Benchmarks::RunProfilerOverhead() {
+    // NOTE: Stays below the ring capacity so the enabled run never wraps
+    const unsigned ZoneCount = ProfileThreadBuffer::CAPACITY - 1;
+    const unsigned Iterations = 50;
+    typedef std::chrono::high_resolution_clock Clock;
+
+    Profiler::Init();
+    double Times[2] = { 0.0, 0.0 };
+    for (unsigned Enabled = 0; Enabled < 2; ++Enabled) {
+        Profiler::SetEnabled(Enabled != 0);
+        for (unsigned Iteration = 0; Iteration < Iterations; ++Iteration) {
+            Clock::time_point Start = Clock::now();
+            for (unsigned ZoneIdx = 0; ZoneIdx < ZoneCount; ++ZoneIdx) {
+                PROFILE_ZONE("Overhead");
+            }
+            Times[Enabled] += std::chrono::duration<double>(Clock::now() - Start).count();
+        }
+    }
+    Profiler::Shutdown();
+
+    double Zones = (double)ZoneCount * Iterations;
+    std::cout << std::fixed << std::setprecision(1) << "Profiler overhead over " << ZoneCount * Iterations << " zones: "
+        << Times[1] * 1e9 / Zones << " ns/zone enabled, " << Times[0] * 1e9 / Zones << " ns/zone disabled" << std::endl;
+}
+
+// NOTE: Mesh conversion as it was before the import arena, kept as the baseline to compare against
+static void
+ConvertMeshWithVectors(const aiMesh* mesh, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+    const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
+    for (unsigned VertexIndex = 0; VertexIndex < mesh->mNumVertices; ++VertexIndex) {
+        std::vector<float> Position = { mesh->mVertices[VertexIndex].x, mesh->mVertices[VertexIndex].y, mesh->mVertices[VertexIndex].z };
+        vertices.insert(vertices.end(), Position.begin(), Position.end());
+        std::vector<float> Normals = { mesh->mNormals[VertexIndex].x, mesh->mNormals[VertexIndex].y, mesh->mNormals[VertexIndex].z };
+        vertices.insert(vertices.end(), Normals.begin(), Normals.end());
+        const aiVector3D* TexCoords = mesh->HasTextureCoords(0) ? &(mesh->mTextureCoords[0][VertexIndex]) : &Zero3D;
+        std::vector<float> UV = { TexCoords->x, TexCoords->y };
+        vertices.insert(vertices.end(), UV.begin(), UV.end());
+    }
+
+    for (unsigned FaceIndex = 0; FaceIndex < mesh->mNumFaces; ++FaceIndex) {
+        const aiFace& Face = mesh->mFaces[FaceIndex];
+        indices.push_back(Face.mIndices[0]);
+        indices.push_back(Face.mIndices[1]);
+        indices.push_back(Face.mIndices[2]);
+    }
+}
+
+void
+Benchmarks::RunModelImport(const char* path) {
+    const unsigned Iterations = 10;
+    path = path ? path : "res/alduin/alduin-dragon.obj";
+    typedef std::chrono::high_resolution_clock Clock;
+
+    Assimp::Importer Importer;
+    unsigned long long StartAllocations = AllocationTracker::GetAllocationCount();
+    Clock::time_point Start = Clock::now();
+    const aiScene* Scene = Importer.ReadFile(path, aiProcess_Triangulate);
+    double ReadTime = std::chrono::duration<double>(Clock::now() - Start).count();
+    unsigned long long ReadAllocations = AllocationTracker::GetAllocationCount() - StartAllocations;
+    if (!Scene || !Scene->mRootNode) {
+        std::cerr << "[Err] Failed to load model:" << std::endl << Importer.GetErrorString() << std::endl;
+        return;
+    }
+
+    unsigned VertexCount = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+        VertexCount += Scene->mMeshes[MeshIdx]->mNumVertices;
+        if (!Scene->mMeshes[MeshIdx]->mNormals) {
+            std::cerr << "[Err] " << path << " has meshes without normals, the vector baseline can't convert it" << std::endl;
+            return;
+        }
+    }
+
+    unsigned ArenaSize = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+        ArenaSize += Mesh::GetImportSize(Scene->mMeshes[MeshIdx]);
+    }
+
+    // NOTE: Both paths have to produce identical buffers, checked once outside the timed runs
+    bool Matches = true;
+    {
+        LinearArena Arena;
+        Arena.Init(ArenaSize);
+        for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+            std::vector<float> Vertices;
+            std::vector<unsigned> Indices;
+            ConvertMeshWithVectors(Scene->mMeshes[MeshIdx], Vertices, Indices);
+            MeshImportData Data;
+            Matches &= Mesh::Import(Scene->mMeshes[MeshIdx], Arena, Data)
+                && Data.mVertexCount * Mesh::VERTEX_STRIDE == Vertices.size() && Data.mIndexCount == Indices.size()
+                && !memcmp(Data.mVertices, Vertices.data(), Vertices.size() * sizeof(float))
+                && !memcmp(Data.mIndices, Indices.data(), Indices.size() * sizeof(unsigned));
+        }
+    }
+
+    double Times[2] = { 0.0, 0.0 };
+    unsigned long long Allocations[2] = { 0, 0 };
+    for (unsigned Iteration = 0; Iteration < Iterations; ++Iteration) {
+        StartAllocations = AllocationTracker::GetAllocationCount();
+        Start = Clock::now();
+        std::vector<std::vector<float> > Vertices(Scene->mNumMeshes);
+        std::vector<std::vector<unsigned> > Indices(Scene->mNumMeshes);
+        for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+            ConvertMeshWithVectors(Scene->mMeshes[MeshIdx], Vertices[MeshIdx], Indices[MeshIdx]);
+        }
+        Times[0] += std::chrono::duration<double>(Clock::now() - Start).count();
+        Allocations[0] += AllocationTracker::GetAllocationCount() - StartAllocations;
+
+        StartAllocations = AllocationTracker::GetAllocationCount();
+        Start = Clock::now();
+        unsigned ImportSize = 0;
+        for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+            ImportSize += Mesh::GetImportSize(Scene->mMeshes[MeshIdx]);
+        }
+        LinearArena Arena;
+        Arena.Init(ImportSize);
+        for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+            MeshImportData Data;
+            Mesh::Import(Scene->mMeshes[MeshIdx], Arena, Data);
+        }
+        Arena.Release();
+        Times[1] += std::chrono::duration<double>(Clock::now() - Start).count();
+        Allocations[1] += AllocationTracker::GetAllocationCount() - StartAllocations;
+    }
+
+    // NOTE: Same arena import with one task per mesh, the way Model::Load runs it
+    JobSystem Jobs;
+    Jobs.Init(0);
+    double ParallelTime = 0.0;
+    for (unsigned Iteration = 0; Iteration < Iterations; ++Iteration) {
+        Start = Clock::now();
+        LinearArena Arena;
+        Arena.Init(ArenaSize);
+        Jobs.ParallelFor(Scene->mNumMeshes, 1, [Scene, &Arena](unsigned begin, unsigned end) {
+            for (unsigned MeshIdx = begin; MeshIdx < end; ++MeshIdx) {
+                MeshImportData Data;
+                Mesh::Import(Scene->mMeshes[MeshIdx], Arena, Data);
+            }
+        });
+        Arena.Release();
+        ParallelTime += std::chrono::duration<double>(Clock::now() - Start).count();
+    }
+    unsigned ThreadCount = Jobs.GetThreadCount();
+    Jobs.Shutdown();
+
+    std::vector<std::vector<const aiMesh*> > Groups;
+    Model::GroupMeshes(Scene, true, 0, Groups);
+    std::cout << "Model import: " << path << ", " << Scene->mNumMeshes << " meshes, " << VertexCount << " vertices, "
+        << Iterations << " iterations" << std::endl;
+    std::cout << "  merged by material: " << Groups.size() << " draws instead of " << Scene->mNumMeshes << ", "
+        << Scene->mNumMeshes - Groups.size() << " fewer" << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+        << "  assimp read: " << ReadTime * 1000.0 << " ms, " << ReadAllocations << " allocations" << std::endl
+        << "  per vertex vectors: " << Times[0] * 1000.0 / Iterations << " ms, " << Allocations[0] / Iterations << " allocations" << std::endl
+        << "  import arena: " << Times[1] * 1000.0 / Iterations << " ms, " << Allocations[1] / Iterations << " allocations, speedup "
+        << Times[0] / Times[1] << "x" << std::endl
+        << "  import arena, " << ThreadCount << " threads: " << ParallelTime * 1000.0 / Iterations << " ms, speedup "
+        << Times[1] / ParallelTime << "x over 1 thread" << std::endl;
+    if (!Matches) {
+        std::cerr << "[Warn] Import arena output differs from the vector baseline" << std::endl;
+    }
+}
+
+struct IndexBenchmarkMesh {
+    GLVertexArray mVAO;
+    GLBuffer mVBO;
+    GLBuffer mEBO;
+    EncodedIndices mEncoded;
+};
+
+void
+Benchmarks::RunIndexEncoding(const char* path) {
+    const unsigned Iterations = 200;
+    path = path ? path : "res/low-poly-fox/low-poly-fox.obj";
+    typedef std::chrono::high_resolution_clock Clock;
+
+    Assimp::Importer Importer;
+    const aiScene* Scene = Importer.ReadFile(path, aiProcess_Triangulate);
+    if (!Scene || !Scene->mRootNode) {
+        std::cerr << "[Err] Failed to load model:" << std::endl << Importer.GetErrorString() << std::endl;
+        return;
+    }
+
+    Shader ColorShader("shaders/color.vert", "shaders/color.frag");
+    ColorShader.SetUniformBlockBinding("PerFrame", Shader::PER_FRAME_BINDING);
+    ColorShader.SetUniformBlockBinding("PerDraw", Shader::PER_DRAW_BINDING);
+    UploadRing Ring;
+    if (!Ring.Init(4096, 1)) {
+        return;
+    }
+
+    // NOTE: A few pixels of output keep rasterization out of the measurement
+    glViewport(0, 0, 8, 8);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_PRIMITIVE_RESTART);
+    unsigned Query = 0;
+    glGenQueries(1, &Query);
+
+    unsigned TriangleCount = 0;
+    std::cout << "Index encoding: " << path << ", " << Scene->mNumMeshes << " meshes, " << Iterations << " iterations" << std::endl;
+    for (unsigned Encoding = 0; Encoding < INDEX_ENCODING_COUNT; ++Encoding) {
+        unsigned ArenaSize = 0;
+        for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+            ArenaSize += Mesh::GetImportSize(Scene->mMeshes[MeshIdx], (EIndexEncoding)Encoding);
+        }
+        LinearArena Arena;
+        Arena.Init(ArenaSize);
+
+        // NOTE: Only the encoding is timed, the interleaving is the same for every variant
+        std::vector<IndexBenchmarkMesh> Meshes(Scene->mNumMeshes);
+        glm::vec3 BoundsMin(3.4e38f);
+        glm::vec3 BoundsMax(-3.4e38f);
+        double EncodeTime = 0.0;
+        unsigned IndexBytes = 0;
+        TriangleCount = 0;
+        for (unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+            IndexBenchmarkMesh& Current = Meshes[MeshIdx];
+            MeshImportData Data;
+            Mesh::Import(Scene->mMeshes[MeshIdx], Arena, Data);
+            Clock::time_point Start = Clock::now();
+            IndexEncoding::Encode(Data.mIndices, Data.mIndexCount, Data.mVertexCount, (EIndexEncoding)Encoding, Arena, Current.mEncoded);
+            EncodeTime += std::chrono::duration<double>(Clock::now() - Start).count();
+            BoundsMin = glm::min(BoundsMin, Data.mBoundsMin);
+            BoundsMax = glm::max(BoundsMax, Data.mBoundsMax);
+            TriangleCount += Data.mIndexCount / 3;
+
+            unsigned MeshIndexBytes = Current.mEncoded.mCount * IndexEncoding::GetIndexSize(Current.mEncoded.mType);
+            IndexBytes += MeshIndexBytes;
+            Current.mVAO = GLVertexArray::Create();
+            glBindVertexArray(Current.mVAO.Get());
+            Current.mVBO = GLBuffer::Create();
+            glBindBuffer(GL_ARRAY_BUFFER, Current.mVBO.Get());
+            glBufferData(GL_ARRAY_BUFFER, Data.mVertexCount * Mesh::VERTEX_STRIDE * sizeof(float), Data.mVertices, GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, Mesh::VERTEX_STRIDE * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, Mesh::VERTEX_STRIDE * sizeof(float), (void*)(3 * sizeof(float)));
+            glEnableVertexAttribArray(1);
+            Current.mEBO = GLBuffer::Create();
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Current.mEBO.Get());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, MeshIndexBytes, Current.mEncoded.mData, GL_STATIC_DRAW);
+            glBindVertexArray(0);
+        }
+
+        PerFrameBlock FrameUniforms;
+        FrameUniforms.Projection = glm::mat4(1.0f);
+        FrameUniforms.View = glm::mat4(1.0f);
+        FrameUniforms.ViewPos = glm::vec4(0.0f);
+        PerDrawBlock Block;
+        // NOTE: Fits the model into clip space, so every triangle goes through the whole pipeline
+        glm::vec3 Extent = BoundsMax - BoundsMin;
+        float Size = Extent.x > Extent.y ? Extent.x : Extent.y;
+        Size = Size > Extent.z ? Size : Extent.z;
+        Size = Size > 0.0f ? Size : 1.0f;
+        Block.Model = glm::translate(glm::scale(glm::mat4(1.0f), glm::vec3(1.9f / Size)), -(BoundsMin + BoundsMax) * 0.5f);
+        Block.NormalMatrix = glm::mat4(1.0f);
+        Block.Color = glm::vec4(1.0f);
+
+        Ring.BeginFrame();
+        Ring.WriteUniform(Shader::PER_FRAME_BINDING, &FrameUniforms, sizeof(FrameUniforms));
+        Ring.WriteUniform(Shader::PER_DRAW_BINDING, &Block, sizeof(Block));
+        glUseProgram(ColorShader.GetId());
+        glFinish();
+        glBeginQuery(GL_TIME_ELAPSED, Query);
+        for (unsigned Iteration = 0; Iteration < Iterations; ++Iteration) {
+            for (unsigned MeshIdx = 0; MeshIdx < Meshes.size(); ++MeshIdx) {
+                const EncodedIndices& Encoded = Meshes[MeshIdx].mEncoded;
+                if (!Encoded.mCount) {
+                    continue;
+                }
+                glBindVertexArray(Meshes[MeshIdx].mVAO.Get());
+                glPrimitiveRestartIndex(IndexEncoding::GetRestartIndex(Encoded.mType));
+                glDrawElements(Encoded.mMode, Encoded.mCount, Encoded.mType, (void*)0);
+            }
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        Ring.EndFrame();
+        GLuint64 GpuTime = 0;
+        glGetQueryObjectui64v(Query, GL_QUERY_RESULT, &GpuTime);
+        glBindVertexArray(0);
+
+        unsigned StripCount = 0;
+        unsigned CompactCount = 0;
+        for (unsigned MeshIdx = 0; MeshIdx < Meshes.size(); ++MeshIdx) {
+            StripCount += Meshes[MeshIdx].mEncoded.mMode == GL_TRIANGLE_STRIP;
+            CompactCount += Meshes[MeshIdx].mEncoded.mType == GL_UNSIGNED_SHORT;
+        }
+        double GpuSeconds = GpuTime * 1e-9 / Iterations;
+        std::cout << std::fixed << std::setprecision(2) << "  " << IndexEncoding::GetEncodingName((EIndexEncoding)Encoding) << ": "
+            << IndexBytes / 1024.0 << " KB indices, " << CompactCount << " 16 bit, " << StripCount << " strips, encode "
+            << EncodeTime * 1000.0 << " ms, GPU " << GpuSeconds * 1000.0 << " ms/draw, "
+            << TriangleCount / GpuSeconds * 1e-6 << " Mtri/s" << std::endl;
+    }
+    std::cout << "  " << TriangleCount << " triangles per draw" << std::endl;
+
+    glDeleteQueries(1, &Query);
+    Ring.Destroy();
+}
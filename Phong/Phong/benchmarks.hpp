@@ -0,0 +1,53 @@
+/**
+ * @file benchmarks.hpp
+ * @brief Standalone micro benchmarks, run from the command line instead of the scene
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+class Benchmarks {
+public:
+    /**
+     * @brief Builds model and normal matrices and frustum culls a large object set with the job system,
+     * once per thread count from 1 to the hardware concurrency, and prints the speedup
+     *
+     * @param maxThreads Highest thread count to measure, 0 picks the hardware concurrency
+     */
+    static void RunJobScaling(unsigned maxThreads);
+
+    /**
+     * @brief Compares issuing draws directly against recording them into command buffers, serially
+     * and in parallel, and replaying them. Requires a current GL context
+     *
+     * @param drawCount Draws per frame, each one a uniform block and a draw command
+     */
+    static void RunCommandReplay(unsigned drawCount);
+
+    /**
+     * @brief Measures the cost of an empty profiler zone, enabled and disabled
+     *
+     */
+    static void RunProfilerOverhead();
+
+    /**
+     * @brief Converts every mesh of a model file into interleaved vertex and index data, once through
+     * per vertex vectors the way meshes used to be built and once through the import arena, serially and
+     * with one job per mesh, and prints time and heap allocations. Needs no GL context
+     *
+     * @param path Model file, 0 picks the alduin dragon
+     */
+    static void RunModelImport(const char* path);
+
+    /**
+     * @brief Encodes the indices of every mesh of a model as a 32 bit triangle list, a compact list and
+     * the automatic pick, then prints index memory, encode time and GPU time per draw of each.
+     * Draws into a tiny viewport so vertex work dominates. Requires a current GL context
+     *
+     * @param path Model file, 0 picks the fox
+     */
+    static void RunIndexEncoding(const char* path);
+};
@@ -51,6 +51,16 @@ Camera::GetUp() {
     return mUp;
 }
 
+void
+Camera::LookAt(const glm::vec3& position, const glm::vec3& target) {
+    glm::vec3 Direction = glm::normalize(target - position);
+    mPitch = glm::degrees(asin(std::max(-1.0f, std::min(1.0f, Direction.y))));
+    mPitch = mPitch > 89.0f ? 89.0f : mPitch < -89.0f ? -89.0f : mPitch;
+    mYaw = glm::degrees(atan2(Direction.z, Direction.x));
+    updateVectors();
+    mPosition = position;
+}
+
 void 
 Camera::updateVectors() {
     mFront.x = cos(glm::radians(mYaw)) * cos(glm::radians(mPitch));
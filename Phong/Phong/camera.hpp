@@ -55,6 +55,15 @@ public:
      */
     glm::vec3 GetUp();
 
+    /**
+     * @brief Places the camera at position looking at target. Unlike Move, the height is
+     * not clamped, so scripted paths can fly above the player height
+     *
+     * @param position Camera position
+     * @param target Point to look at
+     */
+    void LookAt(const glm::vec3& position, const glm::vec3& target);
+
 
 private:
     glm::vec3 mWorldUp;
@@ -0,0 +1,93 @@
+#include "camera_path.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+static glm::vec3
+CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+bool
+CameraPath::Load(const std::string& filename) {
+    std::ifstream Input(filename.c_str());
+    if (!Input) {
+        std::cerr << "[Err] Failed to open camera path " << filename << std::endl;
+        return false;
+    }
+
+    mKeys.clear();
+    std::string Line;
+    unsigned LineNumber = 0;
+    while (std::getline(Input, Line)) {
+        ++LineNumber;
+        if (Line.empty() || Line[0] == '#' || Line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream Fields(Line);
+        CameraKey Key;
+        if (!(Fields >> Key.mTime >> Key.mPosition.x >> Key.mPosition.y >> Key.mPosition.z
+            >> Key.mTarget.x >> Key.mTarget.y >> Key.mTarget.z)) {
+            std::cerr << "[Err] " << filename << ":" << LineNumber << ": expected \"time px py pz tx ty tz\"" << std::endl;
+            return false;
+        }
+        if (!mKeys.empty() && Key.mTime <= mKeys.back().mTime) {
+            std::cerr << "[Err] " << filename << ":" << LineNumber << ": key times must increase" << std::endl;
+            return false;
+        }
+        mKeys.push_back(Key);
+    }
+
+    if (mKeys.size() < 2) {
+        std::cerr << "[Err] Camera path " << filename << " needs at least two keys" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void
+CameraPath::Evaluate(float time, glm::vec3& position, glm::vec3& target) const {
+    if (mKeys.empty()) {
+        return;
+    }
+
+    time += mKeys.front().mTime;
+    if (time <= mKeys.front().mTime) {
+        position = mKeys.front().mPosition;
+        target = mKeys.front().mTarget;
+        return;
+    }
+    if (time >= mKeys.back().mTime) {
+        position = mKeys.back().mPosition;
+        target = mKeys.back().mTarget;
+        return;
+    }
+
+    unsigned Segment = 0;
+    while (mKeys[Segment + 1].mTime < time) {
+        ++Segment;
+    }
+
+    // NOTE: End keys are repeated so the curve still passes through them
+    unsigned Last = mKeys.size() - 1;
+    const CameraKey& K0 = mKeys[Segment ? Segment - 1 : 0];
+    const CameraKey& K1 = mKeys[Segment];
+    const CameraKey& K2 = mKeys[Segment + 1];
+    const CameraKey& K3 = mKeys[Segment + 2 <= Last ? Segment + 2 : Last];
+    float t = (time - K1.mTime) / (K2.mTime - K1.mTime);
+    position = CatmullRom(K0.mPosition, K1.mPosition, K2.mPosition, K3.mPosition, t);
+    target = CatmullRom(K0.mTarget, K1.mTarget, K2.mTarget, K3.mTarget, t);
+}
+
+float
+CameraPath::GetDuration() const {
+    return mKeys.empty() ? 0.0f : mKeys.back().mTime - mKeys.front().mTime;
+}
+
+unsigned
+CameraPath::GetKeyCount() const {
+    return mKeys.size();
+}
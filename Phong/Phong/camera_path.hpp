@@ -0,0 +1,48 @@
+/**
+ * @file camera_path.hpp
+ * @brief Scripted camera flythrough, a Catmull-Rom spline through timed keyframes
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct CameraKey {
+    float mTime;
+    glm::vec3 mPosition;
+    glm::vec3 mTarget;
+};
+
+class CameraPath {
+public:
+    /**
+     * @brief Loads keyframes from a text file. Each line holds
+     * "time px py pz tx ty tz", times strictly increasing. Lines starting with # are ignored
+     *
+     * @param filename Path file
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Load(const std::string& filename);
+
+    /**
+     * @brief Samples the spline. Times outside the path clamp to the first or last key
+     *
+     * @param time Seconds since the first key
+     * @param position Interpolated camera position
+     * @param target Interpolated look-at point
+     */
+    void Evaluate(float time, glm::vec3& position, glm::vec3& target) const;
+
+    float GetDuration() const;
+    unsigned GetKeyCount() const;
+
+private:
+    std::vector<CameraKey> mKeys;
+};
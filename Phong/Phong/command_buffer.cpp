@@ -0,0 +1,207 @@
+#include "command_buffer.hpp"
+#include "frame_stats.hpp"
+#include "index_encoding.hpp"
+#include <cstring>
+
+struct UseProgramCommand {
+    unsigned mProgram;
+};
+
+struct BindVertexArrayCommand {
+    unsigned mVAO;
+};
+
+struct BindTextureCommand {
+    unsigned mUnit;
+    unsigned mTexture;
+    unsigned mTarget;
+};
+
+struct BindSamplerCommand {
+    unsigned mUnit;
+    unsigned mSampler;
+};
+
+struct UniformBlockCommand {
+    unsigned mBinding;
+    unsigned mSize;
+};
+
+struct DrawArraysCommand {
+    unsigned mMode;
+    int mFirst;
+    unsigned mCount;
+};
+
+struct DrawElementsCommand {
+    unsigned mMode;
+    unsigned mCount;
+    unsigned mType;
+    unsigned mOffset;
+    unsigned mTriangleCount;
+};
+
+static const unsigned INITIAL_CAPACITY = 16 * 1024;
+
+CommandBuffer::CommandBuffer() {
+    mSize = 0;
+    mCommandCount = 0;
+}
+
+void
+CommandBuffer::Reset() {
+    mSize = 0;
+    mCommandCount = 0;
+}
+
+void
+CommandBuffer::UseProgram(unsigned program) {
+    UseProgramCommand Command = { program };
+    memcpy(allocateCommand(CMD_USE_PROGRAM, sizeof(Command)), &Command, sizeof(Command));
+}
+
+void
+CommandBuffer::BindVertexArray(unsigned vao) {
+    BindVertexArrayCommand Command = { vao };
+    memcpy(allocateCommand(CMD_BIND_VERTEX_ARRAY, sizeof(Command)), &Command, sizeof(Command));
+}
+
+void
+CommandBuffer::BindTexture(unsigned unit, unsigned texture, unsigned target) {
+    BindTextureCommand Command = { unit, texture, target };
+    memcpy(allocateCommand(CMD_BIND_TEXTURE, sizeof(Command)), &Command, sizeof(Command));
+}
+
+void
+CommandBuffer::BindSampler(unsigned unit, unsigned sampler) {
+    BindSamplerCommand Command = { unit, sampler };
+    memcpy(allocateCommand(CMD_BIND_SAMPLER, sizeof(Command)), &Command, sizeof(Command));
+}
+
+void
+CommandBuffer::SetUniformBlock(unsigned binding, const void* data, unsigned size) {
+    if (size > MAX_UNIFORM_BLOCK_SIZE) {
+        std::cerr << "[Err] Uniform block of " << size << " bytes is too large to record" << std::endl;
+        return;
+    }
+
+    UniformBlockCommand Command = { binding, size };
+    unsigned char* Arguments = (unsigned char*)allocateCommand(CMD_UNIFORM_BLOCK, sizeof(Command) + size);
+    memcpy(Arguments, &Command, sizeof(Command));
+    memcpy(Arguments + sizeof(Command), data, size);
+}
+
+void
+CommandBuffer::DrawArrays(unsigned mode, int first, unsigned count) {
+    DrawArraysCommand Command = { mode, first, count };
+    memcpy(allocateCommand(CMD_DRAW_ARRAYS, sizeof(Command)), &Command, sizeof(Command));
+}
+
+void
+CommandBuffer::DrawElements(unsigned mode, unsigned count, unsigned type, unsigned offset, unsigned triangleCount) {
+    DrawElementsCommand Command = { mode, count, type, offset, triangleCount };
+    memcpy(allocateCommand(CMD_DRAW_ELEMENTS, sizeof(Command)), &Command, sizeof(Command));
+}
+
+void
+CommandBuffer::Execute(UploadRing& ring) const {
+    const unsigned char* Cursor = mData.data();
+    const unsigned char* End = Cursor + mSize;
+    // NOTE: 0 is never a restart index, so the first indexed draw always sets it
+    unsigned RestartIndex = 0;
+    while (Cursor < End) {
+        CommandHeader Header;
+        memcpy(&Header, Cursor, sizeof(Header));
+        const unsigned char* Arguments = Cursor + sizeof(Header);
+        Cursor += Header.mSize;
+
+        switch (Header.mType) {
+        case CMD_USE_PROGRAM: {
+            UseProgramCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            glUseProgram(Command.mProgram);
+            FrameStats::CountProgramSwitch();
+        } break;
+        case CMD_BIND_VERTEX_ARRAY: {
+            BindVertexArrayCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            glBindVertexArray(Command.mVAO);
+            FrameStats::CountVAOBind();
+        } break;
+        case CMD_BIND_TEXTURE: {
+            BindTextureCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            glActiveTexture(GL_TEXTURE0 + Command.mUnit);
+            glBindTexture(Command.mTarget, Command.mTexture);
+            FrameStats::CountTextureBind();
+        } break;
+        case CMD_BIND_SAMPLER: {
+            BindSamplerCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            glBindSampler(Command.mUnit, Command.mSampler);
+        } break;
+        case CMD_UNIFORM_BLOCK: {
+            UniformBlockCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            ring.WriteUniform(Command.mBinding, Arguments + sizeof(Command), Command.mSize);
+        } break;
+        case CMD_DRAW_ARRAYS: {
+            DrawArraysCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            glDrawArrays(Command.mMode, Command.mFirst, Command.mCount);
+            FrameStats::CountDraw(Command.mMode, Command.mCount);
+        } break;
+        case CMD_DRAW_ELEMENTS: {
+            DrawElementsCommand Command;
+            memcpy(&Command, Arguments, sizeof(Command));
+            // NOTE: Restart is enabled for every indexed draw, lists included. The index has to follow
+            // the index width, or a 32 bit draw after a 16 bit one would treat vertex 65535 as a restart
+            if (IndexEncoding::GetRestartIndex(Command.mType) != RestartIndex) {
+                RestartIndex = IndexEncoding::GetRestartIndex(Command.mType);
+                glPrimitiveRestartIndex(RestartIndex);
+            }
+            glDrawElements(Command.mMode, Command.mCount, Command.mType, (void*)(size_t)Command.mOffset);
+            FrameStats::CountDraw(Command.mMode, Command.mCount, Command.mTriangleCount);
+        } break;
+        default: {
+            std::cerr << "[Err] Unknown command " << Header.mType << " in command buffer" << std::endl;
+            return;
+        }
+        }
+    }
+}
+
+unsigned
+CommandBuffer::GetCommandCount() const {
+    return mCommandCount;
+}
+
+unsigned
+CommandBuffer::GetSize() const {
+    return mSize;
+}
+
+unsigned
+CommandBuffer::GetCapacity() const {
+    return mData.size();
+}
+
+void*
+CommandBuffer::allocateCommand(ECommandType type, unsigned argumentSize) {
+    unsigned CommandSize = (sizeof(CommandHeader) + argumentSize + 3) & ~3u;
+    if (mSize + CommandSize > mData.size()) {
+        // NOTE: Only grows while the first frames find the working size, Reset never shrinks
+        size_t Capacity = mData.empty() ? INITIAL_CAPACITY : mData.size() * 2;
+        while (Capacity < mSize + CommandSize) {
+            Capacity *= 2;
+        }
+        mData.resize(Capacity);
+    }
+
+    CommandHeader Header = { (unsigned short)type, (unsigned short)CommandSize };
+    unsigned char* Command = mData.data() + mSize;
+    memcpy(Command, &Header, sizeof(Header));
+    mSize += CommandSize;
+    ++mCommandCount;
+    return Command + sizeof(Header);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file command_buffer.hpp
+ * @brief CPU-side render command buffers, recorded on any thread and replayed on the GL thread
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include "upload_ring.hpp"
+
+enum ECommandType {
+    CMD_USE_PROGRAM = 0,
+    CMD_BIND_VERTEX_ARRAY = 1,
+    CMD_BIND_TEXTURE = 2,
+    CMD_UNIFORM_BLOCK = 3,
+    CMD_DRAW_ARRAYS = 4,
+    CMD_DRAW_ELEMENTS = 5,
+    CMD_BIND_SAMPLER = 6,
+    CMD_COUNT = 7,
+};
+
+/**
+ * @brief Every command starts with this header, followed by its arguments. mSize covers the
+ * header and the arguments and is always a multiple of 4 so the next header stays aligned
+ */
+struct CommandHeader {
+    unsigned short mType;
+    unsigned short mSize;
+};
+
+/**
+ * @brief Linear buffer of render commands. Recording never touches the GL, so each buffer can be
+ * filled by a different thread. Reset keeps the storage, so steady state frames don't allocate
+ */
+class CommandBuffer {
+public:
+    // NOTE: Uniform block data is stored inline, anything bigger belongs in the upload ring directly
+    static const unsigned MAX_UNIFORM_BLOCK_SIZE = 1024;
+
+    CommandBuffer();
+
+    /**
+     * @brief Drops all recorded commands but keeps the storage for the next frame
+     *
+     */
+    void Reset();
+
+    void UseProgram(unsigned program);
+    void BindVertexArray(unsigned vao);
+
+    /**
+     * @brief Binds a texture to a texture unit
+     *
+     * @param unit Texture unit index, not the GL_TEXTURE0 based enum
+     * @param texture Texture id
+     * @param target GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+     */
+    void BindTexture(unsigned unit, unsigned texture, unsigned target = GL_TEXTURE_2D);
+
+    /**
+     * @brief Binds a sampler object to a texture unit
+     *
+     * @param unit Texture unit index
+     * @param sampler GL name from SamplerCache::Resolve, resolved before recording so replay never locks the cache
+     */
+    void BindSampler(unsigned unit, unsigned sampler);
+
+    /**
+     * @brief Copies block data into the buffer. On replay it is written to the upload ring
+     * and the range is bound to the block binding
+     *
+     * @param binding Uniform block binding point
+     * @param data Block data
+     * @param size Size in bytes, at most MAX_UNIFORM_BLOCK_SIZE
+     */
+    void SetUniformBlock(unsigned binding, const void* data, unsigned size);
+
+    void DrawArrays(unsigned mode, int first, unsigned count);
+
+    /**
+     * @brief Draws from the bound element buffer
+     *
+     * @param mode Primitive mode
+     * @param count Index count
+     * @param type GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     * @param offset Byte offset into the element buffer
+     * @param triangleCount Triangles the indices form, counted by the frame stats
+     */
+    void DrawElements(unsigned mode, unsigned count, unsigned type, unsigned offset, unsigned triangleCount);
+
+    /**
+     * @brief Issues the recorded commands. Must run on the thread owning the GL context
+     *
+     * @param ring Upload ring receiving inline uniform block data, BeginFrame must have been called
+     */
+    void Execute(UploadRing& ring) const;
+
+    unsigned GetCommandCount() const;
+    unsigned GetSize() const;
+    unsigned GetCapacity() const;
+
+private:
+    std::vector<unsigned char> mData;
+    unsigned mSize;
+    unsigned mCommandCount;
+
+    void* allocateCommand(ECommandType type, unsigned argumentSize);
+};
@@ -0,0 +1,240 @@
+#include "debug_draw.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
+#include <cmath>
+
+// NOTE: Box corners are indexed by bits, x = 1, y = 2, z = 4. Every edge joins two corners one bit apart
+static const unsigned char BOX_EDGES[24] = {
+    0, 1, 2, 3, 4, 5, 6, 7,
+    0, 2, 1, 3, 4, 6, 5, 7,
+    0, 4, 1, 5, 2, 6, 3, 7,
+};
+
+DebugDraw::DebugDraw() {
+    mShader = 0;
+    mVAO = 0;
+    mVBO = 0;
+    mCapacity = 0;
+    for (unsigned SegmentIdx = 0; SegmentIdx < CIRCLE_SEGMENTS; ++SegmentIdx) {
+        float Angle = 2.0f * 3.14159265f * SegmentIdx / CIRCLE_SEGMENTS;
+        mCircle[SegmentIdx] = glm::vec2(cosf(Angle), sinf(Angle));
+    }
+}
+
+DebugDraw::~DebugDraw() {
+    delete mShader;
+}
+
+bool
+DebugDraw::Init(unsigned initialVertices) {
+    mShader = new Shader("shaders/debug_line.vert", "shaders/debug_line.frag");
+    if (!mShader->GetId()) {
+        std::cerr << "[Err] Failed to create debug line shader" << std::endl;
+        return false;
+    }
+    mShader->SetUniformBlockBinding("PerFrame", Shader::PER_FRAME_BINDING);
+
+    mCapacity = initialVertices ? initialVertices : 1024;
+    for (unsigned DepthIdx = 0; DepthIdx < DEBUG_DEPTH_MODE_COUNT; ++DepthIdx) {
+        mVertices[DepthIdx].reserve(mCapacity);
+    }
+
+    glGenVertexArrays(1, &mVAO);
+    glBindVertexArray(mVAO);
+    glGenBuffers(1, &mVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    glBufferData(GL_ARRAY_BUFFER, mCapacity * sizeof(DebugVertex), 0, GL_STREAM_DRAW);
+    MemoryTracker::Track(MEMORY_STREAM_BUFFER, mVBO, mCapacity * sizeof(DebugVertex), "Debug lines");
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), (void*)sizeof(glm::vec3));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return true;
+}
+
+void
+DebugDraw::Destroy() {
+    if (mVAO) {
+        MemoryTracker::Untrack(MEMORY_STREAM_BUFFER, mVBO);
+        glDeleteVertexArrays(1, &mVAO);
+        glDeleteBuffers(1, &mVBO);
+        mVAO = 0;
+        mVBO = 0;
+    }
+    delete mShader;
+    mShader = 0;
+    mCapacity = 0;
+    Clear();
+}
+
+void
+DebugDraw::Line(const glm::vec3& from, const glm::vec3& to, const glm::vec3& color, EDebugDepthMode depth) {
+    unsigned Color = packColor(color);
+    DebugVertex From = { from, Color };
+    DebugVertex To = { to, Color };
+    mVertices[depth].push_back(From);
+    mVertices[depth].push_back(To);
+}
+
+void
+DebugDraw::AABB(const glm::vec3& min, const glm::vec3& max, const glm::vec3& color, EDebugDepthMode depth) {
+    glm::vec3 Corners[8];
+    for (unsigned CornerIdx = 0; CornerIdx < 8; ++CornerIdx) {
+        Corners[CornerIdx] = glm::vec3(CornerIdx & 1 ? max.x : min.x, CornerIdx & 2 ? max.y : min.y, CornerIdx & 4 ? max.z : min.z);
+    }
+    boxEdges(Corners, packColor(color), depth);
+}
+
+void
+DebugDraw::Box(const glm::mat4& transform, const glm::vec3& color, EDebugDepthMode depth) {
+    glm::vec3 Corners[8];
+    for (unsigned CornerIdx = 0; CornerIdx < 8; ++CornerIdx) {
+        glm::vec4 Local(CornerIdx & 1 ? 0.5f : -0.5f, CornerIdx & 2 ? 0.5f : -0.5f, CornerIdx & 4 ? 0.5f : -0.5f, 1.0f);
+        Corners[CornerIdx] = glm::vec3(transform * Local);
+    }
+    boxEdges(Corners, packColor(color), depth);
+}
+
+void
+DebugDraw::Sphere(const glm::vec3& center, float radius, const glm::vec3& color, EDebugDepthMode depth) {
+    unsigned Color = packColor(color);
+    glm::vec3 X(1.0f, 0.0f, 0.0f);
+    glm::vec3 Y(0.0f, 1.0f, 0.0f);
+    glm::vec3 Z(0.0f, 0.0f, 1.0f);
+    circle(center, X, Y, radius, Color, depth);
+    circle(center, X, Z, radius, Color, depth);
+    circle(center, Y, Z, radius, Color, depth);
+}
+
+void
+DebugDraw::Frustum(const glm::mat4& viewProjection, const glm::vec3& color, EDebugDepthMode depth) {
+    glm::mat4 Inverse = glm::inverse(viewProjection);
+    glm::vec3 Corners[8];
+    for (unsigned CornerIdx = 0; CornerIdx < 8; ++CornerIdx) {
+        glm::vec4 Clip(CornerIdx & 1 ? 1.0f : -1.0f, CornerIdx & 2 ? 1.0f : -1.0f, CornerIdx & 4 ? 1.0f : -1.0f, 1.0f);
+        glm::vec4 World = Inverse * Clip;
+        Corners[CornerIdx] = glm::vec3(World) / World.w;
+    }
+    boxEdges(Corners, packColor(color), depth);
+}
+
+void
+DebugDraw::Cone(const glm::vec3& apex, const glm::vec3& direction, float length, float cosAngle, const glm::vec3& color, EDebugDepthMode depth) {
+    glm::vec3 Axis = glm::normalize(direction);
+    // NOTE: Any vector not parallel to the axis gives a basis for the base circle
+    glm::vec3 Helper = fabsf(Axis.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 U = glm::normalize(glm::cross(Axis, Helper));
+    glm::vec3 V = glm::cross(Axis, U);
+    float SinAngle = sqrtf(1.0f - cosAngle * cosAngle);
+    float Radius = cosAngle > 0.0f ? length * SinAngle / cosAngle : length;
+    glm::vec3 BaseCenter = apex + Axis * length;
+
+    unsigned Color = packColor(color);
+    circle(BaseCenter, U, V, Radius, Color, depth);
+    glm::vec3 Rim[4] = { U, V, -U, -V };
+    for (unsigned RimIdx = 0; RimIdx < 4; ++RimIdx) {
+        DebugVertex Tip = { apex, Color };
+        DebugVertex Base = { BaseCenter + Rim[RimIdx] * Radius, Color };
+        mVertices[depth].push_back(Tip);
+        mVertices[depth].push_back(Base);
+    }
+}
+
+void
+DebugDraw::Flush() {
+    PROFILE_FUNCTION();
+    unsigned TestCount = mVertices[DEBUG_DEPTH_TEST].size();
+    unsigned AlwaysCount = mVertices[DEBUG_DEPTH_ALWAYS].size();
+    unsigned Total = TestCount + AlwaysCount;
+    if (!Total || !mVAO) {
+        Clear();
+        return;
+    }
+
+    // NOTE: Grows geometrically so a burst of shapes reallocates a handful of times, not every frame.
+    // Otherwise the store is orphaned, the driver renames it instead of waiting on last frame's draw
+    if (mCapacity < Total) {
+        while (mCapacity < Total) {
+            mCapacity *= 2;
+        }
+        MemoryTracker::Track(MEMORY_STREAM_BUFFER, mVBO, mCapacity * sizeof(DebugVertex), "Debug lines");
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    glBufferData(GL_ARRAY_BUFFER, mCapacity * sizeof(DebugVertex), 0, GL_STREAM_DRAW);
+    if (TestCount) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, TestCount * sizeof(DebugVertex), mVertices[DEBUG_DEPTH_TEST].data());
+    }
+    if (AlwaysCount) {
+        glBufferSubData(GL_ARRAY_BUFFER, TestCount * sizeof(DebugVertex), AlwaysCount * sizeof(DebugVertex), mVertices[DEBUG_DEPTH_ALWAYS].data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    FrameStats::CountUploadBytes(Total * sizeof(DebugVertex));
+
+    glUseProgram(mShader->GetId());
+    FrameStats::CountProgramSwitch();
+    glBindVertexArray(mVAO);
+    FrameStats::CountVAOBind();
+    if (TestCount) {
+        glDrawArrays(GL_LINES, 0, TestCount);
+        FrameStats::CountDraw(GL_LINES, TestCount);
+    }
+    if (AlwaysCount) {
+        glDisable(GL_DEPTH_TEST);
+        glDrawArrays(GL_LINES, TestCount, AlwaysCount);
+        FrameStats::CountDraw(GL_LINES, AlwaysCount);
+        glEnable(GL_DEPTH_TEST);
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+    Clear();
+}
+
+void
+DebugDraw::Clear() {
+    // NOTE: clear keeps the capacity, steady state submission never allocates
+    for (unsigned DepthIdx = 0; DepthIdx < DEBUG_DEPTH_MODE_COUNT; ++DepthIdx) {
+        mVertices[DepthIdx].clear();
+    }
+}
+
+unsigned
+DebugDraw::GetVertexCount() const {
+    return mVertices[DEBUG_DEPTH_TEST].size() + mVertices[DEBUG_DEPTH_ALWAYS].size();
+}
+
+void
+DebugDraw::boxEdges(const glm::vec3* corners, unsigned color, EDebugDepthMode depth) {
+    std::vector<DebugVertex>& Vertices = mVertices[depth];
+    for (unsigned EdgeIdx = 0; EdgeIdx < 24; ++EdgeIdx) {
+        DebugVertex Vertex = { corners[BOX_EDGES[EdgeIdx]], color };
+        Vertices.push_back(Vertex);
+    }
+}
+
+void
+DebugDraw::circle(const glm::vec3& center, const glm::vec3& u, const glm::vec3& v, float radius, unsigned color, EDebugDepthMode depth) {
+    std::vector<DebugVertex>& Vertices = mVertices[depth];
+    glm::vec3 U = u * radius;
+    glm::vec3 V = v * radius;
+    for (unsigned SegmentIdx = 0; SegmentIdx < CIRCLE_SEGMENTS; ++SegmentIdx) {
+        const glm::vec2& From = mCircle[SegmentIdx];
+        const glm::vec2& To = mCircle[(SegmentIdx + 1) % CIRCLE_SEGMENTS];
+        DebugVertex Start = { center + U * From.x + V * From.y, color };
+        DebugVertex End = { center + U * To.x + V * To.y, color };
+        Vertices.push_back(Start);
+        Vertices.push_back(End);
+    }
+}
+
+unsigned
+DebugDraw::packColor(const glm::vec3& color) {
+    unsigned Channels[3];
+    for (unsigned ChannelIdx = 0; ChannelIdx < 3; ++ChannelIdx) {
+        float Value = color[ChannelIdx] < 0.0f ? 0.0f : color[ChannelIdx] > 1.0f ? 1.0f : color[ChannelIdx];
+        Channels[ChannelIdx] = (unsigned)(Value * 255.0f + 0.5f);
+    }
+    return Channels[0] | (Channels[1] << 8) | (Channels[2] << 16) | 0xFF000000u;
+}
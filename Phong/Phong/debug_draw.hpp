@@ -0,0 +1,115 @@
+/**
+ * @file debug_draw.hpp
+ * @brief Immediate mode debug geometry batched into one line draw per depth mode
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "shader.hpp"
+
+enum EDebugDepthMode {
+    DEBUG_DEPTH_TEST = 0,
+    // NOTE: Drawn over everything, for gizmos that must stay visible behind geometry
+    DEBUG_DEPTH_ALWAYS = 1,
+    DEBUG_DEPTH_MODE_COUNT = 2,
+};
+
+struct DebugVertex {
+    glm::vec3 mPosition;
+    unsigned mColor;
+};
+
+/**
+ * @brief Shapes are expanded to line vertices on the CPU as they are submitted and kept until
+ * the next Flush, which uploads everything at once and issues a single GL_LINES draw for each
+ * depth mode that has vertices. Not thread safe, submit from the thread that flushes
+ */
+class DebugDraw {
+public:
+    static const unsigned CIRCLE_SEGMENTS = 24;
+
+    DebugDraw();
+    ~DebugDraw();
+
+    /**
+     * @brief Creates the shader and the dynamic vertex buffer. Requires a current GL context
+     *
+     * @param initialVertices Vertices reserved up front, the buffer grows past it when needed
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(unsigned initialVertices);
+
+    /**
+     * @brief Releases GL resources. Must run on the thread owning the context
+     *
+     */
+    void Destroy();
+
+    void Line(const glm::vec3& from, const glm::vec3& to, const glm::vec3& color, EDebugDepthMode depth = DEBUG_DEPTH_TEST);
+    void AABB(const glm::vec3& min, const glm::vec3& max, const glm::vec3& color, EDebugDepthMode depth = DEBUG_DEPTH_TEST);
+
+    /**
+     * @brief Oriented box, the unit cube centered at the origin moved by transform
+     *
+     */
+    void Box(const glm::mat4& transform, const glm::vec3& color, EDebugDepthMode depth = DEBUG_DEPTH_TEST);
+
+    /**
+     * @brief Three great circles around the center
+     *
+     */
+    void Sphere(const glm::vec3& center, float radius, const glm::vec3& color, EDebugDepthMode depth = DEBUG_DEPTH_TEST);
+
+    /**
+     * @brief Edges of the volume a view projection matrix maps to clip space
+     *
+     */
+    void Frustum(const glm::mat4& viewProjection, const glm::vec3& color, EDebugDepthMode depth = DEBUG_DEPTH_TEST);
+
+    /**
+     * @brief Cone with its tip at apex, as used for spotlights
+     *
+     * @param apex Tip of the cone
+     * @param direction Axis from the tip towards the base
+     * @param length Distance from the tip to the base
+     * @param cosAngle Cosine of the half angle, the same value the shaders use as a cut off
+     * @param color Line color
+     * @param depth Depth test mode
+     */
+    void Cone(const glm::vec3& apex, const glm::vec3& direction, float length, float cosAngle, const glm::vec3& color, EDebugDepthMode depth = DEBUG_DEPTH_TEST);
+
+    /**
+     * @brief Draws and discards everything submitted since the last flush. Uses the PerFrame
+     * uniform block bound at Shader::PER_FRAME_BINDING for the camera
+     *
+     */
+    void Flush();
+
+    /**
+     * @brief Discards submitted geometry without drawing it
+     *
+     */
+    void Clear();
+
+    unsigned GetVertexCount() const;
+
+private:
+    Shader* mShader;
+    unsigned mVAO;
+    unsigned mVBO;
+    unsigned mCapacity;
+    std::vector<DebugVertex> mVertices[DEBUG_DEPTH_MODE_COUNT];
+    glm::vec2 mCircle[CIRCLE_SEGMENTS];
+
+    void boxEdges(const glm::vec3* corners, unsigned color, EDebugDepthMode depth);
+    void circle(const glm::vec3& center, const glm::vec3& u, const glm::vec3& v, float radius, unsigned color, EDebugDepthMode depth);
+    static unsigned packColor(const glm::vec3& color);
+};
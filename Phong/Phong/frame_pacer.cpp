@@ -0,0 +1,173 @@
+#include "frame_pacer.hpp"
+#include "profiler.hpp"
+
+FramePacer::FramePacer() {
+    for (unsigned SlotIdx = 0; SlotIdx < MAX_FRAMES_IN_FLIGHT; ++SlotIdx) {
+        mSlots[SlotIdx] = { 0 };
+    }
+    mFramesInFlight = 0;
+    mCurrent = 0;
+    mFrameCount = 0;
+    mCompletedCount = 0;
+    mLast = { 0 };
+    mTotal = { 0 };
+    mHistory = 0;
+}
+
+FramePacer::~FramePacer() {
+    Destroy();
+}
+
+bool
+FramePacer::Init(unsigned framesInFlight) {
+    Destroy();
+    mFramesInFlight = framesInFlight < 1 ? 1 : framesInFlight > MAX_FRAMES_IN_FLIGHT ? MAX_FRAMES_IN_FLIGHT : framesInFlight;
+    for (unsigned SlotIdx = 0; SlotIdx < mFramesInFlight; ++SlotIdx) {
+        mSlots[SlotIdx] = { 0 };
+        glGenQueries(1, &mSlots[SlotIdx].mQuery);
+    }
+
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "[Err] Failed to create frame pacer queries" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    mCurrent = 0;
+    std::cout << "Frame pacer: " << mFramesInFlight << " frame(s) in flight" << std::endl;
+    return true;
+}
+
+void
+FramePacer::Destroy() {
+    for (unsigned SlotIdx = 0; SlotIdx < MAX_FRAMES_IN_FLIGHT; ++SlotIdx) {
+        FrameSlot& Slot = mSlots[SlotIdx];
+        if (Slot.mFence) {
+            glDeleteSync(Slot.mFence);
+            Slot.mFence = 0;
+        }
+        if (Slot.mQuery) {
+            glDeleteQueries(1, &Slot.mQuery);
+            Slot.mQuery = 0;
+        }
+    }
+}
+
+void
+FramePacer::BeginFrame() {
+    PROFILE_FUNCTION();
+    FrameSlot& Slot = mSlots[mCurrent];
+    unsigned QueueDepth = countPending();
+
+    std::chrono::high_resolution_clock::time_point WaitStart = std::chrono::high_resolution_clock::now();
+    completeSlot(Slot);
+    mFrameStart = std::chrono::high_resolution_clock::now();
+
+    Slot.mWaitTime = std::chrono::duration<double>(mFrameStart - WaitStart).count();
+    Slot.mQueueDepth = QueueDepth;
+    Slot.mFrameIndex = mFrameCount;
+    glBeginQuery(GL_TIME_ELAPSED, Slot.mQuery);
+}
+
+void
+FramePacer::EndFrame() {
+    FrameSlot& Slot = mSlots[mCurrent];
+    glEndQuery(GL_TIME_ELAPSED);
+    Slot.mFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    Slot.mCPUTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - mFrameStart).count();
+
+    mCurrent = (mCurrent + 1) % mFramesInFlight;
+    ++mFrameCount;
+}
+
+void
+FramePacer::Drain() {
+    PROFILE_FUNCTION();
+    // NOTE: mCurrent is the oldest slot, walking forward completes frames in submission order
+    for (unsigned SlotOffset = 0; SlotOffset < mFramesInFlight; ++SlotOffset) {
+        completeSlot(mSlots[(mCurrent + SlotOffset) % mFramesInFlight]);
+    }
+}
+
+void
+FramePacer::SetHistory(std::vector<FrameTiming>* history) {
+    mHistory = history;
+}
+
+unsigned
+FramePacer::GetFramesInFlight() const {
+    return mFramesInFlight;
+}
+
+unsigned
+FramePacer::GetFrameCount() const {
+    return mFrameCount;
+}
+
+const FrameTiming&
+FramePacer::GetLastTiming() const {
+    return mLast;
+}
+
+FrameTiming
+FramePacer::GetAverageTiming() const {
+    FrameTiming Average = { 0 };
+    if (!mCompletedCount) {
+        return Average;
+    }
+
+    Average.mCPUTime = mTotal.mCPUTime / mCompletedCount;
+    Average.mGPUTime = mTotal.mGPUTime / mCompletedCount;
+    Average.mWaitTime = mTotal.mWaitTime / mCompletedCount;
+    Average.mQueueDepth = (mTotal.mQueueDepth + mCompletedCount / 2) / mCompletedCount;
+    return Average;
+}
+
+void
+FramePacer::completeSlot(FrameSlot& slot) {
+    if (!slot.mFence) {
+        return;
+    }
+
+    GLenum Status = glClientWaitSync(slot.mFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (Status == GL_TIMEOUT_EXPIRED) {
+        Status = glClientWaitSync(slot.mFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    }
+    glDeleteSync(slot.mFence);
+    slot.mFence = 0;
+
+    // NOTE: The fence was inserted after the query ended, so the result is available without stalling
+    GLuint64 ElapsedNS = 0;
+    glGetQueryObjectui64v(slot.mQuery, GL_QUERY_RESULT, &ElapsedNS);
+
+    mLast.mFrameIndex = slot.mFrameIndex;
+    mLast.mCPUTime = slot.mCPUTime;
+    mLast.mGPUTime = ElapsedNS / 1e9;
+    mLast.mWaitTime = slot.mWaitTime;
+    mLast.mQueueDepth = slot.mQueueDepth;
+
+    mTotal.mCPUTime += mLast.mCPUTime;
+    mTotal.mGPUTime += mLast.mGPUTime;
+    mTotal.mWaitTime += mLast.mWaitTime;
+    mTotal.mQueueDepth += mLast.mQueueDepth;
+    ++mCompletedCount;
+    if (mHistory) {
+        mHistory->push_back(mLast);
+    }
+}
+
+unsigned
+FramePacer::countPending() const {
+    unsigned Pending = 0;
+    for (unsigned SlotIdx = 0; SlotIdx < mFramesInFlight; ++SlotIdx) {
+        const FrameSlot& Slot = mSlots[SlotIdx];
+        if (!Slot.mFence) {
+            continue;
+        }
+
+        GLint Status = GL_UNSIGNALED;
+        glGetSynciv(Slot.mFence, GL_SYNC_STATUS, 1, 0, &Status);
+        Pending += Status == GL_UNSIGNALED;
+    }
+    return Pending;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file frame_pacer.hpp
+ * @brief Caps the number of frames the CPU may run ahead of the GPU and times each frame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+struct FrameTiming {
+    unsigned mFrameIndex;
+    // NOTE: All times are in seconds
+    double mCPUTime;
+    double mGPUTime;
+    // NOTE: Time BeginFrame spent blocked because N frames were already in flight
+    double mWaitTime;
+    // NOTE: Frames submitted but not yet completed by the GPU when this frame began
+    unsigned mQueueDepth;
+};
+
+class FramePacer {
+public:
+    static const unsigned MAX_FRAMES_IN_FLIGHT = 3;
+
+    FramePacer();
+    ~FramePacer();
+
+    /**
+     * @brief Creates per frame fences and timer queries
+     *
+     * @param framesInFlight Maximum number of frames submitted but not finished by the GPU (1-3)
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(unsigned framesInFlight);
+
+    /**
+     * @brief Deletes fences and queries
+     *
+     */
+    void Destroy();
+
+    /**
+     * @brief Blocks until the frame slot is free, collects its GPU time and starts timing the new frame
+     *
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Stops timing the frame and fences it. Call after the last GL command of the frame
+     *
+     */
+    void EndFrame();
+
+    /**
+     * @brief Waits for every frame still in flight and collects its timing
+     *
+     */
+    void Drain();
+
+    /**
+     * @brief Appends the timing of every completed frame to history, in submission order.
+     * Reserve the vector up front to keep the frame loop free of allocations
+     *
+     * @param history Vector to append to, 0 stops recording
+     */
+    void SetHistory(std::vector<FrameTiming>* history);
+
+    unsigned GetFramesInFlight() const;
+    unsigned GetFrameCount() const;
+
+    /**
+     * @brief Returns timing of the most recent frame whose GPU time is known.
+     * That frame is N frames behind the one currently being recorded
+     *
+     * @returns Frame timing
+     */
+    const FrameTiming& GetLastTiming() const;
+
+    /**
+     * @brief Returns timing averaged over all completed frames
+     *
+     * @returns Frame timing
+     */
+    FrameTiming GetAverageTiming() const;
+
+private:
+    struct FrameSlot {
+        GLsync mFence;
+        unsigned mQuery;
+        unsigned mFrameIndex;
+        double mCPUTime;
+        double mWaitTime;
+        unsigned mQueueDepth;
+    };
+
+    FrameSlot mSlots[MAX_FRAMES_IN_FLIGHT];
+    unsigned mFramesInFlight;
+    unsigned mCurrent;
+    unsigned mFrameCount;
+    unsigned mCompletedCount;
+    std::chrono::high_resolution_clock::time_point mFrameStart;
+    FrameTiming mLast;
+    FrameTiming mTotal;
+    std::vector<FrameTiming>* mHistory;
+
+    void completeSlot(FrameSlot& slot);
+    unsigned countPending() const;
+};
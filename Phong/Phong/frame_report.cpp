@@ -0,0 +1,126 @@
+#include "frame_report.hpp"
+#include "frame_stats.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+FrameReport::FrameReport(const std::vector<FrameTiming>& frames) : mFrames(frames) {
+    std::vector<double> Samples(frames.size());
+    for (unsigned FrameIdx = 0; FrameIdx < frames.size(); ++FrameIdx) {
+        Samples[FrameIdx] = frames[FrameIdx].mCPUTime;
+    }
+    mCPU = summarize(Samples);
+
+    for (unsigned FrameIdx = 0; FrameIdx < frames.size(); ++FrameIdx) {
+        Samples[FrameIdx] = frames[FrameIdx].mGPUTime;
+    }
+    mGPU = summarize(Samples);
+}
+
+const FrameTimeSummary&
+FrameReport::GetCPUSummary() const {
+    return mCPU;
+}
+
+const FrameTimeSummary&
+FrameReport::GetGPUSummary() const {
+    return mGPU;
+}
+
+void
+FrameReport::Print(std::ostream& output) const {
+    const FrameTimeSummary* Summaries[] = { &mCPU, &mGPU };
+    const char* Names[] = { "CPU", "GPU" };
+    output << "Frame times over " << mFrames.size() << " frames (ms)" << std::endl;
+    output << "       min      avg      p50      p95      p99      max" << std::endl;
+    std::ios::fmtflags Flags = output.flags();
+    output << std::fixed << std::setprecision(3);
+    for (unsigned SummaryIdx = 0; SummaryIdx < 2; ++SummaryIdx) {
+        const FrameTimeSummary& Summary = *Summaries[SummaryIdx];
+        output << Names[SummaryIdx]
+            << std::setw(9) << Summary.mMin * 1000.0 << std::setw(9) << Summary.mAverage * 1000.0
+            << std::setw(9) << Summary.mP50 * 1000.0 << std::setw(9) << Summary.mP95 * 1000.0
+            << std::setw(9) << Summary.mP99 * 1000.0 << std::setw(9) << Summary.mMax * 1000.0 << std::endl;
+    }
+    output.flags(Flags);
+    RenderCounters Average = FrameStats::GetAverage();
+    output << "Per frame: " << Average.mDrawCalls << " draws, " << Average.mTriangles << " triangles, "
+        << Average.mProgramSwitches << " program switches, " << Average.mTextureBinds << " texture binds, "
+        << Average.mUniformUploads << " uniform uploads" << std::endl;
+}
+
+bool
+FrameReport::WriteCSV(const std::string& filename) const {
+    std::ofstream Output(filename.c_str());
+    if (!Output) {
+        std::cerr << "[Err] Failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    Output << "frame,cpu_ms,gpu_ms,wait_ms,queue_depth\n";
+    Output << std::fixed << std::setprecision(4);
+    for (unsigned FrameIdx = 0; FrameIdx < mFrames.size(); ++FrameIdx) {
+        const FrameTiming& Timing = mFrames[FrameIdx];
+        Output << Timing.mFrameIndex << "," << Timing.mCPUTime * 1000.0 << "," << Timing.mGPUTime * 1000.0 << ","
+            << Timing.mWaitTime * 1000.0 << "," << Timing.mQueueDepth << "\n";
+    }
+    return true;
+}
+
+static void
+WriteSummaryJSON(std::ostream& output, const char* name, const FrameTimeSummary& summary) {
+    output << "  \"" << name << "\": { \"min\": " << summary.mMin * 1000.0 << ", \"avg\": " << summary.mAverage * 1000.0
+        << ", \"p50\": " << summary.mP50 * 1000.0 << ", \"p95\": " << summary.mP95 * 1000.0
+        << ", \"p99\": " << summary.mP99 * 1000.0 << ", \"max\": " << summary.mMax * 1000.0 << " },\n";
+}
+
+bool
+FrameReport::WriteJSON(const std::string& filename) const {
+    std::ofstream Output(filename.c_str());
+    if (!Output) {
+        std::cerr << "[Err] Failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    Output << std::fixed << std::setprecision(4);
+    Output << "{\n  \"frames\": " << mFrames.size() << ",\n";
+    WriteSummaryJSON(Output, "cpu_ms", mCPU);
+    WriteSummaryJSON(Output, "gpu_ms", mGPU);
+    Output << "  \"counters_per_frame\": {\n";
+    FrameStats::WriteCounters(Output, FrameStats::GetAverage(), "    ");
+    Output << "  },\n";
+    Output << "  \"trace\": [\n";
+    for (unsigned FrameIdx = 0; FrameIdx < mFrames.size(); ++FrameIdx) {
+        const FrameTiming& Timing = mFrames[FrameIdx];
+        Output << "    { \"frame\": " << Timing.mFrameIndex << ", \"cpu_ms\": " << Timing.mCPUTime * 1000.0
+            << ", \"gpu_ms\": " << Timing.mGPUTime * 1000.0 << ", \"wait_ms\": " << Timing.mWaitTime * 1000.0
+            << ", \"queue_depth\": " << Timing.mQueueDepth << " }" << (FrameIdx + 1 < mFrames.size() ? ",\n" : "\n");
+    }
+    Output << "  ]\n}\n";
+    return true;
+}
+
+FrameTimeSummary
+FrameReport::summarize(std::vector<double>& samples) {
+    FrameTimeSummary Summary = { 0 };
+    if (samples.empty()) {
+        return Summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double Total = 0.0;
+    for (unsigned SampleIdx = 0; SampleIdx < samples.size(); ++SampleIdx) {
+        Total += samples[SampleIdx];
+    }
+
+    // NOTE: Nearest rank percentiles, so every reported value is a frame that actually happened
+    unsigned Last = samples.size() - 1;
+    Summary.mMin = samples.front();
+    Summary.mMax = samples.back();
+    Summary.mAverage = Total / samples.size();
+    Summary.mP50 = samples[(unsigned)(Last * 0.50 + 0.5)];
+    Summary.mP95 = samples[(unsigned)(Last * 0.95 + 0.5)];
+    Summary.mP99 = samples[(unsigned)(Last * 0.99 + 0.5)];
+    return Summary;
+}
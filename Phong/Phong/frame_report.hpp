@@ -0,0 +1,70 @@
+/**
+ * @file frame_report.hpp
+ * @brief Frame time statistics and CSV/JSON traces for benchmark runs
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "frame_pacer.hpp"
+
+struct FrameTimeSummary {
+    // NOTE: All times are in seconds
+    double mMin;
+    double mAverage;
+    double mP50;
+    double mP95;
+    double mP99;
+    double mMax;
+};
+
+class FrameReport {
+public:
+    /**
+     * @brief Computes CPU and GPU summaries over the recorded frames
+     *
+     * @param frames Per frame timings in submission order, must outlive the report
+     */
+    FrameReport(const std::vector<FrameTiming>& frames);
+
+    const FrameTimeSummary& GetCPUSummary() const;
+    const FrameTimeSummary& GetGPUSummary() const;
+
+    /**
+     * @brief Prints the summary table and the average render counters
+     *
+     * @param output Stream to print to
+     */
+    void Print(std::ostream& output) const;
+
+    /**
+     * @brief Writes one row per frame
+     *
+     * @param filename Output path
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool WriteCSV(const std::string& filename) const;
+
+    /**
+     * @brief Writes the summaries and the average render counters followed by the per frame trace
+     *
+     * @param filename Output path
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool WriteJSON(const std::string& filename) const;
+
+private:
+    const std::vector<FrameTiming>& mFrames;
+    FrameTimeSummary mCPU;
+    FrameTimeSummary mGPU;
+
+    static FrameTimeSummary summarize(std::vector<double>& samples);
+};
@@ -0,0 +1,60 @@
+#include "frame_snapshot.hpp"
+#include <chrono>
+
+SnapshotBuffer::SnapshotBuffer() {
+    for (unsigned SlotIdx = 0; SlotIdx < 3; ++SlotIdx) {
+        mSlots[SlotIdx] = FrameSnapshot();
+    }
+    mWriteIdx = 0;
+    mMiddle = 1;
+    mReadIdx = 2;
+    mHasRead = false;
+    mClosed = false;
+}
+
+FrameSnapshot&
+SnapshotBuffer::BeginWrite() {
+    return mSlots[mWriteIdx];
+}
+
+void
+SnapshotBuffer::Publish() {
+    unsigned Previous = mMiddle.exchange(mWriteIdx | FRESH_BIT, std::memory_order_acq_rel);
+    mWriteIdx = Previous & INDEX_MASK;
+    // NOTE: Taking the lock orders the notify after a consumer that just checked the flag started waiting
+    std::lock_guard<std::mutex> Lock(mMutex);
+    mCondition.notify_one();
+}
+
+bool
+SnapshotBuffer::Acquire(double timeout, const FrameSnapshot*& snapshot) {
+    if (!(mMiddle.load(std::memory_order_acquire) & FRESH_BIT)) {
+        std::unique_lock<std::mutex> Lock(mMutex);
+        mCondition.wait_for(Lock, std::chrono::duration<double>(timeout), [this] {
+            return (mMiddle.load(std::memory_order_acquire) & FRESH_BIT) || mClosed.load();
+        });
+    }
+
+    bool Fresh = false;
+    if (mMiddle.load(std::memory_order_acquire) & FRESH_BIT) {
+        unsigned Previous = mMiddle.exchange(mReadIdx, std::memory_order_acq_rel);
+        mReadIdx = Previous & INDEX_MASK;
+        mHasRead = true;
+        Fresh = true;
+    }
+
+    snapshot = mHasRead ? &mSlots[mReadIdx] : 0;
+    return Fresh;
+}
+
+void
+SnapshotBuffer::Close() {
+    mClosed = true;
+    std::lock_guard<std::mutex> Lock(mMutex);
+    mCondition.notify_all();
+}
+
+bool
+SnapshotBuffer::IsClosed() const {
+    return mClosed.load();
+}
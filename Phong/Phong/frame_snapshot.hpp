@@ -0,0 +1,90 @@
+/**
+ * @file frame_snapshot.hpp
+ * @brief Immutable per-frame simulation output and the triple buffer that hands it to the renderer
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <glm/glm.hpp>
+
+/**
+ * @brief Everything the renderer needs to draw one frame. Produced by the simulation,
+ * never modified after being published
+ */
+struct FrameSnapshot {
+    unsigned mFrameIndex;
+    int mFramebufferWidth;
+    int mFramebufferHeight;
+    glm::vec3 mCameraPosition;
+    glm::vec3 mCameraTarget;
+    glm::vec3 mCameraUp;
+    // NOTE: Vertical offset of the fish cube and the spotlights around it, driven by MoveCube
+    float mCubeOffset;
+    float mFenjer;
+    float mLightAngle;
+    bool mDrawDebugLines;
+    bool mShowHud;
+    // NOTE: ETextureQuality the renderer samples with, applied to the shared samplers when it changes
+    unsigned mTextureQuality;
+    float mDT;
+};
+
+/**
+ * @brief Single producer, single consumer triple buffer. The producer always has a slot
+ * to write into and the consumer always sees the latest complete snapshot, neither blocks the other
+ */
+class SnapshotBuffer {
+public:
+    SnapshotBuffer();
+
+    /**
+     * @brief Returns the slot the producer may fill. Owned by the producer until Publish
+     *
+     * @returns Writable snapshot
+     */
+    FrameSnapshot& BeginWrite();
+
+    /**
+     * @brief Makes the written snapshot the latest one and wakes the consumer
+     *
+     */
+    void Publish();
+
+    /**
+     * @brief Takes the latest published snapshot, waiting up to timeout seconds for one newer
+     * than the last acquired
+     *
+     * @param timeout Maximum wait in seconds
+     * @param snapshot Set to the latest snapshot, 0 if nothing was published yet
+     *
+     * @returns true - A new snapshot was acquired, false - Timed out or closed
+     */
+    bool Acquire(double timeout, const FrameSnapshot*& snapshot);
+
+    /**
+     * @brief Wakes a waiting consumer for good, used on shutdown
+     *
+     */
+    void Close();
+    bool IsClosed() const;
+
+private:
+    static const unsigned FRESH_BIT = 0x4;
+    static const unsigned INDEX_MASK = 0x3;
+
+    FrameSnapshot mSlots[3];
+    unsigned mWriteIdx;
+    unsigned mReadIdx;
+    bool mHasRead;
+    std::atomic<unsigned> mMiddle;
+    std::atomic<bool> mClosed;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
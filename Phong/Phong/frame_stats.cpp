@@ -0,0 +1,102 @@
+#include "frame_stats.hpp"
+#include <fstream>
+#include <iostream>
+
+RenderCounters FrameStats::sCurrent = { 0 };
+RenderCounters FrameStats::sLastFrame = { 0 };
+RenderCounters FrameStats::sTotal = { 0 };
+unsigned FrameStats::sFrameCount = 0;
+
+static void
+AddCounters(RenderCounters& total, const RenderCounters& counters) {
+    total.mDrawCalls += counters.mDrawCalls;
+    total.mTriangles += counters.mTriangles;
+    total.mVertices += counters.mVertices;
+    total.mProgramSwitches += counters.mProgramSwitches;
+    total.mTextureBinds += counters.mTextureBinds;
+    total.mVAOBinds += counters.mVAOBinds;
+    total.mUniformUploads += counters.mUniformUploads;
+    total.mUploadBytes += counters.mUploadBytes;
+    total.mUniformLookups += counters.mUniformLookups;
+}
+
+void
+FrameStats::BeginFrame() {
+    // NOTE: Work done between frames (loading, resizing) still goes into the totals
+    AddCounters(sTotal, sCurrent);
+    sCurrent = { 0 };
+}
+
+void
+FrameStats::EndFrame() {
+    sLastFrame = sCurrent;
+    AddCounters(sTotal, sCurrent);
+    sCurrent = { 0 };
+    ++sFrameCount;
+}
+
+const RenderCounters&
+FrameStats::GetLastFrame() {
+    return sLastFrame;
+}
+
+const RenderCounters&
+FrameStats::GetTotal() {
+    return sTotal;
+}
+
+unsigned
+FrameStats::GetFrameCount() {
+    return sFrameCount;
+}
+
+RenderCounters
+FrameStats::GetAverage() {
+    RenderCounters Average = { 0 };
+    if (!sFrameCount) {
+        return Average;
+    }
+
+    unsigned long long Half = sFrameCount / 2;
+    Average.mDrawCalls = (sTotal.mDrawCalls + Half) / sFrameCount;
+    Average.mTriangles = (sTotal.mTriangles + Half) / sFrameCount;
+    Average.mVertices = (sTotal.mVertices + Half) / sFrameCount;
+    Average.mProgramSwitches = (sTotal.mProgramSwitches + Half) / sFrameCount;
+    Average.mTextureBinds = (sTotal.mTextureBinds + Half) / sFrameCount;
+    Average.mVAOBinds = (sTotal.mVAOBinds + Half) / sFrameCount;
+    Average.mUniformUploads = (sTotal.mUniformUploads + Half) / sFrameCount;
+    Average.mUploadBytes = (sTotal.mUploadBytes + Half) / sFrameCount;
+    Average.mUniformLookups = (sTotal.mUniformLookups + Half) / sFrameCount;
+    return Average;
+}
+
+void
+FrameStats::WriteCounters(std::ostream& output, const RenderCounters& counters, const char* indent) {
+    output << indent << "\"draw_calls\": " << counters.mDrawCalls << ",\n"
+        << indent << "\"triangles\": " << counters.mTriangles << ",\n"
+        << indent << "\"vertices\": " << counters.mVertices << ",\n"
+        << indent << "\"program_switches\": " << counters.mProgramSwitches << ",\n"
+        << indent << "\"texture_binds\": " << counters.mTextureBinds << ",\n"
+        << indent << "\"vao_binds\": " << counters.mVAOBinds << ",\n"
+        << indent << "\"uniform_uploads\": " << counters.mUniformUploads << ",\n"
+        << indent << "\"upload_bytes\": " << counters.mUploadBytes << ",\n"
+        << indent << "\"uniform_lookups\": " << counters.mUniformLookups << "\n";
+}
+
+bool
+FrameStats::WriteJSON(const std::string& filename) {
+    std::ofstream Output(filename.c_str());
+    if (!Output) {
+        std::cerr << "[Err] Failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    Output << "{\n  \"frames\": " << sFrameCount << ",\n  \"average\": {\n";
+    WriteCounters(Output, GetAverage(), "    ");
+    Output << "  },\n  \"last_frame\": {\n";
+    WriteCounters(Output, sLastFrame, "    ");
+    Output << "  },\n  \"total\": {\n";
+    WriteCounters(Output, sTotal, "    ");
+    Output << "  }\n}\n";
+    return true;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file frame_stats.hpp
+ * @brief Per frame counters of the work submitted to the GL
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <ostream>
+#include <string>
+
+struct RenderCounters {
+    unsigned long long mDrawCalls;
+    unsigned long long mTriangles;
+    unsigned long long mVertices;
+    unsigned long long mProgramSwitches;
+    unsigned long long mTextureBinds;
+    unsigned long long mVAOBinds;
+    unsigned long long mUniformUploads;
+    unsigned long long mUploadBytes;
+    unsigned long long mUniformLookups;
+};
+
+/**
+ * @brief Counters are bumped by hooks next to the GL calls they describe. Every hook runs on the
+ * thread owning the GL context, so the counters are plain integers
+ */
+class FrameStats {
+public:
+    /**
+     * @brief Starts counting a new frame
+     *
+     */
+    static void BeginFrame();
+
+    /**
+     * @brief Closes the frame, its counters become GetLastFrame and are added to the totals
+     *
+     */
+    static void EndFrame();
+
+    static void CountDraw(unsigned mode, unsigned vertexCount);
+
+    /**
+     * @brief Counts a draw whose triangle count is known up front, for strips joined by primitive
+     * restart where the index count also holds the restarts and degenerate joins
+     *
+     * @param mode Primitive mode
+     * @param vertexCount Vertices or indices drawn
+     * @param triangleCount Triangles drawn
+     */
+    static void CountDraw(unsigned mode, unsigned vertexCount, unsigned triangleCount);
+    static void CountProgramSwitch();
+    static void CountTextureBind();
+    static void CountVAOBind();
+    static void CountUniformUpload();
+    static void CountUploadBytes(unsigned long long bytes);
+    static void CountUniformLookup();
+
+    static const RenderCounters& GetLastFrame();
+    static const RenderCounters& GetTotal();
+    static unsigned GetFrameCount();
+
+    /**
+     * @brief Returns the totals divided by the number of frames, rounded
+     *
+     * @returns Average counters per frame
+     */
+    static RenderCounters GetAverage();
+
+    /**
+     * @brief Writes counters as the fields of a JSON object, without the braces
+     *
+     * @param output Stream to write to
+     * @param counters Counters to write
+     * @param indent Prefix of every line
+     */
+    static void WriteCounters(std::ostream& output, const RenderCounters& counters, const char* indent);
+
+    /**
+     * @brief Writes the per frame average, the last frame and the totals (which include
+     * loading) as JSON
+     *
+     * @param filename Output path
+     *
+     * @returns true - Success, false - Failure
+     */
+    static bool WriteJSON(const std::string& filename);
+
+private:
+    static RenderCounters sCurrent;
+    static RenderCounters sLastFrame;
+    static RenderCounters sTotal;
+    static unsigned sFrameCount;
+};
+
+inline void
+FrameStats::CountDraw(unsigned mode, unsigned vertexCount) {
+    unsigned TriangleCount = 0;
+    switch (mode) {
+    case GL_TRIANGLES: TriangleCount = vertexCount / 3; break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN: TriangleCount = vertexCount > 2 ? vertexCount - 2 : 0; break;
+    default: break;
+    }
+    CountDraw(mode, vertexCount, TriangleCount);
+}
+
+inline void
+FrameStats::CountDraw(unsigned mode, unsigned vertexCount, unsigned triangleCount) {
+    ++sCurrent.mDrawCalls;
+    sCurrent.mVertices += vertexCount;
+    sCurrent.mTriangles += triangleCount;
+}
+
+inline void
+FrameStats::CountProgramSwitch() {
+    ++sCurrent.mProgramSwitches;
+}
+
+inline void
+FrameStats::CountTextureBind() {
+    ++sCurrent.mTextureBinds;
+}
+
+inline void
+FrameStats::CountVAOBind() {
+    ++sCurrent.mVAOBinds;
+}
+
+inline void
+FrameStats::CountUniformUpload() {
+    ++sCurrent.mUniformUploads;
+}
+
+inline void
+FrameStats::CountUploadBytes(unsigned long long bytes) {
+    sCurrent.mUploadBytes += bytes;
+}
+
+inline void
+FrameStats::CountUniformLookup() {
+    ++sCurrent.mUniformLookups;
+}
@@ -0,0 +1,75 @@
+#include "gl_handle.hpp"
+#include <GL/glew.h>
+#include <atomic>
+
+static std::atomic<unsigned> sLiveCounts[GL_OBJECT_TYPE_COUNT];
+
+unsigned
+GLObjects::Generate(EGLObjectType type) {
+    unsigned Id = 0;
+    switch (type) {
+    case GL_OBJECT_BUFFER: glGenBuffers(1, &Id); break;
+    case GL_OBJECT_VERTEX_ARRAY: glGenVertexArrays(1, &Id); break;
+    case GL_OBJECT_TEXTURE: glGenTextures(1, &Id); break;
+    case GL_OBJECT_PROGRAM: Id = glCreateProgram(); break;
+    case GL_OBJECT_SAMPLER: glGenSamplers(1, &Id); break;
+    default: break;
+    }
+
+    if (Id) {
+        Adopt(type);
+    }
+    return Id;
+}
+
+void
+GLObjects::Delete(EGLObjectType type, unsigned id) {
+    switch (type) {
+    case GL_OBJECT_BUFFER: glDeleteBuffers(1, &id); break;
+    case GL_OBJECT_VERTEX_ARRAY: glDeleteVertexArrays(1, &id); break;
+    case GL_OBJECT_TEXTURE: glDeleteTextures(1, &id); break;
+    case GL_OBJECT_PROGRAM: glDeleteProgram(id); break;
+    case GL_OBJECT_SAMPLER: glDeleteSamplers(1, &id); break;
+    default: break;
+    }
+    sLiveCounts[type].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void
+GLObjects::Adopt(EGLObjectType type) {
+    sLiveCounts[type].fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned
+GLObjects::GetLiveCount(EGLObjectType type) {
+    return sLiveCounts[type].load(std::memory_order_relaxed);
+}
+
+unsigned
+GLObjects::GetLiveCount() {
+    unsigned Count = 0;
+    for (unsigned TypeIdx = 0; TypeIdx < GL_OBJECT_TYPE_COUNT; ++TypeIdx) {
+        Count += GetLiveCount((EGLObjectType)TypeIdx);
+    }
+    return Count;
+}
+
+const char*
+GLObjects::GetTypeName(EGLObjectType type) {
+    static const char* Names[GL_OBJECT_TYPE_COUNT] = { "buffers", "vertex arrays", "textures", "programs", "samplers" };
+    return type < GL_OBJECT_TYPE_COUNT ? Names[type] : "unknown";
+}
+
+void
+GLObjects::Report(std::ostream& output) {
+    if (!GetLiveCount()) {
+        output << "GL objects: all released" << std::endl;
+        return;
+    }
+
+    output << "[Warn] GL objects still alive:";
+    for (unsigned TypeIdx = 0; TypeIdx < GL_OBJECT_TYPE_COUNT; ++TypeIdx) {
+        output << " " << GetLiveCount((EGLObjectType)TypeIdx) << " " << GetTypeName((EGLObjectType)TypeIdx);
+    }
+    output << std::endl;
+}
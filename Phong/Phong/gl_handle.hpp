@@ -0,0 +1,153 @@
+/**
+ * @file gl_handle.hpp
+ * @brief Move-only owners of GL object names with a live object counter for leak checks
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <iostream>
+#include <string>
+#include "memory_tracker.hpp"
+
+enum EGLObjectType {
+    GL_OBJECT_BUFFER = 0,
+    GL_OBJECT_VERTEX_ARRAY = 1,
+    GL_OBJECT_TEXTURE = 2,
+    GL_OBJECT_PROGRAM = 3,
+    GL_OBJECT_SAMPLER = 4,
+    GL_OBJECT_TYPE_COUNT = 5,
+};
+
+/**
+ * @brief Creates and deletes GL objects by type and counts the ones alive. Every handle goes
+ * through here, so a count left after a scene is destroyed is a leak
+ */
+class GLObjects {
+public:
+    static unsigned Generate(EGLObjectType type);
+    static void Delete(EGLObjectType type, unsigned id);
+
+    /**
+     * @brief Counts an object created outside Generate, such as a linked program, as alive
+     *
+     */
+    static void Adopt(EGLObjectType type);
+
+    static unsigned GetLiveCount(EGLObjectType type);
+    static unsigned GetLiveCount();
+    static const char* GetTypeName(EGLObjectType type);
+
+    /**
+     * @brief Prints the live object counts, a warning when any are left
+     *
+     * @param output Stream to write to
+     */
+    static void Report(std::ostream& output);
+};
+
+/**
+ * @brief Owns one GL object name and deletes it when destroyed. Can be moved, never copied. Memory
+ * accounted to the object through Track is released together with it
+ */
+template<EGLObjectType Type>
+class GLHandle {
+public:
+    GLHandle() : mId(0), mCategory(MEMORY_CATEGORY_COUNT) {}
+
+    /**
+     * @brief Takes ownership of an existing name
+     *
+     */
+    explicit GLHandle(unsigned id) : mId(id), mCategory(MEMORY_CATEGORY_COUNT) {
+        if (mId) {
+            GLObjects::Adopt(Type);
+        }
+    }
+
+    GLHandle(GLHandle&& other) : mId(other.mId), mCategory(other.mCategory) {
+        other.mId = 0;
+        other.mCategory = MEMORY_CATEGORY_COUNT;
+    }
+
+    GLHandle& operator=(GLHandle&& other) {
+        if (this != &other) {
+            Reset();
+            mId = other.mId;
+            mCategory = other.mCategory;
+            other.mId = 0;
+            other.mCategory = MEMORY_CATEGORY_COUNT;
+        }
+        return *this;
+    }
+
+    GLHandle(const GLHandle&) = delete;
+    GLHandle& operator=(const GLHandle&) = delete;
+
+    ~GLHandle() {
+        Reset();
+    }
+
+    static GLHandle Create() {
+        GLHandle Handle;
+        Handle.mId = GLObjects::Generate(Type);
+        return Handle;
+    }
+
+    /**
+     * @brief Charges the object to a memory category until it is deleted
+     *
+     * @param category Memory category
+     * @param bytes Size in bytes
+     * @param owner Owner name for the report
+     */
+    void Track(EMemoryCategory category, unsigned long long bytes, const std::string& owner) {
+        mCategory = category;
+        MemoryTracker::Track(category, mId, bytes, owner);
+    }
+
+    /**
+     * @brief Updates the size charged by Track, for objects whose storage is redefined while they live
+     *
+     * @param bytes New size in bytes
+     */
+    void Resize(unsigned long long bytes) {
+        if (mCategory != MEMORY_CATEGORY_COUNT) {
+            MemoryTracker::Resize(mCategory, mId, bytes);
+        }
+    }
+
+    /**
+     * @brief Deletes the object, the handle is empty afterwards
+     *
+     */
+    void Reset() {
+        if (!mId) {
+            return;
+        }
+
+        if (mCategory != MEMORY_CATEGORY_COUNT) {
+            MemoryTracker::Untrack(mCategory, mId);
+        }
+        GLObjects::Delete(Type, mId);
+        mId = 0;
+        mCategory = MEMORY_CATEGORY_COUNT;
+    }
+
+    unsigned Get() const {
+        return mId;
+    }
+
+private:
+    unsigned mId;
+    EMemoryCategory mCategory;
+};
+
+typedef GLHandle<GL_OBJECT_BUFFER> GLBuffer;
+typedef GLHandle<GL_OBJECT_VERTEX_ARRAY> GLVertexArray;
+typedef GLHandle<GL_OBJECT_TEXTURE> GLTexture;
+typedef GLHandle<GL_OBJECT_PROGRAM> GLProgram;
+typedef GLHandle<GL_OBJECT_SAMPLER> GLSampler;
@@ -0,0 +1,247 @@
+#include "gpu_profiler.hpp"
+#include <iomanip>
+#include <iostream>
+
+// NOTE: GPU and CPU clocks drift apart slowly, re-read both every few seconds
+static const unsigned CALIBRATION_INTERVAL = 256;
+
+GpuProfiler::GpuProfiler() {
+    for (unsigned SlotIdx = 0; SlotIdx < MAX_FRAMES; ++SlotIdx) {
+        FrameSlot& Slot = mSlots[SlotIdx];
+        for (unsigned QueryIdx = 0; QueryIdx < MAX_SCOPES * 2; ++QueryIdx) {
+            Slot.mQueries[QueryIdx] = 0;
+        }
+        Slot.mScopeCount = 0;
+        Slot.mQueryCount = 0;
+        Slot.mPending = false;
+    }
+    mCurrent = 0;
+    mDepth = 0;
+    mFrameCount = 0;
+    mDroppedFrames = 0;
+    mInitialized = false;
+    mTrack = 0;
+    mCalibrationGPU = 0;
+    mCalibrationCPU = 0;
+}
+
+GpuProfiler::~GpuProfiler() {
+    Destroy();
+}
+
+bool
+GpuProfiler::Init() {
+    Destroy();
+    for (unsigned SlotIdx = 0; SlotIdx < MAX_FRAMES; ++SlotIdx) {
+        glGenQueries(MAX_SCOPES * 2, mSlots[SlotIdx].mQueries);
+        mSlots[SlotIdx].mPending = false;
+    }
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "[Err] Failed to create GPU profiler queries" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    // NOTE: Reserved up front, new scope names must not allocate mid frame
+    mHistory.reserve(MAX_SCOPES);
+    mTrack = Profiler::IsEnabled() ? Profiler::CreateTrack("GPU") : 0;
+    mInitialized = true;
+    mFrameCount = 0;
+    if (mTrack) {
+        calibrate();
+    }
+    return true;
+}
+
+void
+GpuProfiler::Destroy() {
+    if (!mInitialized) {
+        return;
+    }
+
+    for (unsigned SlotIdx = 0; SlotIdx < MAX_FRAMES; ++SlotIdx) {
+        glDeleteQueries(MAX_SCOPES * 2, mSlots[SlotIdx].mQueries);
+        mSlots[SlotIdx].mPending = false;
+    }
+    mTrack = 0;
+    mInitialized = false;
+}
+
+void
+GpuProfiler::BeginFrame() {
+    if (!mInitialized) {
+        return;
+    }
+
+    mCurrent = (mCurrent + 1) % MAX_FRAMES;
+    FrameSlot& Slot = mSlots[mCurrent];
+    if (Slot.mPending) {
+        resolveSlot(Slot);
+    }
+    if (mTrack && ++mFrameCount % CALIBRATION_INTERVAL == 0) {
+        calibrate();
+    }
+
+    Slot.mScopeCount = 0;
+    Slot.mQueryCount = 0;
+    mDepth = 0;
+}
+
+void
+GpuProfiler::EndFrame() {
+    if (!mInitialized) {
+        return;
+    }
+
+    if (mDepth) {
+        std::cerr << "[Warn] " << mDepth << " GPU scope(s) left open at the end of the frame" << std::endl;
+        while (mDepth) {
+            EndScope();
+        }
+    }
+    mSlots[mCurrent].mPending = mSlots[mCurrent].mScopeCount > 0;
+}
+
+void
+GpuProfiler::BeginScope(const char* name) {
+    // NOTE: Scopes that don't fit are still counted so EndScope stays balanced
+    if (mDepth >= MAX_SCOPES) {
+        ++mDepth;
+        return;
+    }
+
+    FrameSlot& Slot = mSlots[mCurrent];
+    if (!mInitialized || Slot.mScopeCount >= MAX_SCOPES) {
+        mOpenScopes[mDepth++] = MAX_SCOPES;
+        return;
+    }
+
+    ScopeRecord& Scope = Slot.mScopes[Slot.mScopeCount];
+    Scope.mName = name;
+    Scope.mDepth = mDepth;
+    Scope.mBeginQuery = Slot.mQueryCount++;
+    Scope.mEndQuery = Scope.mBeginQuery;
+    glQueryCounter(Slot.mQueries[Scope.mBeginQuery], GL_TIMESTAMP);
+    mOpenScopes[mDepth++] = Slot.mScopeCount++;
+}
+
+void
+GpuProfiler::EndScope() {
+    if (!mDepth) {
+        return;
+    }
+
+    if (--mDepth >= MAX_SCOPES || mOpenScopes[mDepth] >= MAX_SCOPES) {
+        return;
+    }
+
+    unsigned ScopeIdx = mOpenScopes[mDepth];
+
+    FrameSlot& Slot = mSlots[mCurrent];
+    ScopeRecord& Scope = Slot.mScopes[ScopeIdx];
+    Scope.mEndQuery = Slot.mQueryCount++;
+    glQueryCounter(Slot.mQueries[Scope.mEndQuery], GL_TIMESTAMP);
+}
+
+unsigned
+GpuProfiler::GetScopeCount() const {
+    return mHistory.size();
+}
+
+GpuScopeStats
+GpuProfiler::GetScopeStats(unsigned index) const {
+    const ScopeHistory& History = mHistory[index];
+    GpuScopeStats Stats = { History.mName, History.mDepth, 0.0, 0.0, 0.0, 0.0, History.mCount };
+    if (!History.mCount) {
+        return Stats;
+    }
+
+    Stats.mLast = History.mSamples[(History.mHead + HISTORY_SIZE - 1) % HISTORY_SIZE];
+    Stats.mMin = History.mSamples[0];
+    Stats.mMax = History.mSamples[0];
+    double Total = 0.0;
+    for (unsigned SampleIdx = 0; SampleIdx < History.mCount; ++SampleIdx) {
+        double Sample = History.mSamples[SampleIdx];
+        Total += Sample;
+        Stats.mMin = Sample < Stats.mMin ? Sample : Stats.mMin;
+        Stats.mMax = Sample > Stats.mMax ? Sample : Stats.mMax;
+    }
+    Stats.mAverage = Total / History.mCount;
+    return Stats;
+}
+
+unsigned
+GpuProfiler::GetDroppedFrames() const {
+    return mDroppedFrames;
+}
+
+void
+GpuProfiler::Print(std::ostream& output) const {
+    if (mHistory.empty()) {
+        return;
+    }
+
+    std::ios::fmtflags Flags = output.flags();
+    output << "GPU scopes over the last " << HISTORY_SIZE << " frames (ms), " << mDroppedFrames << " frames dropped" << std::endl;
+    output << std::fixed << std::setprecision(3);
+    for (unsigned ScopeIdx = 0; ScopeIdx < mHistory.size(); ++ScopeIdx) {
+        GpuScopeStats Stats = GetScopeStats(ScopeIdx);
+        output << "  " << std::string(Stats.mDepth * 2, ' ') << std::left << std::setw(20 - Stats.mDepth * 2) << Stats.mName << std::right
+            << " avg " << std::setw(8) << Stats.mAverage * 1000.0 << "  min " << std::setw(8) << Stats.mMin * 1000.0
+            << "  max " << std::setw(8) << Stats.mMax * 1000.0 << std::endl;
+    }
+    output.flags(Flags);
+}
+
+void
+GpuProfiler::resolveSlot(FrameSlot& slot) {
+    slot.mPending = false;
+    // NOTE: Queries complete in order, if the last one is ready so are all the others
+    GLint Available = GL_FALSE;
+    glGetQueryObjectiv(slot.mQueries[slot.mQueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &Available);
+    if (!Available) {
+        ++mDroppedFrames;
+        return;
+    }
+
+    double TicksPerNanosecond = Profiler::GetTicksPerSecond() / 1e9;
+    for (unsigned ScopeIdx = 0; ScopeIdx < slot.mScopeCount; ++ScopeIdx) {
+        const ScopeRecord& Scope = slot.mScopes[ScopeIdx];
+        GLuint64 Begin = 0;
+        GLuint64 End = 0;
+        glGetQueryObjectui64v(slot.mQueries[Scope.mBeginQuery], GL_QUERY_RESULT, &Begin);
+        glGetQueryObjectui64v(slot.mQueries[Scope.mEndQuery], GL_QUERY_RESULT, &End);
+
+        ScopeHistory& History = findHistory(Scope.mName, Scope.mDepth);
+        History.mSamples[History.mHead] = End > Begin ? (End - Begin) / 1e9 : 0.0;
+        History.mHead = (History.mHead + 1) % HISTORY_SIZE;
+        History.mCount += History.mCount < HISTORY_SIZE;
+
+        if (mTrack && Profiler::IsEnabled()) {
+            unsigned long long Start = mCalibrationCPU + (long long)(((GLint64)Begin - mCalibrationGPU) * TicksPerNanosecond);
+            unsigned long long Finish = mCalibrationCPU + (long long)(((GLint64)End - mCalibrationGPU) * TicksPerNanosecond);
+            Profiler::RecordTo(mTrack, Scope.mName, Start, Finish, 0);
+        }
+    }
+}
+
+void
+GpuProfiler::calibrate() {
+    glGetInteger64v(GL_TIMESTAMP, &mCalibrationGPU);
+    mCalibrationCPU = ProfilerTicks();
+}
+
+GpuProfiler::ScopeHistory&
+GpuProfiler::findHistory(const char* name, unsigned depth) {
+    for (unsigned HistoryIdx = 0; HistoryIdx < mHistory.size(); ++HistoryIdx) {
+        if (mHistory[HistoryIdx].mName == name) {
+            return mHistory[HistoryIdx];
+        }
+    }
+
+    ScopeHistory History = { };
+    History.mName = name;
+    History.mDepth = depth;
+    mHistory.push_back(History);
+    return mHistory.back();
+}
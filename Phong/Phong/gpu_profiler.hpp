@@ -0,0 +1,141 @@
+/**
+ * @file gpu_profiler.hpp
+ * @brief Named GPU timing scopes from timestamp queries, with a rolling history per scope
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <ostream>
+#include <vector>
+#include "profiler.hpp"
+
+struct GpuScopeStats {
+    const char* mName;
+    unsigned mDepth;
+    // NOTE: All times are in seconds, averaged over the last HISTORY_SIZE resolved frames
+    double mLast;
+    double mAverage;
+    double mMin;
+    double mMax;
+    unsigned mSamples;
+};
+
+/**
+ * @brief Brackets scopes with GL_TIMESTAMP queries, so scopes nest, unlike GL_TIME_ELAPSED which
+ * the frame pacer already uses. Each frame gets its own query set and results are read
+ * MAX_FRAMES frames later, by which point the frame pacer has already waited on them
+ */
+class GpuProfiler {
+public:
+    static const unsigned MAX_FRAMES = 4;
+    static const unsigned MAX_SCOPES = 32;
+    static const unsigned HISTORY_SIZE = 120;
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    /**
+     * @brief Creates the query objects. When the CPU profiler is enabled, resolved scopes
+     * are also added to its trace on a "GPU" track
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init();
+    void Destroy();
+
+    /**
+     * @brief Resolves the oldest frame's queries and starts recording a new frame
+     *
+     */
+    void BeginFrame();
+    void EndFrame();
+
+    /**
+     * @brief Opens a scope. Scopes nest and must be closed in reverse order within the frame
+     *
+     * @param name Scope name, must outlive the profiler
+     */
+    void BeginScope(const char* name);
+    void EndScope();
+
+    unsigned GetScopeCount() const;
+    GpuScopeStats GetScopeStats(unsigned index) const;
+
+    /**
+     * @brief Frames whose queries weren't ready when their slot was reused and were skipped
+     *
+     */
+    unsigned GetDroppedFrames() const;
+
+    /**
+     * @brief Prints the rolling average, min and max of every scope seen
+     *
+     * @param output Stream to print to
+     */
+    void Print(std::ostream& output) const;
+
+private:
+    struct ScopeRecord {
+        const char* mName;
+        unsigned mBeginQuery;
+        unsigned mEndQuery;
+        unsigned mDepth;
+    };
+
+    struct FrameSlot {
+        unsigned mQueries[MAX_SCOPES * 2];
+        ScopeRecord mScopes[MAX_SCOPES];
+        unsigned mScopeCount;
+        unsigned mQueryCount;
+        bool mPending;
+    };
+
+    struct ScopeHistory {
+        const char* mName;
+        unsigned mDepth;
+        double mSamples[HISTORY_SIZE];
+        unsigned mCount;
+        unsigned mHead;
+    };
+
+    FrameSlot mSlots[MAX_FRAMES];
+    unsigned mCurrent;
+    unsigned mOpenScopes[MAX_SCOPES];
+    unsigned mDepth;
+    unsigned mFrameCount;
+    unsigned mDroppedFrames;
+    bool mInitialized;
+    std::vector<ScopeHistory> mHistory;
+    ProfileThreadBuffer* mTrack;
+    // NOTE: A GPU timestamp and the CPU tick count read at the same moment, to place GPU scopes in the CPU trace
+    GLint64 mCalibrationGPU;
+    unsigned long long mCalibrationCPU;
+
+    void resolveSlot(FrameSlot& slot);
+    void calibrate();
+    ScopeHistory& findHistory(const char* name, unsigned depth);
+};
+
+/**
+ * @brief Times the enclosing scope on the GPU. Use through GPU_PROFILE_ZONE
+ */
+class GpuProfileZone {
+public:
+    GpuProfileZone(GpuProfiler& profiler, const char* name) : mProfiler(profiler) {
+        mProfiler.BeginScope(name);
+    }
+
+    ~GpuProfileZone() {
+        mProfiler.EndScope();
+    }
+
+private:
+    GpuProfiler& mProfiler;
+};
+
+#define GPU_PROFILE_ZONE(profiler, name) GpuProfileZone PROFILE_CONCAT(GpuProfileZone, __LINE__)(profiler, name)
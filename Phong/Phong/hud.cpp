@@ -0,0 +1,392 @@
+#include "hud.hpp"
+#include "profiler.hpp"
+#include "memory_tracker.hpp"
+#include "alloc_tracker.hpp"
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+static const unsigned HUD_GLYPH_WIDTH = 5;
+static const unsigned HUD_GLYPH_HEIGHT = 7;
+// NOTE: Cells are one texel larger than glyphs so nearest sampling never bleeds into a neighbour
+static const unsigned HUD_CELL_WIDTH = HUD_GLYPH_WIDTH + 1;
+static const unsigned HUD_CELL_HEIGHT = HUD_GLYPH_HEIGHT + 1;
+static const unsigned HUD_ATLAS_COLUMNS = 16;
+static const unsigned HUD_ATLAS_ROWS = 4;
+static const unsigned HUD_ATLAS_WIDTH = HUD_ATLAS_COLUMNS * HUD_CELL_WIDTH;
+static const unsigned HUD_ATLAS_HEIGHT = HUD_ATLAS_ROWS * HUD_CELL_HEIGHT;
+static const float HUD_SCALE = 2.0f;
+static const float HUD_MARGIN = 10.0f;
+// NOTE: Graph bars reach the top at this frame time, the target line marks 60 FPS
+static const float HUD_GRAPH_MAX_TIME = 1.0f / 30.0f;
+static const float HUD_GRAPH_TARGET_TIME = 1.0f / 60.0f;
+// NOTE: Resident memory is an OS query, refreshed every this many frames
+static const unsigned HUD_MEMORY_INTERVAL = 30;
+
+// NOTE: 5x7 glyphs, one byte per row with the leftmost pixel in bit 4. Lower case is drawn as upper case
+static const char GLYPH_CHARS[] = " .:/%-|(),=+0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const unsigned char GLYPH_ROWS[][HUD_GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // '.'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // '/'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // '%'
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // '-'
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // '|'
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // ')'
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ','
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // '='
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // '+'
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // '9'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 }, // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // 'Z'
+};
+static const unsigned GLYPH_COUNT = sizeof(GLYPH_ROWS) / sizeof(GLYPH_ROWS[0]);
+
+static inline unsigned
+PackColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    return r | (g << 8) | (b << 16) | ((unsigned)a << 24);
+}
+
+static unsigned long long
+QueryResidentMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS Counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters))) {
+        return Counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    FILE* Statm = fopen("/proc/self/statm", "r");
+    if (!Statm) {
+        return 0;
+    }
+
+    unsigned long long Size = 0;
+    unsigned long long Resident = 0;
+    if (fscanf(Statm, "%llu %llu", &Size, &Resident) != 2) {
+        Resident = 0;
+    }
+    fclose(Statm);
+    return Resident * (unsigned long long)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+Hud::Hud() {
+    mShader = 0;
+    mVAO = 0;
+    mVBO = 0;
+    mAtlas = 0;
+    mVertices = 0;
+    mVertexCount = 0;
+    memset(mGlyphCells, 0, sizeof(mGlyphCells));
+    mSolidCell = 0;
+    memset(mFrameTimes, 0, sizeof(mFrameTimes));
+    mHistoryHead = 0;
+    mHasLastUpdate = false;
+    mProcessMemory = 0;
+    mMemoryAge = HUD_MEMORY_INTERVAL;
+    mPixelWidth = 0.0f;
+    mPixelHeight = 0.0f;
+}
+
+Hud::~Hud() {
+    delete[] mVertices;
+}
+
+bool
+Hud::Init() {
+    mShader = new Shader("shaders/hud.vert", "shaders/hud.frag");
+    if (!mShader->GetId()) {
+        std::cerr << "[Err] Failed to create HUD shader" << std::endl;
+        return false;
+    }
+
+    glUseProgram(mShader->GetId());
+    mShader->SetUniform1i("uAtlas", 0);
+    glUseProgram(0);
+
+    createAtlas();
+    mVertices = new HudVertex[MAX_QUADS * 6];
+
+    glGenVertexArrays(1, &mVAO);
+    glBindVertexArray(mVAO);
+    glGenBuffers(1, &mVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 6 * sizeof(HudVertex), 0, GL_STREAM_DRAW);
+    MemoryTracker::Track(MEMORY_STREAM_BUFFER, mVBO, MAX_QUADS * 6 * sizeof(HudVertex), "HUD");
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return true;
+}
+
+void
+Hud::Destroy() {
+    if (mVAO) {
+        MemoryTracker::Untrack(MEMORY_STREAM_BUFFER, mVBO);
+        glDeleteVertexArrays(1, &mVAO);
+        glDeleteBuffers(1, &mVBO);
+        mVAO = 0;
+        mVBO = 0;
+    }
+    if (mAtlas) {
+        MemoryTracker::Untrack(MEMORY_TEXTURE, mAtlas);
+        glDeleteTextures(1, &mAtlas);
+        mAtlas = 0;
+    }
+    delete mShader;
+    mShader = 0;
+    delete[] mVertices;
+    mVertices = 0;
+}
+
+void
+Hud::Update() {
+    std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+    if (mHasLastUpdate) {
+        mFrameTimes[mHistoryHead] = std::chrono::duration<float>(Now - mLastUpdate).count();
+        mHistoryHead = (mHistoryHead + 1) % HISTORY_SIZE;
+    }
+    mLastUpdate = Now;
+    mHasLastUpdate = true;
+
+    if (++mMemoryAge >= HUD_MEMORY_INTERVAL) {
+        mProcessMemory = QueryResidentMemory();
+        mMemoryAge = 0;
+    }
+}
+
+void
+Hud::Render(const FrameTiming& timing, const RenderCounters& counters, unsigned framesInFlight, int width, int height) {
+    PROFILE_FUNCTION();
+    if (!mVAO || width <= 0 || height <= 0) {
+        return;
+    }
+
+    mPixelWidth = 2.0f / width;
+    mPixelHeight = 2.0f / height;
+    mVertexCount = 0;
+
+    float AverageTime = 0.0f;
+    for (unsigned SampleIdx = 0; SampleIdx < HISTORY_SIZE; ++SampleIdx) {
+        AverageTime += mFrameTimes[SampleIdx];
+    }
+    AverageTime /= HISTORY_SIZE;
+
+    // NOTE: Lines are formatted into a stack buffer, building the overlay never allocates
+    char Lines[5][64];
+    snprintf(Lines[0], sizeof(Lines[0]), "FPS %.1f  %.2f ms", AverageTime > 0.0f ? 1.0f / AverageTime : 0.0f, AverageTime * 1000.0f);
+    snprintf(Lines[1], sizeof(Lines[1]), "CPU %.2f ms  GPU %.2f ms  Queue %u/%u",
+        timing.mCPUTime * 1000.0, timing.mGPUTime * 1000.0, timing.mQueueDepth, framesInFlight);
+    snprintf(Lines[2], sizeof(Lines[2]), "Draws %llu  Tris %llu  Allocs %llu", counters.mDrawCalls, counters.mTriangles,
+        AllocationTracker::GetLastFrame().mAllocations);
+    snprintf(Lines[3], sizeof(Lines[3]), "Programs %llu  Textures %llu  Uniforms %llu",
+        counters.mProgramSwitches, counters.mTextureBinds, counters.mUniformUploads);
+    snprintf(Lines[4], sizeof(Lines[4]), "Memory %.1f MB  GPU %.1f MB  Upload %.1f KB", mProcessMemory / (1024.0 * 1024.0),
+        MemoryTracker::GetGPUBytes() / (1024.0 * 1024.0), counters.mUploadBytes / 1024.0);
+
+    float LineHeight = (HUD_CELL_HEIGHT + 1) * HUD_SCALE;
+    float GraphHeight = 60.0f;
+    float PanelWidth = 0.0f;
+    for (unsigned LineIdx = 0; LineIdx < 5; ++LineIdx) {
+        float LineWidth = strlen(Lines[LineIdx]) * HUD_CELL_WIDTH * HUD_SCALE;
+        PanelWidth = LineWidth > PanelWidth ? LineWidth : PanelWidth;
+    }
+    float PanelHeight = 5 * LineHeight + GraphHeight + HUD_MARGIN;
+    pushQuad(HUD_MARGIN, HUD_MARGIN, PanelWidth + 2 * HUD_MARGIN, PanelHeight + 2 * HUD_MARGIN, mSolidCell, PackColor(0, 0, 0, 160));
+
+    float X = 2 * HUD_MARGIN;
+    float Y = 2 * HUD_MARGIN;
+    for (unsigned LineIdx = 0; LineIdx < 5; ++LineIdx) {
+        pushText(X, Y, Lines[LineIdx], PackColor(255, 255, 255, 255));
+        Y += LineHeight;
+    }
+    pushGraph(X, Y + HUD_MARGIN, PanelWidth, GraphHeight);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // NOTE: Orphaning the store lets the driver hand out fresh memory instead of waiting for last frame's draw
+    unsigned UploadSize = mVertexCount * sizeof(HudVertex);
+    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 6 * sizeof(HudVertex), 0, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, UploadSize, mVertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    FrameStats::CountUploadBytes(UploadSize);
+
+    glUseProgram(mShader->GetId());
+    FrameStats::CountProgramSwitch();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mAtlas);
+    FrameStats::CountTextureBind();
+    glBindVertexArray(mVAO);
+    FrameStats::CountVAOBind();
+    glDrawArrays(GL_TRIANGLES, 0, mVertexCount);
+    FrameStats::CountDraw(GL_TRIANGLES, mVertexCount);
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void
+Hud::createAtlas() {
+    unsigned char Texels[HUD_ATLAS_WIDTH * HUD_ATLAS_HEIGHT];
+    memset(Texels, 0, sizeof(Texels));
+    for (unsigned GlyphIdx = 0; GlyphIdx < GLYPH_COUNT; ++GlyphIdx) {
+        unsigned CellX = (GlyphIdx % HUD_ATLAS_COLUMNS) * HUD_CELL_WIDTH;
+        unsigned CellY = (GlyphIdx / HUD_ATLAS_COLUMNS) * HUD_CELL_HEIGHT;
+        for (unsigned Row = 0; Row < HUD_GLYPH_HEIGHT; ++Row) {
+            for (unsigned Column = 0; Column < HUD_GLYPH_WIDTH; ++Column) {
+                if (GLYPH_ROWS[GlyphIdx][Row] & (0x10 >> Column)) {
+                    Texels[(CellY + Row) * HUD_ATLAS_WIDTH + CellX + Column] = 255;
+                }
+            }
+        }
+    }
+
+    // NOTE: A fully lit cell after the glyphs lets panels and graph bars share the text draw
+    mSolidCell = GLYPH_COUNT;
+    unsigned SolidX = (mSolidCell % HUD_ATLAS_COLUMNS) * HUD_CELL_WIDTH;
+    unsigned SolidY = (mSolidCell / HUD_ATLAS_COLUMNS) * HUD_CELL_HEIGHT;
+    for (unsigned Row = 0; Row < HUD_CELL_HEIGHT; ++Row) {
+        memset(&Texels[(SolidY + Row) * HUD_ATLAS_WIDTH + SolidX], 255, HUD_CELL_WIDTH);
+    }
+
+    for (unsigned Character = 0; Character < 128; ++Character) {
+        char Upper = Character >= 'a' && Character <= 'z' ? (char)(Character - 'a' + 'A') : (char)Character;
+        const char* Found = Character ? strchr(GLYPH_CHARS, Upper) : 0;
+        mGlyphCells[Character] = Found ? (unsigned char)(Found - GLYPH_CHARS) : 0;
+    }
+
+    glGenTextures(1, &mAtlas);
+    glBindTexture(GL_TEXTURE_2D, mAtlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, HUD_ATLAS_WIDTH, HUD_ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, Texels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    FrameStats::CountUploadBytes(sizeof(Texels));
+    MemoryTracker::Track(MEMORY_TEXTURE, mAtlas, sizeof(Texels), "HUD");
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void
+Hud::pushQuad(float x, float y, float w, float h, unsigned cell, unsigned color) {
+    if (mVertexCount + 6 > MAX_QUADS * 6) {
+        return;
+    }
+
+    // NOTE: Solid quads sample the middle of the lit cell, glyphs map the whole glyph
+    float U0 = (float)((cell % HUD_ATLAS_COLUMNS) * HUD_CELL_WIDTH) / HUD_ATLAS_WIDTH;
+    float V0 = (float)((cell / HUD_ATLAS_COLUMNS) * HUD_CELL_HEIGHT) / HUD_ATLAS_HEIGHT;
+    float U1 = U0 + (float)HUD_GLYPH_WIDTH / HUD_ATLAS_WIDTH;
+    float V1 = V0 + (float)HUD_GLYPH_HEIGHT / HUD_ATLAS_HEIGHT;
+    if (cell == mSolidCell) {
+        U0 = U1 = U0 + 0.5f * HUD_CELL_WIDTH / HUD_ATLAS_WIDTH;
+        V0 = V1 = V0 + 0.5f * HUD_CELL_HEIGHT / HUD_ATLAS_HEIGHT;
+    }
+
+    float Left = x * mPixelWidth - 1.0f;
+    float Right = (x + w) * mPixelWidth - 1.0f;
+    float Top = 1.0f - y * mPixelHeight;
+    float Bottom = 1.0f - (y + h) * mPixelHeight;
+    HudVertex* Quad = &mVertices[mVertexCount];
+    HudVertex TopLeft = { Left, Top, U0, V0, color };
+    HudVertex TopRight = { Right, Top, U1, V0, color };
+    HudVertex BottomLeft = { Left, Bottom, U0, V1, color };
+    HudVertex BottomRight = { Right, Bottom, U1, V1, color };
+    Quad[0] = BottomLeft;
+    Quad[1] = BottomRight;
+    Quad[2] = TopRight;
+    Quad[3] = BottomLeft;
+    Quad[4] = TopRight;
+    Quad[5] = TopLeft;
+    mVertexCount += 6;
+}
+
+float
+Hud::pushText(float x, float y, const char* text, unsigned color) {
+    for (const char* Character = text; *Character; ++Character) {
+        unsigned Cell = mGlyphCells[(unsigned char)*Character & 0x7F];
+        // NOTE: Blank cells cost nothing to skip
+        if (Cell) {
+            pushQuad(x, y, HUD_GLYPH_WIDTH * HUD_SCALE, HUD_GLYPH_HEIGHT * HUD_SCALE, Cell, color);
+        }
+        x += HUD_CELL_WIDTH * HUD_SCALE;
+    }
+    return x;
+}
+
+void
+Hud::pushGraph(float x, float y, float w, float h) {
+    pushQuad(x, y, w, h, mSolidCell, PackColor(40, 40, 40, 200));
+    float BarWidth = w / HISTORY_SIZE;
+    for (unsigned SampleIdx = 0; SampleIdx < HISTORY_SIZE; ++SampleIdx) {
+        // NOTE: Oldest sample on the left
+        float FrameTime = mFrameTimes[(mHistoryHead + SampleIdx) % HISTORY_SIZE];
+        float BarHeight = FrameTime / HUD_GRAPH_MAX_TIME;
+        BarHeight = (BarHeight > 1.0f ? 1.0f : BarHeight) * h;
+        unsigned Color = FrameTime <= HUD_GRAPH_TARGET_TIME * 1.05f ? PackColor(80, 220, 80, 255)
+            : FrameTime <= HUD_GRAPH_MAX_TIME ? PackColor(230, 200, 60, 255) : PackColor(230, 60, 60, 255);
+        pushQuad(x + SampleIdx * BarWidth, y + h - BarHeight, BarWidth, BarHeight, mSolidCell, Color);
+    }
+
+    float TargetY = y + h - HUD_GRAPH_TARGET_TIME / HUD_GRAPH_MAX_TIME * h;
+    pushQuad(x, TargetY, w, 1.0f, mSolidCell, PackColor(255, 255, 255, 120));
+}
@@ -0,0 +1,89 @@
+/**
+ * @file hud.hpp
+ * @brief On-screen performance overlay drawn in a single batched draw from a baked glyph atlas
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <chrono>
+#include "shader.hpp"
+#include "frame_pacer.hpp"
+#include "frame_stats.hpp"
+
+struct HudVertex {
+    // NOTE: Position is already in clip space, the shader needs no uniforms
+    float mX;
+    float mY;
+    float mU;
+    float mV;
+    unsigned mColor;
+};
+
+class Hud {
+public:
+    static const unsigned HISTORY_SIZE = 120;
+    static const unsigned MAX_QUADS = 1024;
+
+    Hud();
+    ~Hud();
+
+    /**
+     * @brief Bakes the glyph atlas and creates the shader and vertex buffer. Requires a current GL context
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init();
+
+    /**
+     * @brief Releases GL resources. Must run on the thread owning the context
+     *
+     */
+    void Destroy();
+
+    /**
+     * @brief Records the interval since the previous call in the frame time graph. Call once
+     * per frame, also while the overlay is hidden so the graph is current when it is shown
+     *
+     */
+    void Update();
+
+    /**
+     * @brief Builds the overlay into the vertex buffer and draws it over the current framebuffer
+     *
+     * @param timing Latest resolved frame timing
+     * @param counters Render counters of the previous frame
+     * @param framesInFlight Frame pacer limit, shown next to the queue depth
+     * @param width Framebuffer width in pixels
+     * @param height Framebuffer height in pixels
+     */
+    void Render(const FrameTiming& timing, const RenderCounters& counters, unsigned framesInFlight, int width, int height);
+
+private:
+    Shader* mShader;
+    unsigned mVAO;
+    unsigned mVBO;
+    unsigned mAtlas;
+    HudVertex* mVertices;
+    unsigned mVertexCount;
+    // NOTE: Atlas cell of every ASCII character, unknown characters map to the blank cell
+    unsigned char mGlyphCells[128];
+    unsigned mSolidCell;
+    float mFrameTimes[HISTORY_SIZE];
+    unsigned mHistoryHead;
+    std::chrono::steady_clock::time_point mLastUpdate;
+    bool mHasLastUpdate;
+    unsigned long long mProcessMemory;
+    unsigned mMemoryAge;
+    float mPixelWidth;
+    float mPixelHeight;
+
+    void createAtlas();
+    void pushQuad(float x, float y, float w, float h, unsigned cell, unsigned color);
+    float pushText(float x, float y, const char* text, unsigned color);
+    void pushGraph(float x, float y, float w, float h);
+};
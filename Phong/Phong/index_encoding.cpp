@@ -0,0 +1,186 @@
+#include "index_encoding.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
+
+// NOTE: Directed edge of a triangle, from and to packed into the key, with the vertex completing the triangle
+struct StripEdge {
+    unsigned long long mKey;
+    unsigned mTriangle;
+    unsigned mThird;
+};
+
+static bool
+EdgeLess(const StripEdge& a, const StripEdge& b) {
+    return a.mKey < b.mKey || (a.mKey == b.mKey && a.mTriangle < b.mTriangle);
+}
+
+static unsigned long long
+EdgeKey(unsigned from, unsigned to) {
+    return ((unsigned long long)from << 32) | to;
+}
+
+// NOTE: First unused triangle holding the directed edge from -> to, its third vertex goes to third
+static bool
+FindTriangle(const StripEdge* edges, unsigned edgeCount, const unsigned char* used, unsigned from, unsigned to, unsigned& triangle, unsigned& third) {
+    StripEdge Key = { EdgeKey(from, to), 0, 0 };
+    const StripEdge* Edge = std::lower_bound(edges, edges + edgeCount, Key, EdgeLess);
+    for (; Edge != edges + edgeCount && Edge->mKey == Key.mKey; ++Edge) {
+        if (!used[Edge->mTriangle]) {
+            triangle = Edge->mTriangle;
+            third = Edge->mThird;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+PackIndices16(const unsigned* source, unsigned count, unsigned short* destination) {
+    // NOTE: Front to back, so packing in place never overwrites an index before it is read
+    for (unsigned Idx = 0; Idx < count; ++Idx) {
+        destination[Idx] = (unsigned short)source[Idx];
+    }
+}
+
+unsigned
+IndexEncoding::GetEncodeSize(unsigned triangleCount, EIndexEncoding encoding) {
+    switch (encoding) {
+    case INDEX_ENCODING_COMPACT_LIST: return LinearArena::AlignedSize(triangleCount * 3 * sizeof(unsigned short));
+    // NOTE: Edge table, used flags and the worst case strip buffer, one restart per triangle.
+    // A compact list that wins over the strips is packed into the strip buffer
+    case INDEX_ENCODING_AUTO: return LinearArena::AlignedSize(triangleCount * 3 * sizeof(StripEdge))
+        + LinearArena::AlignedSize(triangleCount) + LinearArena::AlignedSize(triangleCount * 4 * sizeof(unsigned));
+    default: return 0;
+    }
+}
+
+bool
+IndexEncoding::Encode(const unsigned* triangles, unsigned indexCount, unsigned vertexCount, EIndexEncoding encoding, LinearArena& arena, EncodedIndices& encoded) {
+    encoded.mData = (void*)triangles;
+    encoded.mCount = indexCount;
+    encoded.mType = GL_UNSIGNED_INT;
+    encoded.mMode = GL_TRIANGLES;
+    encoded.mTriangleCount = indexCount / 3;
+    if (encoding == INDEX_ENCODING_LIST_32 || !indexCount) {
+        return true;
+    }
+
+    unsigned Type = vertexCount <= MAX_16_BIT_VERTICES ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    if (encoding == INDEX_ENCODING_COMPACT_LIST) {
+        if (Type == GL_UNSIGNED_INT) {
+            return true;
+        }
+
+        unsigned short* Compact = arena.AllocateArray<unsigned short>(indexCount);
+        if (!Compact) {
+            return false;
+        }
+        PackIndices16(triangles, indexCount, Compact);
+        encoded.mData = Compact;
+        encoded.mType = GL_UNSIGNED_SHORT;
+        return true;
+    }
+
+    unsigned* Strips = arena.AllocateArray<unsigned>(indexCount / 3 * 4);
+    unsigned StripCount = Strips ? Stripify(triangles, indexCount, GetRestartIndex(Type), arena, Strips) : 0;
+    if (!StripCount) {
+        return false;
+    }
+
+    if (StripCount < indexCount) {
+        encoded.mData = Strips;
+        encoded.mCount = StripCount;
+        encoded.mMode = GL_TRIANGLE_STRIP;
+    } else if (Type == GL_UNSIGNED_SHORT) {
+        memcpy(Strips, triangles, indexCount * sizeof(unsigned));
+        encoded.mData = Strips;
+    }
+
+    if (Type == GL_UNSIGNED_SHORT) {
+        PackIndices16((const unsigned*)encoded.mData, encoded.mCount, (unsigned short*)encoded.mData);
+        encoded.mType = GL_UNSIGNED_SHORT;
+    }
+    return true;
+}
+
+unsigned
+IndexEncoding::Stripify(const unsigned* triangles, unsigned indexCount, unsigned restartIndex, LinearArena& arena, unsigned* strips) {
+    unsigned TriangleCount = indexCount / 3;
+    unsigned EdgeCount = TriangleCount * 3;
+    StripEdge* Edges = arena.AllocateArray<StripEdge>(EdgeCount);
+    unsigned char* Used = arena.AllocateArray<unsigned char>(TriangleCount);
+    if (!Edges || !Used) {
+        return 0;
+    }
+
+    for (unsigned TriangleIdx = 0; TriangleIdx < TriangleCount; ++TriangleIdx) {
+        const unsigned* Triangle = triangles + TriangleIdx * 3;
+        for (unsigned Corner = 0; Corner < 3; ++Corner) {
+            StripEdge& Edge = Edges[TriangleIdx * 3 + Corner];
+            Edge.mKey = EdgeKey(Triangle[Corner], Triangle[(Corner + 1) % 3]);
+            Edge.mTriangle = TriangleIdx;
+            Edge.mThird = Triangle[(Corner + 2) % 3];
+        }
+        Used[TriangleIdx] = 0;
+    }
+    std::sort(Edges, Edges + EdgeCount, EdgeLess);
+
+    unsigned Count = 0;
+    for (unsigned TriangleIdx = 0; TriangleIdx < TriangleCount; ++TriangleIdx) {
+        if (Used[TriangleIdx]) {
+            continue;
+        }
+
+        // NOTE: Starts on the rotation whose last edge has a neighbour, so the strip gets past one triangle
+        Used[TriangleIdx] = 1;
+        const unsigned* Triangle = triangles + TriangleIdx * 3;
+        unsigned Rotation = 0;
+        unsigned Next = 0;
+        unsigned Third = 0;
+        for (unsigned Candidate = 0; Candidate < 3; ++Candidate) {
+            if (FindTriangle(Edges, EdgeCount, Used, Triangle[(Candidate + 2) % 3], Triangle[(Candidate + 1) % 3], Next, Third)) {
+                Rotation = Candidate;
+                break;
+            }
+        }
+
+        if (Count) {
+            strips[Count++] = restartIndex;
+        }
+        strips[Count++] = Triangle[Rotation];
+        strips[Count++] = Triangle[(Rotation + 1) % 3];
+        strips[Count++] = Triangle[(Rotation + 2) % 3];
+
+        // NOTE: GL flips every odd triangle of a strip, so the edge the next triangle has to hold
+        // alternates direction. Triangles keep their winding that way
+        for (unsigned StripTriangle = 1; ; ++StripTriangle) {
+            unsigned A = strips[Count - 2];
+            unsigned B = strips[Count - 1];
+            bool Found = StripTriangle % 2 ? FindTriangle(Edges, EdgeCount, Used, B, A, Next, Third)
+                : FindTriangle(Edges, EdgeCount, Used, A, B, Next, Third);
+            if (!Found) {
+                break;
+            }
+            Used[Next] = 1;
+            strips[Count++] = Third;
+        }
+    }
+    return Count;
+}
+
+unsigned
+IndexEncoding::GetIndexSize(unsigned type) {
+    return type == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned);
+}
+
+unsigned
+IndexEncoding::GetRestartIndex(unsigned type) {
+    return type == GL_UNSIGNED_SHORT ? 0xFFFF : 0xFFFFFFFF;
+}
+
+const char*
+IndexEncoding::GetEncodingName(EIndexEncoding encoding) {
+    static const char* Names[INDEX_ENCODING_COUNT] = { "32 bit list", "compact list", "auto" };
+    return encoding < INDEX_ENCODING_COUNT ? Names[encoding] : "unknown";
+}
@@ -0,0 +1,83 @@
+/**
+ * @file index_encoding.hpp
+ * @brief Picks the index format of a mesh, 16 or 32 bit and triangle list or restart separated strips
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include "linear_arena.hpp"
+
+enum EIndexEncoding {
+    // NOTE: 32 bit triangle list, what every mesh used before
+    INDEX_ENCODING_LIST_32 = 0,
+    // NOTE: Triangle list, 16 bit when the vertex count allows it
+    INDEX_ENCODING_COMPACT_LIST = 1,
+    // NOTE: Compact list or triangle strips joined by primitive restart, whichever is smaller
+    INDEX_ENCODING_AUTO = 2,
+    INDEX_ENCODING_COUNT = 3,
+};
+
+// NOTE: Index buffer as it is uploaded and drawn. Data points into the import arena or at the source list
+struct EncodedIndices {
+    void* mData;
+    unsigned mCount;
+    // NOTE: GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    unsigned mType;
+    // NOTE: GL_TRIANGLES or GL_TRIANGLE_STRIP
+    unsigned mMode;
+    // NOTE: Triangles of the source list, strip counts include restarts and degenerate joins
+    unsigned mTriangleCount;
+};
+
+/**
+ * @brief Re-encodes triangle list indices into the smallest buffer the encoding allows. Strips
+ * keep the winding of every triangle, so culling is unaffected. Touches neither the GL nor the heap
+ */
+class IndexEncoding {
+public:
+    // NOTE: Highest vertex count 16 bit indices cover, 0xFFFF itself is the restart index
+    static const unsigned MAX_16_BIT_VERTICES = 0xFFFF;
+
+    /**
+     * @brief Arena bytes Encode needs on top of the triangle list
+     *
+     * @param triangleCount Triangles in the list
+     * @param encoding Encoding to size for
+     */
+    static unsigned GetEncodeSize(unsigned triangleCount, EIndexEncoding encoding);
+
+    /**
+     * @brief Encodes a triangle list
+     *
+     * @param triangles Triangle list indices, three per triangle
+     * @param indexCount Index count of the list
+     * @param vertexCount Vertices the indices refer to, decides the index width
+     * @param encoding Allowed encodings
+     * @param arena Arena with at least GetEncodeSize bytes free
+     * @param encoded Receives the buffer. LIST_32 points it at the source list without copying
+     *
+     * @returns true - Success, false - Arena too small
+     */
+    static bool Encode(const unsigned* triangles, unsigned indexCount, unsigned vertexCount, EIndexEncoding encoding, LinearArena& arena, EncodedIndices& encoded);
+
+    /**
+     * @brief Greedily joins triangles sharing an edge into strips separated by restartIndex
+     *
+     * @param triangles Triangle list indices
+     * @param indexCount Index count of the list
+     * @param restartIndex Value written between strips
+     * @param arena Arena with room for the edge table, see GetEncodeSize
+     * @param strips Output, room for 4 indices per triangle
+     *
+     * @returns Indices written, 0 when the arena is too small
+     */
+    static unsigned Stripify(const unsigned* triangles, unsigned indexCount, unsigned restartIndex, LinearArena& arena, unsigned* strips);
+
+    static unsigned GetIndexSize(unsigned type);
+    static unsigned GetRestartIndex(unsigned type);
+    static const char* GetEncodingName(EIndexEncoding encoding);
+};
@@ -0,0 +1,135 @@
+#include "input_record.hpp"
+#include <iostream>
+#include <cstring>
+
+static const char INPUT_MAGIC[4] = { 'P', 'H', 'I', 'R' };
+
+InputRecorder::InputRecorder() {
+    mFrameCount = 0;
+    mDuration = 0.0f;
+}
+
+InputRecorder::~InputRecorder() {
+    if (mOutput.is_open()) {
+        mOutput.close();
+    }
+}
+
+bool
+InputRecorder::Open(const std::string& filename) {
+    mOutput.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!mOutput) {
+        std::cerr << "[Err] Failed to open " << filename << " for recording" << std::endl;
+        return false;
+    }
+
+    unsigned Version = VERSION;
+    mFrameCount = 0;
+    mDuration = 0.0f;
+    mOutput.write(INPUT_MAGIC, sizeof(INPUT_MAGIC));
+    mOutput.write((const char*)&Version, sizeof(Version));
+    mOutput.write((const char*)&mFrameCount, sizeof(mFrameCount));
+    mOutput.write((const char*)&mDuration, sizeof(mDuration));
+    return true;
+}
+
+void
+InputRecorder::Record(float dt, unsigned short state) {
+    if (!mOutput.is_open()) {
+        return;
+    }
+
+    mOutput.write((const char*)&dt, sizeof(dt));
+    mOutput.write((const char*)&state, sizeof(state));
+    mDuration += dt;
+    ++mFrameCount;
+}
+
+void
+InputRecorder::Close() {
+    if (!mOutput.is_open()) {
+        return;
+    }
+
+    mOutput.seekp(sizeof(INPUT_MAGIC) + sizeof(unsigned));
+    mOutput.write((const char*)&mFrameCount, sizeof(mFrameCount));
+    mOutput.write((const char*)&mDuration, sizeof(mDuration));
+    mOutput.close();
+}
+
+bool
+InputRecorder::IsOpen() const {
+    return mOutput.is_open();
+}
+
+unsigned
+InputRecorder::GetFrameCount() const {
+    return mFrameCount;
+}
+
+float
+InputRecorder::GetDuration() const {
+    return mDuration;
+}
+
+InputPlayer::InputPlayer() {
+    mNext = 0;
+    mDuration = 0.0f;
+}
+
+bool
+InputPlayer::Open(const std::string& filename) {
+    std::ifstream Input(filename.c_str(), std::ios::binary);
+    if (!Input) {
+        std::cerr << "[Err] Failed to open input recording " << filename << std::endl;
+        return false;
+    }
+
+    char Magic[4];
+    unsigned Version = 0;
+    unsigned FrameCount = 0;
+    Input.read(Magic, sizeof(Magic));
+    Input.read((char*)&Version, sizeof(Version));
+    Input.read((char*)&FrameCount, sizeof(FrameCount));
+    Input.read((char*)&mDuration, sizeof(mDuration));
+    if (!Input || memcmp(Magic, INPUT_MAGIC, sizeof(Magic)) || Version != InputRecorder::VERSION) {
+        std::cerr << "[Err] " << filename << " is not a version " << InputRecorder::VERSION << " input recording" << std::endl;
+        return false;
+    }
+
+    mFrames.resize(FrameCount);
+    for (unsigned FrameIdx = 0; FrameIdx < FrameCount; ++FrameIdx) {
+        Input.read((char*)&mFrames[FrameIdx].mDT, sizeof(float));
+        Input.read((char*)&mFrames[FrameIdx].mState, sizeof(unsigned short));
+    }
+    if (!Input) {
+        std::cerr << "[Err] Input recording " << filename << " is truncated" << std::endl;
+        mFrames.clear();
+        return false;
+    }
+
+    mNext = 0;
+    return true;
+}
+
+bool
+InputPlayer::Advance(float& dt, unsigned short& state) {
+    if (mNext >= mFrames.size()) {
+        return false;
+    }
+
+    dt = mFrames[mNext].mDT;
+    state = mFrames[mNext].mState;
+    ++mNext;
+    return true;
+}
+
+float
+InputPlayer::GetDuration() const {
+    return mDuration;
+}
+
+unsigned
+InputPlayer::GetFrameCount() const {
+    return mFrames.size();
+}
@@ -0,0 +1,115 @@
+/**
+ * @file input_record.hpp
+ * @brief Records per frame input state and time step to a compact binary file and plays it back
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+// NOTE: Everything the simulation reads from the user, packed into one 16 bit mask
+enum EInputBit {
+    INPUT_MOVE_LEFT = 1 << 0,
+    INPUT_MOVE_RIGHT = 1 << 1,
+    INPUT_MOVE_UP = 1 << 2,
+    INPUT_MOVE_DOWN = 1 << 3,
+    INPUT_LOOK_LEFT = 1 << 4,
+    INPUT_LOOK_RIGHT = 1 << 5,
+    INPUT_LOOK_UP = 1 << 6,
+    INPUT_LOOK_DOWN = 1 << 7,
+    INPUT_CUBE_UP = 1 << 8,
+    INPUT_CUBE_DOWN = 1 << 9,
+    INPUT_FENJER = 1 << 10,
+    INPUT_DEBUG_LINES = 1 << 11,
+};
+
+/**
+ * @brief Input state and time step of one simulated frame
+ */
+struct InputFrame {
+    float mDT;
+    unsigned short mState;
+};
+
+/**
+ * @brief File layout, little endian:
+ * "PHIR", u32 version, u32 frame count, f32 duration, then per frame f32 delta and u16 state.
+ * Every frame is stored, the simulation only reproduces when it steps with the recorded deltas
+ */
+class InputRecorder {
+public:
+    static const unsigned VERSION = 2;
+
+    InputRecorder();
+    ~InputRecorder();
+
+    /**
+     * @brief Creates the file and writes a placeholder header
+     *
+     * @param filename Output path
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * @brief Records the time step and input state of the next simulated frame
+     *
+     * @param dt Delta the frame is simulated with, in seconds
+     * @param state Input mask built from EInputBit
+     */
+    void Record(float dt, unsigned short state);
+
+    /**
+     * @brief Fills in the header and closes the file
+     *
+     */
+    void Close();
+
+    bool IsOpen() const;
+    unsigned GetFrameCount() const;
+    float GetDuration() const;
+
+private:
+    std::ofstream mOutput;
+    unsigned mFrameCount;
+    float mDuration;
+};
+
+class InputPlayer {
+public:
+    InputPlayer();
+
+    /**
+     * @brief Loads the whole recording
+     *
+     * @param filename Recording path
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * @brief Steps to the next recorded frame
+     *
+     * @param dt Receives the delta the frame was simulated with
+     * @param state Receives the input mask built from EInputBit
+     *
+     * @returns true - Frame read, false - Recording finished, dt and state are left alone
+     */
+    bool Advance(float& dt, unsigned short& state);
+
+    float GetDuration() const;
+    unsigned GetFrameCount() const;
+
+private:
+    std::vector<InputFrame> mFrames;
+    unsigned mNext;
+    float mDuration;
+};
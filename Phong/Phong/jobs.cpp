@@ -0,0 +1,340 @@
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include <iostream>
+#include <cstdio>
+
+// NOTE: Index of the job thread running on this OS thread, EXTERNAL_THREAD for threads the system doesn't own
+static const unsigned EXTERNAL_THREAD = 0xFFFFFFFF;
+static thread_local unsigned tThreadIndex = EXTERNAL_THREAD;
+static thread_local unsigned tStealSeed = 0x9E3779B9;
+
+JobDeque::JobDeque() : mTop(0), mBottom(0) {
+    for (long long JobIdx = 0; JobIdx < CAPACITY; ++JobIdx) {
+        mJobs[JobIdx].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool
+JobDeque::Push(Job* job) {
+    long long Bottom = mBottom.load(std::memory_order_relaxed);
+    long long Top = mTop.load(std::memory_order_acquire);
+    if (Bottom - Top >= CAPACITY) {
+        return false;
+    }
+
+    mJobs[Bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(Bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+Job*
+JobDeque::Pop() {
+    long long Bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(Bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long Top = mTop.load(std::memory_order_relaxed);
+
+    if (Top > Bottom) {
+        mBottom.store(Bottom + 1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    Job* Result = mJobs[Bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (Top == Bottom) {
+        // NOTE: Last job, race the stealers for it
+        if (!mTop.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            Result = 0;
+        }
+        mBottom.store(Bottom + 1, std::memory_order_relaxed);
+    }
+    return Result;
+}
+
+Job*
+JobDeque::Steal() {
+    long long Top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long Bottom = mBottom.load(std::memory_order_acquire);
+    if (Top >= Bottom) {
+        return 0;
+    }
+
+    Job* Result = mJobs[Top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!mTop.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return 0;
+    }
+    return Result;
+}
+
+JobSystem::JobSystem() : mRunning(false), mSleeping(0) {
+    for (unsigned ThreadIdx = 0; ThreadIdx < MAX_THREADS; ++ThreadIdx) {
+        mDeques[ThreadIdx] = 0;
+        mPools[ThreadIdx] = 0;
+        mPoolHeads[ThreadIdx] = 0;
+    }
+    mThreadCount = 0;
+    mExternalPool = 0;
+    mExternalPoolHead = 0;
+    mSharedCount = 0;
+}
+
+JobSystem::~JobSystem() {
+    Shutdown();
+}
+
+bool
+JobSystem::Init(unsigned threadCount) {
+    Shutdown();
+    if (!threadCount) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    mThreadCount = threadCount < 1 ? 1 : threadCount > MAX_THREADS ? MAX_THREADS : threadCount;
+
+    for (unsigned ThreadIdx = 0; ThreadIdx < mThreadCount; ++ThreadIdx) {
+        mDeques[ThreadIdx] = new JobDeque();
+        mPools[ThreadIdx] = new Job[JOB_POOL_SIZE];
+        mPoolHeads[ThreadIdx] = 0;
+    }
+    mExternalPool = new Job[JOB_POOL_SIZE];
+    mExternalPoolHead = 0;
+
+    tThreadIndex = 0;
+    mRunning = true;
+    for (unsigned ThreadIdx = 1; ThreadIdx < mThreadCount; ++ThreadIdx) {
+        mWorkers.push_back(std::thread(&JobSystem::workerLoop, this, ThreadIdx));
+    }
+    return true;
+}
+
+void
+JobSystem::Shutdown() {
+    if (!mThreadCount) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mSleepMutex);
+        mRunning = false;
+        mWakeUp.notify_all();
+    }
+    for (unsigned WorkerIdx = 0; WorkerIdx < mWorkers.size(); ++WorkerIdx) {
+        mWorkers[WorkerIdx].join();
+    }
+    mWorkers.clear();
+    drainJobs();
+
+    for (unsigned ThreadIdx = 0; ThreadIdx < mThreadCount; ++ThreadIdx) {
+        delete mDeques[ThreadIdx];
+        delete[] mPools[ThreadIdx];
+        mDeques[ThreadIdx] = 0;
+        mPools[ThreadIdx] = 0;
+    }
+    delete[] mExternalPool;
+    mExternalPool = 0;
+    mSharedQueue.clear();
+    mSharedCount = 0;
+    mThreadCount = 0;
+    tThreadIndex = EXTERNAL_THREAD;
+}
+
+void
+JobSystem::Run(JobFunction function, const void* data, unsigned size, JobCounter* counter) {
+    unsigned Index = threadIndex();
+    if (Index == EXTERNAL_THREAD) {
+        std::lock_guard<std::mutex> Lock(mSharedMutex);
+        Job* NewJob = allocateJob(mExternalPool, mExternalPoolHead, function, data, size, counter);
+        mSharedQueue.push_back(NewJob);
+        ++mSharedCount;
+    } else {
+        Job* NewJob = allocateJob(mPools[Index], mPoolHeads[Index], function, data, size, counter);
+        if (!mDeques[Index]->Push(NewJob)) {
+            // NOTE: Deque is full, running inline keeps progress without growing anything
+            execute(NewJob);
+            return;
+        }
+    }
+    wakeWorkers();
+}
+
+void
+JobSystem::RunBackground(JobFunction function, const void* data, unsigned size, JobCounter* counter) {
+    Job NewJob;
+    unsigned Head = 0;
+    // NOTE: The job is its own one slot pool, allocateJob only fills it in and bumps the counter
+    allocateJob(&NewJob, Head, function, data, size, counter);
+    {
+        std::lock_guard<std::mutex> Lock(mBackgroundMutex);
+        mBackgroundQueue.push_back(NewJob);
+    }
+    wakeWorkers();
+}
+
+void
+JobSystem::Wait(JobCounter* counter) {
+    unsigned Index = threadIndex();
+    while (counter->mValue.load(std::memory_order_acquire) > 0) {
+        Job* Next = findJob(Index);
+        if (Next) {
+            execute(Next);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+unsigned
+JobSystem::GetThreadCount() const {
+    return mThreadCount;
+}
+
+void
+JobSystem::workerLoop(unsigned index) {
+    tThreadIndex = index;
+    tStealSeed ^= index * 0x85EBCA6B;
+    char ThreadName[ProfileThreadBuffer::NAME_SIZE];
+    snprintf(ThreadName, sizeof(ThreadName), "Job worker %u", index);
+    Profiler::SetThreadName(ThreadName);
+    unsigned IdleSpins = 0;
+    for (;;) {
+        Job* Next = findJob(index);
+        if (Next) {
+            execute(Next);
+            IdleSpins = 0;
+            continue;
+        }
+
+        Job Background;
+        if (popBackgroundJob(Background)) {
+            execute(&Background);
+            IdleSpins = 0;
+            continue;
+        }
+
+        // NOTE: Shutdown only stops workers that found nothing left to run, background jobs included
+        if (!mRunning.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        // NOTE: Spin briefly since jobs tend to arrive in bursts, then sleep until woken
+        if (++IdleSpins < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> Lock(mSleepMutex);
+        ++mSleeping;
+        mWakeUp.wait_for(Lock, std::chrono::milliseconds(1));
+        --mSleeping;
+        IdleSpins = 0;
+    }
+}
+
+Job*
+JobSystem::allocateJob(Job* pool, unsigned& head, JobFunction function, const void* data, unsigned size, JobCounter* counter) {
+    // NOTE: The pool is a ring, a thread may have at most JOB_POOL_SIZE unfinished jobs submitted
+    Job* NewJob = &pool[head++ & (JOB_POOL_SIZE - 1)];
+    NewJob->mFunction = function;
+    NewJob->mCounter = counter;
+    if (size > Job::PAYLOAD_SIZE) {
+        std::cerr << "[Err] Job payload of " << size << " bytes truncated to " << Job::PAYLOAD_SIZE << std::endl;
+        size = Job::PAYLOAD_SIZE;
+    }
+    if (size) {
+        memcpy(NewJob->mPayload, data, size);
+    }
+    if (counter) {
+        counter->mValue.fetch_add(1, std::memory_order_relaxed);
+    }
+    return NewJob;
+}
+
+Job*
+JobSystem::findJob(unsigned index) {
+    Job* Result = 0;
+    if (index != EXTERNAL_THREAD) {
+        Result = mDeques[index]->Pop();
+        if (Result) {
+            return Result;
+        }
+    }
+
+    if (mSharedCount.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> Lock(mSharedMutex);
+        if (!mSharedQueue.empty()) {
+            Result = mSharedQueue.back();
+            mSharedQueue.pop_back();
+            --mSharedCount;
+            return Result;
+        }
+    }
+
+    // NOTE: xorshift picks a random first victim so stealers don't all hammer the same deque
+    tStealSeed ^= tStealSeed << 13;
+    tStealSeed ^= tStealSeed >> 17;
+    tStealSeed ^= tStealSeed << 5;
+    for (unsigned Attempt = 0; Attempt < mThreadCount; ++Attempt) {
+        unsigned Victim = (tStealSeed + Attempt) % mThreadCount;
+        if (Victim == index) {
+            continue;
+        }
+
+        Result = mDeques[Victim]->Steal();
+        if (Result) {
+            return Result;
+        }
+    }
+    return 0;
+}
+
+void
+JobSystem::drainJobs() {
+    // NOTE: Jobs may submit more jobs, so this loops until every queue comes up empty
+    unsigned Index = threadIndex();
+    for (;;) {
+        Job* Next = findJob(Index);
+        if (Next) {
+            execute(Next);
+            continue;
+        }
+
+        // NOTE: Owners of background jobs wait for them to start, a dropped one would block them forever
+        Job Background;
+        if (!popBackgroundJob(Background)) {
+            return;
+        }
+        execute(&Background);
+    }
+}
+
+bool
+JobSystem::popBackgroundJob(Job& job) {
+    std::lock_guard<std::mutex> Lock(mBackgroundMutex);
+    if (mBackgroundQueue.empty()) {
+        return false;
+    }
+
+    job = mBackgroundQueue.front();
+    mBackgroundQueue.pop_front();
+    return true;
+}
+
+void
+JobSystem::execute(Job* job) {
+    job->mFunction(job->mPayload);
+    if (job->mCounter) {
+        job->mCounter->mValue.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void
+JobSystem::wakeWorkers() {
+    if (mSleeping.load(std::memory_order_relaxed)) {
+        mWakeUp.notify_one();
+    }
+}
+
+unsigned
+JobSystem::threadIndex() const {
+    return tThreadIndex < mThreadCount ? tThreadIndex : EXTERNAL_THREAD;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file jobs.hpp
+ * @brief Work-stealing job system with per-thread Chase-Lev deques
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <deque>
+#include <cstring>
+
+/**
+ * @brief Counts unfinished jobs. Incremented on submit, decremented when a job returns.
+ * Waiting on a counter is how dependencies between jobs are expressed
+ */
+struct JobCounter {
+    std::atomic<int> mValue;
+    JobCounter() : mValue(0) {}
+};
+
+typedef void (*JobFunction)(void* data);
+
+struct Job {
+    static const unsigned PAYLOAD_SIZE = 48;
+
+    JobFunction mFunction;
+    JobCounter* mCounter;
+    // NOTE: Arguments are copied in so submitting never allocates
+    unsigned char mPayload[PAYLOAD_SIZE];
+};
+
+/**
+ * @brief Fixed capacity Chase-Lev deque. The owning thread pushes and pops at the bottom,
+ * any other thread steals from the top
+ */
+class JobDeque {
+public:
+    static const long long CAPACITY = 4096;
+
+    JobDeque();
+    bool Push(Job* job);
+    Job* Pop();
+    Job* Steal();
+
+private:
+    std::atomic<long long> mTop;
+    std::atomic<long long> mBottom;
+    std::atomic<Job*> mJobs[CAPACITY];
+};
+
+class JobSystem {
+public:
+    static const unsigned MAX_THREADS = 64;
+    static const unsigned JOB_POOL_SIZE = 4096;
+
+    JobSystem();
+    ~JobSystem();
+
+    /**
+     * @brief Starts worker threads. The calling thread becomes the main thread and takes part
+     * in running jobs while it waits
+     *
+     * @param threadCount Total threads including the main one, 0 picks the hardware concurrency
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(unsigned threadCount);
+
+    /**
+     * @brief Finishes outstanding jobs and joins all workers. Workers run the queues dry before
+     * they leave, whatever is submitted meanwhile runs on the calling thread
+     *
+     */
+    void Shutdown();
+
+    /**
+     * @brief Submits a job to the calling thread's deque, idle workers steal it from there
+     *
+     * @param function Job entry point, receives a pointer to the copied payload
+     * @param data Payload copied into the job, at most Job::PAYLOAD_SIZE bytes
+     * @param size Payload size in bytes
+     * @param counter Optional counter incremented now and decremented when the job finishes
+     */
+    void Run(JobFunction function, const void* data, unsigned size, JobCounter* counter);
+
+    /**
+     * @brief Submits a long running job that only idle worker threads pick up. Threads waiting on a
+     * counter never run it, so frame work can't get stuck behind it. Needs at least one worker.
+     * Shutdown still runs it when no worker got to it
+     *
+     * @param function Job entry point
+     * @param data Payload copied into the job
+     * @param size Payload size in bytes
+     * @param counter Optional completion counter
+     */
+    void RunBackground(JobFunction function, const void* data, unsigned size, JobCounter* counter);
+
+    /**
+     * @brief Runs other jobs until the counter reaches zero
+     *
+     * @param counter Counter to wait on
+     */
+    void Wait(JobCounter* counter);
+
+    /**
+     * @brief Calls func(begin, end) over [0, count) split into ranges of at most grain elements.
+     * Ranges are split recursively so idle threads steal the large halves first. Blocks until done
+     *
+     * @param count Number of elements
+     * @param grain Largest range run by a single job
+     * @param func Callable taking (unsigned begin, unsigned end)
+     */
+    template<typename Function>
+    void ParallelFor(unsigned count, unsigned grain, const Function& func);
+
+    unsigned GetThreadCount() const;
+
+private:
+    template<typename Function>
+    struct ParallelForRange {
+        JobSystem* mSystem;
+        const Function* mFunction;
+        JobCounter* mCounter;
+        unsigned mBegin;
+        unsigned mEnd;
+        unsigned mGrain;
+    };
+
+    JobDeque* mDeques[MAX_THREADS];
+    Job* mPools[MAX_THREADS];
+    unsigned mPoolHeads[MAX_THREADS];
+    std::vector<std::thread> mWorkers;
+    unsigned mThreadCount;
+    std::atomic<bool> mRunning;
+    std::atomic<unsigned> mSleeping;
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeUp;
+    // NOTE: Threads the system doesn't own have no deque and submit through a locked queue instead
+    Job* mExternalPool;
+    unsigned mExternalPoolHead;
+    std::mutex mSharedMutex;
+    std::vector<Job*> mSharedQueue;
+    std::atomic<unsigned> mSharedCount;
+    // NOTE: Held by value, a job that runs for many frames would outlive its slot in a pool ring
+    std::mutex mBackgroundMutex;
+    std::deque<Job> mBackgroundQueue;
+
+    void workerLoop(unsigned index);
+    Job* allocateJob(Job* pool, unsigned& head, JobFunction function, const void* data, unsigned size, JobCounter* counter);
+    Job* findJob(unsigned index);
+    bool popBackgroundJob(Job& job);
+    void drainJobs();
+    void execute(Job* job);
+    void wakeWorkers();
+    unsigned threadIndex() const;
+
+    template<typename Function>
+    static void parallelForJob(void* data);
+};
+
+template<typename Function>
+void
+JobSystem::ParallelFor(unsigned count, unsigned grain, const Function& func) {
+    if (!count) {
+        return;
+    }
+
+    JobCounter Counter;
+    ParallelForRange<Function> Range = { this, &func, &Counter, 0, count, grain ? grain : 1 };
+    static_assert(sizeof(Range) <= Job::PAYLOAD_SIZE, "ParallelFor range does not fit a job payload");
+    parallelForJob<Function>(&Range);
+    Wait(&Counter);
+}
+
+template<typename Function>
+void
+JobSystem::parallelForJob(void* data) {
+    ParallelForRange<Function> Range;
+    memcpy(&Range, data, sizeof(Range));
+    // NOTE: Give away the upper half until the remaining range is small enough to run here
+    while (Range.mEnd - Range.mBegin > Range.mGrain) {
+        unsigned Middle = Range.mBegin + (Range.mEnd - Range.mBegin) / 2;
+        ParallelForRange<Function> Upper = Range;
+        Upper.mBegin = Middle;
+        Range.mSystem->Run(parallelForJob<Function>, &Upper, sizeof(Upper), Range.mCounter);
+        Range.mEnd = Middle;
+    }
+    (*Range.mFunction)(Range.mBegin, Range.mEnd);
+}
@@ -0,0 +1,95 @@
+#include "linear_arena.hpp"
+#include <iostream>
+#include <new>
+#include <cstdint>
+#include <utility>
+
+LinearArena::LinearArena() {
+    mMemory = 0;
+    mCapacity = 0;
+    mUsed = 0;
+}
+
+LinearArena::~LinearArena() {
+    Release();
+}
+
+LinearArena::LinearArena(LinearArena&& other) {
+    mMemory = 0;
+    mCapacity = 0;
+    mUsed = 0;
+    *this = std::move(other);
+}
+
+LinearArena&
+LinearArena::operator=(LinearArena&& other) {
+    if (this != &other) {
+        Release();
+        mMemory = other.mMemory;
+        mCapacity = other.mCapacity;
+        mUsed = other.mUsed.load();
+        other.mMemory = 0;
+        other.mCapacity = 0;
+        other.mUsed = 0;
+    }
+    return *this;
+}
+
+bool
+LinearArena::Init(unsigned capacity) {
+    Release();
+    // NOTE: operator new only guarantees the default alignment, the slack lets the first range be aligned too
+    mMemory = new (std::nothrow) unsigned char[capacity + DEFAULT_ALIGNMENT];
+    if (!mMemory) {
+        std::cerr << "[Err] Failed to allocate a " << capacity << " byte arena" << std::endl;
+        return false;
+    }
+
+    mCapacity = capacity + DEFAULT_ALIGNMENT;
+    mUsed = 0;
+    return true;
+}
+
+void
+LinearArena::Release() {
+    delete[] mMemory;
+    mMemory = 0;
+    mCapacity = 0;
+    mUsed = 0;
+}
+
+void*
+LinearArena::Allocate(unsigned size, unsigned alignment) {
+    uintptr_t Base = (uintptr_t)mMemory;
+    unsigned Used = mUsed.load(std::memory_order_relaxed);
+    uintptr_t Start = 0;
+    // NOTE: Bumped with a CAS so import jobs can carve their ranges out of a shared arena
+    do {
+        Start = (Base + Used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (!mMemory || Start + size > Base + mCapacity) {
+            std::cerr << "[Err] Arena out of space, " << size << " bytes requested with " << mCapacity - Used << " left" << std::endl;
+            return 0;
+        }
+    } while (!mUsed.compare_exchange_weak(Used, (unsigned)(Start + size - Base), std::memory_order_relaxed));
+    return (void*)Start;
+}
+
+void
+LinearArena::Reset() {
+    mUsed = 0;
+}
+
+unsigned
+LinearArena::GetUsed() const {
+    return mUsed;
+}
+
+unsigned
+LinearArena::GetCapacity() const {
+    return mCapacity;
+}
+
+unsigned
+LinearArena::AlignedSize(unsigned size, unsigned alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
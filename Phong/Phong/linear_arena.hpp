@@ -0,0 +1,86 @@
+/**
+ * @file linear_arena.hpp
+ * @brief Fixed capacity bump allocator for short lived staging data
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <atomic>
+
+/**
+ * @brief One heap block handed out front to back. Individual allocations are never freed,
+ * the whole arena is reset or released in one step once its data has been consumed.
+ * Allocate may be called from several threads at once, Init, Reset and Release may not
+ */
+class LinearArena {
+public:
+    static const unsigned DEFAULT_ALIGNMENT = 16;
+
+    LinearArena();
+    ~LinearArena();
+    // NOTE: Owns the block, moving hands it over, copies would free it twice
+    LinearArena(LinearArena&& other);
+    LinearArena& operator=(LinearArena&& other);
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    /**
+     * @brief Allocates the backing block, releasing any previous one
+     *
+     * @param capacity Size in bytes. Every later Allocate has to fit in it
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(unsigned capacity);
+
+    /**
+     * @brief Frees the backing block
+     *
+     */
+    void Release();
+
+    /**
+     * @brief Hands out the next aligned range of the block
+     *
+     * @param size Size in bytes
+     * @param alignment Power of two alignment of the returned pointer
+     *
+     * @returns Pointer into the block, 0 when the arena is out of space
+     */
+    void* Allocate(unsigned size, unsigned alignment = DEFAULT_ALIGNMENT);
+
+    template<typename T>
+    T* AllocateArray(unsigned count);
+
+    /**
+     * @brief Makes the whole block available again without freeing it
+     *
+     */
+    void Reset();
+
+    unsigned GetUsed() const;
+    unsigned GetCapacity() const;
+
+    /**
+     * @brief Bytes a range takes in the arena including the worst case alignment padding,
+     * for sizing the arena up front
+     *
+     */
+    static unsigned AlignedSize(unsigned size, unsigned alignment = DEFAULT_ALIGNMENT);
+
+private:
+    unsigned char* mMemory;
+    unsigned mCapacity;
+    std::atomic<unsigned> mUsed;
+};
+
+template<typename T>
+T*
+LinearArena::AllocateArray(unsigned count) {
+    unsigned Alignment = alignof(T) > DEFAULT_ALIGNMENT ? alignof(T) : DEFAULT_ALIGNMENT;
+    return (T*)Allocate(count * sizeof(T), Alignment);
+}
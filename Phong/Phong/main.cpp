@@ -1,15 +1,28 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
-#include <vector>
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 #include <chrono>
 #include <thread>
-#include "shader.hpp"
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
 #include "camera.hpp"
-#include "model.hpp"
-#include "texture.hpp"
+#include "scene.hpp"
+#include "frame_pacer.hpp"
+#include "frame_snapshot.hpp"
+#include "benchmarks.hpp"
+#include "offscreen.hpp"
+#include "camera_path.hpp"
+#include "frame_report.hpp"
+#include "input_record.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "hud.hpp"
+#include "memory_tracker.hpp"
+#include "alloc_tracker.hpp"
+#include "gl_handle.hpp"
 
 float
 Clamp(float x, float min, float max) {
@@ -19,7 +32,41 @@ Clamp(float x, float min, float max) {
 int WindowWidth = 1200;
 int WindowHeight = 1200;
 const float TargetFPS = 60.0f;
-const std::string WindowTitle = "Phong";
+const char* const WindowTitle = "Phong";
+// NOTE: How often the window title timing readout is refreshed, in seconds
+const float TitleUpdateInterval = 0.5f;
+// NOTE: Frames --strict-alloc lets allocate before any allocation of the render thread inside a frame aborts
+const unsigned DefaultAllocationWarmupFrames = 60;
+
+struct LaunchOptions {
+    unsigned mFramesInFlight;
+    bool mSingleThread;
+    bool mBenchmarkJobs;
+    unsigned mBenchmarkThreads;
+    bool mBenchmarkCommands;
+    unsigned mBenchmarkDraws;
+    bool mHeadless;
+    int mHeadlessWidth;
+    int mHeadlessHeight;
+    unsigned mFrameCount;
+    const char* mOutputPath;
+    const char* mBenchmarkPath;
+    const char* mReportPrefix;
+    const char* mRecordPath;
+    const char* mReplayPath;
+    const char* mProfilePath;
+    bool mBenchmarkProfiler;
+    bool mBenchmarkImport;
+    const char* mBenchmarkModelPath;
+    bool mBenchmarkIndices;
+    const char* mStatsPath;
+    const char* mMemoryReportPath;
+    bool mStrictAllocations;
+    unsigned mAllocationWarmupFrames;
+    ETextureQuality mTextureQuality;
+    // NOTE: Megabytes of GPU memory streamed textures may take
+    unsigned mTextureBudgetMB;
+};
 
 static float fenjer = 0;
 
@@ -39,7 +86,31 @@ struct EngineState {
     Camera* mCamera;
     unsigned mShadingMode;
     bool mDrawDebugLines;
+    // NOTE: View only, deliberately kept out of input recordings
+    bool mShowHud;
+    // NOTE: View only as well, cycled at runtime to trade texture bandwidth for quality
+    unsigned mTextureQuality;
     float mDT;
+    float mAngle;
+    glm::vec3 mCubeOffset;
+};
+
+// NOTE: Written by whichever thread renders, read by the simulation for the window title
+struct RenderStats {
+    std::atomic<float> mCPUTime;
+    std::atomic<float> mGPUTime;
+    std::atomic<unsigned> mQueueDepth;
+    std::atomic<unsigned> mFramesRendered;
+    std::atomic<unsigned> mDrawCalls;
+};
+
+struct RenderThreadContext {
+    GLFWwindow* mWindow;
+    Scene* mScene;
+    FramePacer* mPacer;
+    SnapshotBuffer* mSnapshots;
+    RenderStats* mStats;
+    Hud* mHud;
 };
 
 static void
@@ -71,15 +142,33 @@ KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode) {
         }
     } break;
 
+    case GLFW_KEY_H: {
+        if (action == GLFW_PRESS) {
+            State->mShowHud ^= true;
+        }
+    } break;
+
+    case GLFW_KEY_T: {
+        if (action == GLFW_PRESS) {
+            State->mTextureQuality = (State->mTextureQuality + 1) % TEXTURE_QUALITY_COUNT;
+        }
+    } break;
+
+    case GLFW_KEY_M: {
+        if (action == GLFW_PRESS) {
+            MemoryTracker::Report(std::cout, 10);
+        }
+    } break;
+
     case GLFW_KEY_ESCAPE: glfwSetWindowShouldClose(window, GLFW_TRUE); break;
     }
 }
 
 static void
 FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    // NOTE: The viewport is set by the renderer from the snapshot, this may not be the context thread
     WindowWidth = width;
     WindowHeight = height;
-    glViewport(0, 0, width, height);
 }
 
 static void
@@ -98,48 +187,469 @@ HandleInput(EngineState* state) {
 }
 
 static void
-DrawFloor(unsigned vao, const Shader& shader, unsigned diffuse, unsigned specular) {
-    glUseProgram(shader.GetId());
-    glBindVertexArray(vao);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, diffuse);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, specular);
-    float Size = 4.0f;
-    for (int i = -2; i < 4; ++i) {
-        for (int j = -2; j < 4; ++j) {
-            glm::mat4 Model(1.0f);
-            Model = glm::translate(Model, glm::vec3(i * Size, -2.0f, j * Size));
-            Model = glm::scale(Model, glm::vec3(Size, 0.1f, Size));
-            shader.SetModel(Model);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+MoveCube(unsigned short inputState, float& x, float& y, float& z) {
+    if (inputState & INPUT_CUBE_UP) {
+        if (y < 0) {
+            y += 0.05;
         }
     }
+    if (inputState & INPUT_CUBE_DOWN) {
+        if (y > -2.0) {
+            y -= 0.05;
+        }
+    }
+}
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+/**
+ * @brief Packs everything the simulation reads from the user into an input mask
+ *
+ */
+static unsigned short
+PollInputState(EngineState* state, GLFWwindow* window) {
+    Input* UserInput = state->mInput;
+    unsigned short InputState = 0;
+    InputState |= UserInput->MoveLeft ? INPUT_MOVE_LEFT : 0;
+    InputState |= UserInput->MoveRight ? INPUT_MOVE_RIGHT : 0;
+    InputState |= UserInput->MoveUp ? INPUT_MOVE_UP : 0;
+    InputState |= UserInput->MoveDown ? INPUT_MOVE_DOWN : 0;
+    InputState |= UserInput->LookLeft ? INPUT_LOOK_LEFT : 0;
+    InputState |= UserInput->LookRight ? INPUT_LOOK_RIGHT : 0;
+    InputState |= UserInput->LookUp ? INPUT_LOOK_UP : 0;
+    InputState |= UserInput->LookDown ? INPUT_LOOK_DOWN : 0;
+    InputState |= glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS ? INPUT_CUBE_UP : 0;
+    InputState |= glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS ? INPUT_CUBE_DOWN : 0;
+    InputState |= fenjer ? INPUT_FENJER : 0;
+    InputState |= state->mDrawDebugLines ? INPUT_DEBUG_LINES : 0;
+    return InputState;
 }
 
+/**
+ * @brief Overwrites the live input with a mask, so replayed sessions drive the same code paths
+ *
+ */
+static void
+ApplyInputState(EngineState* state, unsigned short inputState) {
+    Input* UserInput = state->mInput;
+    UserInput->MoveLeft = (inputState & INPUT_MOVE_LEFT) != 0;
+    UserInput->MoveRight = (inputState & INPUT_MOVE_RIGHT) != 0;
+    UserInput->MoveUp = (inputState & INPUT_MOVE_UP) != 0;
+    UserInput->MoveDown = (inputState & INPUT_MOVE_DOWN) != 0;
+    UserInput->LookLeft = (inputState & INPUT_LOOK_LEFT) != 0;
+    UserInput->LookRight = (inputState & INPUT_LOOK_RIGHT) != 0;
+    UserInput->LookUp = (inputState & INPUT_LOOK_UP) != 0;
+    UserInput->LookDown = (inputState & INPUT_LOOK_DOWN) != 0;
+    fenjer = (inputState & INPUT_FENJER) ? 1.0f : 0.0f;
+    state->mDrawDebugLines = (inputState & INPUT_DEBUG_LINES) != 0;
+}
 
-float GetRadians(float angle) {
-    return 3.14 * angle / 180;
+static void
+Simulate(EngineState* state, unsigned short inputState) {
+    PROFILE_FUNCTION();
+    ApplyInputState(state, inputState);
+    HandleInput(state);
+    MoveCube(inputState, state->mCubeOffset.x, state->mCubeOffset.y, state->mCubeOffset.z);
+    state->mAngle += state->mDT;
 }
 
 static void
-MoveCube(GLFWwindow* context, float& x, float& y, float& z) {
-    if (glfwGetKey(context, GLFW_KEY_1) == GLFW_PRESS) {
-        if (y < 0) {
-            y += 0.05;
+WriteSnapshot(EngineState* state, unsigned frameIndex, FrameSnapshot& snapshot) {
+    Camera* FPSCamera = state->mCamera;
+    snapshot.mFrameIndex = frameIndex;
+    snapshot.mFramebufferWidth = WindowWidth;
+    snapshot.mFramebufferHeight = WindowHeight;
+    snapshot.mCameraPosition = FPSCamera->GetPosition();
+    snapshot.mCameraTarget = FPSCamera->GetTarget();
+    snapshot.mCameraUp = FPSCamera->GetUp();
+    snapshot.mCubeOffset = state->mCubeOffset.y;
+    snapshot.mFenjer = fenjer;
+    snapshot.mLightAngle = state->mAngle;
+    snapshot.mDrawDebugLines = state->mDrawDebugLines;
+    snapshot.mShowHud = state->mShowHud;
+    snapshot.mTextureQuality = state->mTextureQuality;
+    snapshot.mDT = state->mDT;
+}
+
+static void
+RenderFrame(GLFWwindow* window, Scene& scene, FramePacer& pacer, RenderStats& stats, Hud* hud, const FrameSnapshot& snapshot) {
+    PROFILE_FUNCTION();
+    FrameStats::BeginFrame();
+    AllocationTracker::BeginFrame();
+    pacer.BeginFrame();
+    scene.Render(snapshot);
+    if (hud) {
+        // NOTE: The overlay is part of the frame it reports on, so its own cost shows up in the numbers
+        hud->Update();
+        if (snapshot.mShowHud) {
+            hud->Render(pacer.GetLastTiming(), FrameStats::GetLastFrame(), pacer.GetFramesInFlight(),
+                snapshot.mFramebufferWidth, snapshot.mFramebufferHeight);
         }
     }
-    if (glfwGetKey(context, GLFW_KEY_2) == GLFW_PRESS) {
-        if (y > -2.0) {
-            y -= 0.05;
+    pacer.EndFrame();
+    AllocationTracker::EndFrame();
+    FrameStats::EndFrame();
+    // NOTE: Headless runs render into an FBO and have nothing to present
+    if (window) {
+        PROFILE_ZONE("SwapBuffers");
+        glfwSwapBuffers(window);
+    }
+
+    const FrameTiming& Timing = pacer.GetLastTiming();
+    stats.mCPUTime = (float)Timing.mCPUTime;
+    stats.mGPUTime = (float)Timing.mGPUTime;
+    stats.mQueueDepth = Timing.mQueueDepth;
+    stats.mDrawCalls = (unsigned)FrameStats::GetLastFrame().mDrawCalls;
+    ++stats.mFramesRendered;
+}
+
+/**
+ * @brief Render thread entry. Owns the GL context for its whole lifetime and draws
+ * the newest snapshot the simulation has published
+ *
+ */
+static void
+RenderThread(RenderThreadContext* context) {
+    Profiler::SetThreadName("Render");
+    glfwMakeContextCurrent(context->mWindow);
+    while (!context->mSnapshots->IsClosed()) {
+        const FrameSnapshot* Snapshot = 0;
+        if (context->mSnapshots->Acquire(0.1, Snapshot)) {
+            RenderFrame(context->mWindow, *context->mScene, *context->mPacer, *context->mStats, context->mHud, *Snapshot);
+        }
+    }
+
+    // NOTE: GL objects have to be released on the thread the context is current on
+    if (context->mHud) {
+        context->mHud->Destroy();
+    }
+    context->mScene->Destroy();
+    context->mPacer->Destroy();
+    glfwMakeContextCurrent(0);
+}
+
+static void
+ParseArguments(int argc, char** argv, LaunchOptions& options) {
+    for (int ArgIdx = 1; ArgIdx < argc; ++ArgIdx) {
+        const char* Arg = argv[ArgIdx];
+        bool HasValue = ArgIdx + 1 < argc;
+        if (!strcmp(Arg, "--frames-in-flight") && HasValue) {
+            options.mFramesInFlight = atoi(argv[++ArgIdx]);
+        } else if (!strcmp(Arg, "--single-thread")) {
+            options.mSingleThread = true;
+        } else if (!strcmp(Arg, "--bench-jobs")) {
+            options.mBenchmarkJobs = true;
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                options.mBenchmarkThreads = atoi(argv[++ArgIdx]);
+            }
+        } else if (!strcmp(Arg, "--bench-commands")) {
+            options.mBenchmarkCommands = true;
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                options.mBenchmarkDraws = atoi(argv[++ArgIdx]);
+            }
+        } else if (!strcmp(Arg, "--headless")) {
+            options.mHeadless = true;
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                int Width = 0;
+                int Height = 0;
+                if (sscanf(argv[++ArgIdx], "%dx%d", &Width, &Height) == 2 && Width > 0 && Height > 0) {
+                    options.mHeadlessWidth = Width;
+                    options.mHeadlessHeight = Height;
+                } else {
+                    std::cerr << "Invalid resolution " << argv[ArgIdx] << ", expected WIDTHxHEIGHT" << std::endl;
+                }
+            }
+        } else if (!strcmp(Arg, "--frames") && HasValue) {
+            options.mFrameCount = atoi(argv[++ArgIdx]);
+        } else if (!strcmp(Arg, "--output") && HasValue) {
+            options.mOutputPath = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--benchmark")) {
+            // NOTE: Benchmarks always run headless, uncapped and with a fixed time step
+            options.mHeadless = true;
+            options.mBenchmarkPath = "res/flythrough.path";
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                options.mBenchmarkPath = argv[++ArgIdx];
+            }
+        } else if (!strcmp(Arg, "--report") && HasValue) {
+            options.mReportPrefix = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--record") && HasValue) {
+            options.mRecordPath = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--replay") && HasValue) {
+            options.mReplayPath = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--profile") && HasValue) {
+            options.mProfilePath = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--bench-profiler")) {
+            options.mBenchmarkProfiler = true;
+        } else if (!strcmp(Arg, "--bench-indices")) {
+            options.mBenchmarkIndices = true;
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                options.mBenchmarkModelPath = argv[++ArgIdx];
+            }
+        } else if (!strcmp(Arg, "--bench-import")) {
+            options.mBenchmarkImport = true;
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                options.mBenchmarkModelPath = argv[++ArgIdx];
+            }
+        } else if (!strcmp(Arg, "--stats") && HasValue) {
+            options.mStatsPath = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--memory-report") && HasValue) {
+            options.mMemoryReportPath = argv[++ArgIdx];
+        } else if (!strcmp(Arg, "--texture-quality") && HasValue) {
+            if (!SamplerCache::ParseQuality(argv[++ArgIdx], options.mTextureQuality)) {
+                std::cerr << "Unknown texture quality: " << argv[ArgIdx] << ", expected low, medium or high" << std::endl;
+            }
+        } else if (!strcmp(Arg, "--texture-budget") && HasValue) {
+            options.mTextureBudgetMB = atoi(argv[++ArgIdx]);
+        } else if (!strcmp(Arg, "--strict-alloc")) {
+            options.mStrictAllocations = true;
+            options.mAllocationWarmupFrames = DefaultAllocationWarmupFrames;
+            if (HasValue && argv[ArgIdx + 1][0] != '-') {
+                options.mAllocationWarmupFrames = atoi(argv[++ArgIdx]);
+            }
+        } else {
+            std::cerr << "Unknown argument: " << Arg << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief Loads GL function pointers, then creates the frame pacer, the job system and the scene.
+ * Shared by the windowed and the headless paths, requires a current GL context
+ *
+ * @returns true - Success, false - Failure
+ */
+static bool
+InitRenderer(const LaunchOptions& options, FramePacer& pacer, JobSystem& jobs, Scene& scene) {
+    GLenum GlewError = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // NOTE: A GLX build of GLEW refuses EGL and OSMesa contexts, the entry points themselves still resolve
+    if (GlewError == GLEW_ERROR_NO_GLX_DISPLAY) {
+        GlewError = glewContextInit();
+    }
+#endif
+    if (GlewError != GLEW_OK) {
+        std::cerr << "Failed to init glew: " << glewGetErrorString(GlewError) << std::endl;
+        return false;
+    }
+
+    if (!pacer.Init(options.mFramesInFlight)) {
+        return false;
+    }
+
+    jobs.Init(0);
+    scene.SetTextureBudget((unsigned long long)options.mTextureBudgetMB * 1024 * 1024);
+    // NOTE: The ring has as many regions as the pacer allows frames in flight, so its own fences never block
+    return scene.Init(pacer.GetFramesInFlight(), &jobs);
+}
+
+static void
+PrintRendererStats(const Scene& scene, const FramePacer& pacer, unsigned simulatedFrames) {
+    const UploadRingStats& RingStats = scene.GetUploadRing().GetTotalStats();
+    unsigned RingFrames = scene.GetUploadRing().GetFrameCount() ? scene.GetUploadRing().GetFrameCount() : 1;
+    std::cout << "Upload ring: " << RingStats.mBytesUploaded / RingFrames << " bytes/frame in "
+        << RingStats.mAllocations / RingFrames << " allocations, " << RingStats.mStallTime * 1000.0 << " ms total stall, "
+        << RingStats.mOverflows << " overflows" << std::endl;
+    FrameTiming AverageTiming = pacer.GetAverageTiming();
+    std::cout << "Frame pacer: " << pacer.GetFrameCount() << " frames rendered for " << simulatedFrames << " simulated, avg CPU "
+        << AverageTiming.mCPUTime * 1000.0 << " ms, avg GPU " << AverageTiming.mGPUTime * 1000.0 << " ms, avg wait "
+        << AverageTiming.mWaitTime * 1000.0 << " ms, avg queue depth " << AverageTiming.mQueueDepth << std::endl;
+    const CommandStats& Commands = scene.GetCommandStats();
+    unsigned CommandFrames = Commands.mFrames ? Commands.mFrames : 1;
+    double CommandCount = Commands.mCommands ? (double)Commands.mCommands : 1.0;
+    std::cout << "Command buffers: " << Commands.mCommands / CommandFrames << " commands/frame, avg record "
+        << Commands.mRecordTime * 1000.0 / CommandFrames << " ms, avg replay " << Commands.mReplayTime * 1000.0 / CommandFrames
+        << " ms, " << Commands.mReplayTime * 1e9 / CommandCount << " ns/command replayed" << std::endl;
+    scene.GetGpuProfiler().Print(std::cout);
+    scene.GetTextureStreamer().Report(std::cout);
+    RenderCounters Average = FrameStats::GetAverage();
+    std::cout << "Render counters: " << Average.mDrawCalls << " draws/frame, " << Average.mTriangles << " triangles/frame, "
+        << Average.mProgramSwitches << " program switches, " << Average.mTextureBinds << " texture binds, "
+        << Average.mVAOBinds << " VAO binds, " << Average.mUniformUploads << " uniform uploads, "
+        << Average.mUploadBytes << " bytes uploaded, " << Average.mUniformLookups << " uniform lookups" << std::endl;
+    unsigned AllocationFrames = AllocationTracker::GetFrameCount() ? AllocationTracker::GetFrameCount() : 1;
+    const FrameAllocationStats& Allocations = AllocationTracker::GetFrameTotal();
+    std::cout << "Heap allocations: " << (double)Allocations.mAllocations / AllocationFrames << " allocations/frame, "
+        << Allocations.mBytes / AllocationFrames << " bytes/frame, " << AllocationTracker::GetAllocatingFrames()
+        << " allocating frames, last frame " << AllocationTracker::GetLastFrame().mAllocations << ", "
+        << AllocationTracker::GetAllocationCount() << " allocations in total" << std::endl;
+}
+
+static void
+WriteExitReports(const LaunchOptions& options) {
+    if (options.mStatsPath && FrameStats::WriteJSON(options.mStatsPath)) {
+        std::cout << "Render counters written to " << options.mStatsPath << std::endl;
+    }
+    MemoryTracker::Report(std::cout, 10);
+    GLObjects::Report(std::cout);
+    if (options.mMemoryReportPath && MemoryTracker::WriteJSON(options.mMemoryReportPath)) {
+        std::cout << "Memory report written to " << options.mMemoryReportPath << std::endl;
+    }
+}
+
+static void
+FinishProfiling(const LaunchOptions& options) {
+    if (!options.mProfilePath) {
+        return;
+    }
+
+    Profiler::SetEnabled(false);
+    Profiler::ExportChromeTrace(options.mProfilePath);
+    Profiler::Shutdown();
+}
+
+/**
+ * @brief Renders a fixed number of frames into a framebuffer object without a visible window,
+ * stepping the simulation with a fixed time step, or the recorded ones when replaying. With a benchmark path the camera follows it
+ * and a frame time report is written at the end
+ *
+ * @returns Process exit code
+ */
+static int
+RunHeadless(const LaunchOptions& options) {
+    OffscreenContext Context;
+    if (!Context.Create()) {
+        return -1;
+    }
+
+    CameraPath Path;
+    bool Scripted = options.mBenchmarkPath != 0;
+    InputPlayer Player;
+    bool Replaying = options.mReplayPath != 0;
+    if ((Scripted && !Path.Load(options.mBenchmarkPath)) || (Replaying && !Player.Open(options.mReplayPath))) {
+        Context.Destroy();
+        return -1;
+    }
+
+    int Result = 0;
+    {
+        FramePacer Pacer;
+        JobSystem Jobs;
+        Scene CampScene;
+        OffscreenTarget Target;
+        if (!InitRenderer(options, Pacer, Jobs, CampScene) || !Target.Init(options.mHeadlessWidth, options.mHeadlessHeight)) {
+            CampScene.Destroy();
+            Pacer.Destroy();
+            Context.Destroy();
+            return -1;
+        }
+        // NOTE: Headless output has to be repeatable, so nothing may still be streaming in on the first frame
+        if (!CampScene.FinishStreaming()) {
+            std::cerr << "[Warn] Scene rendered without models that failed to load" << std::endl;
+        }
+        float DT = 1.0f / TargetFPS;
+        float Duration = Scripted ? Path.GetDuration() : 0.0f;
+        unsigned FrameCount = options.mFrameCount ? options.mFrameCount : Duration > 0.0f ? (unsigned)(Duration / DT) + 1
+            : Replaying ? Player.GetFrameCount() : 300;
+        std::cout << "Headless: " << Context.GetBackendName() << " context, " << glGetString(GL_RENDERER) << ", "
+            << Target.GetWidth() << "x" << Target.GetHeight() << ", " << FrameCount << " frames" << std::endl;
+
+        EngineState State = { 0 };
+        Camera FPSCamera;
+        Input UserInput = { 0 };
+        State.mCamera = &FPSCamera;
+        State.mInput = &UserInput;
+        State.mCubeOffset = glm::vec3(0.0f);
+        State.mTextureQuality = options.mTextureQuality;
+        State.mDT = DT;
+        WindowWidth = Target.GetWidth();
+        WindowHeight = Target.GetHeight();
+
+        std::vector<FrameTiming> History;
+        History.reserve(FrameCount);
+        Pacer.SetHistory(&History);
+
+        RenderStats Stats;
+        Stats.mFramesRendered = 0;
+        Stats.mDrawCalls = 0;
+        FrameSnapshot Snapshot;
+        Target.Bind();
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+        for (unsigned FrameIdx = 0; FrameIdx < FrameCount; ++FrameIdx) {
+            PROFILE_ZONE("Frame");
+            if (Scripted) {
+                // NOTE: Time comes from the frame index, never the clock, so runs are repeatable
+                glm::vec3 Position;
+                glm::vec3 LookTarget;
+                Path.Evaluate(FrameIdx * DT, Position, LookTarget);
+                FPSCamera.LookAt(Position, LookTarget);
+            }
+            // NOTE: Replays step with the recorded deltas, past the end the input is released
+            unsigned short InputState = 0;
+            if (Replaying && !Player.Advance(State.mDT, InputState)) {
+                State.mDT = DT;
+            }
+            Simulate(&State, InputState);
+            WriteSnapshot(&State, FrameIdx, Snapshot);
+            RenderFrame(0, CampScene, Pacer, Stats, 0, Snapshot);
         }
+        Pacer.Drain();
+        double Elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count();
+        Pacer.SetHistory(0);
+        std::cout << "Headless: " << FrameCount << " frames in " << Elapsed * 1000.0 << " ms, "
+            << FrameCount / Elapsed << " FPS" << std::endl;
+
+        if (Scripted) {
+            FrameReport Report(History);
+            Report.Print(std::cout);
+            std::string Prefix = options.mReportPrefix ? options.mReportPrefix : "benchmark";
+            if (!Report.WriteCSV(Prefix + ".csv") || !Report.WriteJSON(Prefix + ".json")) {
+                Result = -1;
+            } else {
+                std::cout << "Benchmark trace written to " << Prefix << ".csv and " << Prefix << ".json" << std::endl;
+            }
+        }
+
+        if (options.mOutputPath && !Target.SaveToPPM(options.mOutputPath)) {
+            Result = -1;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        PrintRendererStats(CampScene, Pacer, FrameCount);
+        Target.Destroy();
+        CampScene.Destroy();
+        Pacer.Destroy();
+        // NOTE: After the scene is gone, so the GL object counts show leaks
+        WriteExitReports(options);
     }
+    Context.Destroy();
+    return Result;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    LaunchOptions Options = { 0 };
+    Options.mFramesInFlight = 2;
+    Options.mHeadlessWidth = WindowWidth;
+    Options.mHeadlessHeight = WindowHeight;
+    Options.mTextureQuality = TEXTURE_QUALITY_MEDIUM;
+    Options.mTextureBudgetMB = TextureStreamer::DEFAULT_BUDGET_MB;
+    ParseArguments(argc, argv, Options);
+    if (Options.mBenchmarkJobs) {
+        Benchmarks::RunJobScaling(Options.mBenchmarkThreads);
+        return 0;
+    }
+    if (Options.mBenchmarkProfiler) {
+        Benchmarks::RunProfilerOverhead();
+        return 0;
+    }
+    if (Options.mBenchmarkImport) {
+        Benchmarks::RunModelImport(Options.mBenchmarkModelPath);
+        return 0;
+    }
+
+    if (Options.mProfilePath) {
+        Profiler::Init();
+        Profiler::SetThreadName("Main");
+    }
+    if (Options.mStrictAllocations) {
+        AllocationTracker::SetStrict(Options.mAllocationWarmupFrames);
+        std::cout << "Strict allocation mode: frames after the first " << Options.mAllocationWarmupFrames
+            << " must not allocate" << std::endl;
+    }
+
+    if (Options.mHeadless) {
+        int Result = RunHeadless(Options);
+        FinishProfiling(Options);
+        return Result;
+    }
+
     GLFWwindow* Window = 0;
     if (!glfwInit()) {
         std::cerr << "Failed to init glfw" << std::endl;
@@ -149,8 +659,11 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (Options.mBenchmarkCommands || Options.mBenchmarkIndices) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
 
-    Window = glfwCreateWindow(WindowWidth, WindowHeight, WindowTitle.c_str(), 0, 0);
+    Window = glfwCreateWindow(WindowWidth, WindowHeight, WindowTitle, 0, 0);
     if (!Window) {
         std::cerr << "Failed to create window" << std::endl;
         glfwTerminate();
@@ -158,11 +671,21 @@ int main() {
     }
     glfwMakeContextCurrent(Window);
 
-    GLenum GlewError = glewInit();
-    if (GlewError != GLEW_OK) {
-        std::cerr << "Failed to init glew: " << glewGetErrorString(GlewError) << std::endl;
+    if (Options.mBenchmarkCommands || Options.mBenchmarkIndices) {
+        GLenum GlewError = glewInit();
+        if (GlewError != GLEW_OK) {
+            std::cerr << "Failed to init glew: " << glewGetErrorString(GlewError) << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        if (Options.mBenchmarkCommands) {
+            Benchmarks::RunCommandReplay(Options.mBenchmarkDraws);
+        } else {
+            Benchmarks::RunIndexEncoding(Options.mBenchmarkModelPath);
+        }
         glfwTerminate();
-        return -1;
+        return 0;
     }
 
     EngineState State = { 0 };
@@ -170,392 +693,116 @@ int main() {
     Input UserInput = { 0 };
     State.mCamera = &FPSCamera;
     State.mInput = &UserInput;
+    State.mCubeOffset = glm::vec3(0.0f);
+    State.mTextureQuality = Options.mTextureQuality;
     glfwSetWindowUserPointer(Window, &State);
 
     glfwSetErrorCallback(ErrorCallback);
     glfwSetFramebufferSizeCallback(Window, FramebufferSizeCallback);
     glfwSetKeyCallback(Window, KeyCallback);
+    glfwGetFramebufferSize(Window, &WindowWidth, &WindowHeight);
 
-    glViewport(0.0f, 0.0f, WindowWidth, WindowHeight);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-
-    unsigned CubeDiffuseTexture = Texture::LoadImageToTexture("res/container_diffuse.png");
-    unsigned CubeSpecularTexture = Texture::LoadImageToTexture("res/container_specular.png");
-    unsigned WaterDiffuseTexture = Texture::LoadImageToTexture("res/water.jpg");
-    unsigned WaterSpecularTexture = Texture::LoadImageToTexture("res/water-diff.jpg");
-    unsigned TentTexture = Texture::LoadImageToTexture("res/tent.png");
-    unsigned FishTexture = Texture::LoadImageToTexture("res/fish.jpg");
-    unsigned FloorDiffuseTexture = Texture::LoadImageToTexture("res/ice.jpg");
-    unsigned FloorSpecularTexture = Texture::LoadImageToTexture("res/ice-diff.jpg");
-
-
-    std::vector<float> CubeVertices = {
-        // X     Y     Z     NX    NY    NZ    U     V    FRONT SIDE
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // L D
-         0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, // R D
-        -0.5f,  0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, // L U
-         0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, // R D
-         0.5f,  0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, // R U
-        -0.5f,  0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, // L U
-                                                        // LEFT SIDE
-        -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, // L D
-        -0.5f, -0.5f,  0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
-        -0.5f,  0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
-        -0.5f, -0.5f,  0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
-        -0.5f,  0.5f,  0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // R U
-        -0.5f,  0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
-                                                        // RIGHT SIDE
-         0.5f, -0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, // L D
-         0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
-         0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
-         0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
-         0.5f,  0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // R U
-         0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
-                                                        // BOTTOM SIDE
-        -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, // L D
-         0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, // R D
-        -0.5f, -0.5f,  0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, // L U
-         0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, // R D
-         0.5f, -0.5f,  0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, // R U
-        -0.5f, -0.5f,  0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, // L U
-                                                        // TOP SIDE
-        -0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, // L D
-         0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // R D
-        -0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // L U
-         0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // R D
-         0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, // R U
-        -0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // L U
-                                                        // BACK SIDE
-         0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, // L D
-        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, // R D
-         0.5f,  0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, // L U
-        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, // R D
-        -0.5f,  0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f, // R U
-         0.5f,  0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, // L U
-    };
-
-    unsigned CubeVAO;
-    glGenVertexArrays(1, &CubeVAO);
-    glBindVertexArray(CubeVAO);
-    unsigned CubeVBO;
-    glGenBuffers(1, &CubeVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, CubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, CubeVertices.size() * sizeof(float), CubeVertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    Model Fox("res/low-poly-fox/low-poly-fox.obj");
-    if (!Fox.Load()) {
-        std::cerr << "Failed to load fox\n";
+    InputRecorder Recorder;
+    InputPlayer Player;
+    if ((Options.mRecordPath && !Recorder.Open(Options.mRecordPath)) || (Options.mReplayPath && !Player.Open(Options.mReplayPath))) {
         glfwTerminate();
         return -1;
-    }                                                         
-   Shader ColorShader("shaders/color.vert", "shaders/color.frag");
-
-    Shader PhongShaderMaterialTexture("shaders/basic.vert", "shaders/phong_material_texture.frag");
-    glUseProgram(PhongShaderMaterialTexture.GetId());
-    //Ambijentalno svetlo
-    PhongShaderMaterialTexture.SetUniform3f("uDirLight.Direction", glm::vec3(1.0f, -1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uDirLight.Ka", glm::vec3(0.9f, 0.9f, 0.9f));
-    PhongShaderMaterialTexture.SetUniform3f("uDirLight.Kd", glm::vec3(0.1f, 0.1f, 0.1f));
-    PhongShaderMaterialTexture.SetUniform3f("uDirLight.Ks", glm::vec3(1.0f));
-
-    //fenjer
-    PhongShaderMaterialTexture.SetUniform3f("uPointLight.Position", glm::vec3(0.3f, 0.5f, -3.3f));
-    PhongShaderMaterialTexture.SetUniform3f("uPointLight.Ka", glm::vec3(0.5f * fenjer, 0.5f * fenjer, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uPointLight.Kd", glm::vec3(0.5f * fenjer, 0.5f * fenjer, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uPointLight.Ks", glm::vec3(1.0f * fenjer));
-    PhongShaderMaterialTexture.SetUniform1f("uPointLight.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uPointLight.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uPointLight.Kq", 0.032f);
-
-    //ZELENA
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight.Position", glm::vec3(5.5f, -1.0f, 0.8f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight.Direction", glm::vec3(-1.0f, -0.5f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight.Ka", glm::vec3(0.0f, 1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight.Kd", glm::vec3(0.0f, 1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight.Ks", glm::vec3(1.0f));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight.Kq", 0.032f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight.InnerCutOff", glm::cos(glm::radians(10.0f)));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight.OuterCutOff", glm::cos(glm::radians(10.0f)));
-
-    //ZUTA
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight1.Position", glm::vec3(5.9f, -1.0f, 0.8));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight1.Direction", glm::vec3(1.0f, -0.5f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight1.Ka", glm::vec3(1.0f, 1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight1.Kd", glm::vec3(1.0f, 1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight1.Ks", glm::vec3(1.0f));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight1.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight1.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight1.Kq", 0.032f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight1.InnerCutOff", glm::cos(glm::radians(10.0f)));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight1.OuterCutOff", glm::cos(glm::radians(10.0f)));
-
-    //PLAVA
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight2.Position", glm::vec3(5.7f, -1.0f, 0.6f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight2.Direction", glm::vec3(0.0f, -0.5f, -1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight2.Ka", glm::vec3(0.0f, 0.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight2.Kd", glm::vec3(0.0f, 0.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight2.Ks", glm::vec3(1.0f));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight2.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight2.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight2.Kq", 0.032f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight2.InnerCutOff", glm::cos(glm::radians(10.0f)));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight2.OuterCutOff", glm::cos(glm::radians(10.0f)));
-
-    //CRVENA
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight3.Position", glm::vec3(5.70f, -1.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight3.Direction", glm::vec3(0.0f, -0.5f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight3.Ka", glm::vec3(1.0f, 0.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight3.Kd", glm::vec3(1.0f, 0.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight3.Ks", glm::vec3(1.0f));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight3.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight3.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight3.Kq", 0.032f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight3.InnerCutOff", glm::cos(glm::radians(10.0f)));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight3.OuterCutOff", glm::cos(glm::radians(10.0f)));
-
-    //TIRKIZNO
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight4.Position", glm::vec3(5.7f, -0.8f, 0.8f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight4.Direction", glm::vec3(0.0f, 1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight4.Ka", glm::vec3(0.0f, 1.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight4.Kd", glm::vec3(0.0f, 1.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight4.Ks", glm::vec3(1.0f));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight4.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight4.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight4.Kq", 0.032f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight4.InnerCutOff", glm::cos(glm::radians(10.0f)));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight4.OuterCutOff", glm::cos(glm::radians(10.0f)));
-
-    //MAGNETA
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight5.Position", glm::vec3(5.7f, -1.2f, 0.8f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight5.Direction", glm::vec3(0.0f, -1.0f, 0.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight5.Ka", glm::vec3(1.0f, 0.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight5.Kd", glm::vec3(1.0f, 0.0f, 1.0f));
-    PhongShaderMaterialTexture.SetUniform3f("uSpotlight5.Ks", glm::vec3(1.0f));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight5.Kc", 1.0f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight5.Kl", 0.092f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight5.Kq", 0.032f);
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight5.InnerCutOff", glm::cos(glm::radians(10.0f)));
-    PhongShaderMaterialTexture.SetUniform1f("uSpotlight5.OuterCutOff", glm::cos(glm::radians(10.0f)));
-
-    // Diminishes the light's diffuse component by half, tinting it slightly red
-    PhongShaderMaterialTexture.SetUniform1i("uMaterial.Kd", 0);
-    // Makes the object really shiny
-    PhongShaderMaterialTexture.SetUniform1i("uMaterial.Ks", 1);
-    PhongShaderMaterialTexture.SetUniform1f("uMaterial.Shininess", 128.0f);
-    glUseProgram(0);
-
-    glm::mat4 Projection = glm::perspective(45.0f, WindowWidth / (float)WindowHeight, 0.1f, 100.0f);
-    glm::mat4 View = glm::lookAt(FPSCamera.GetPosition(), FPSCamera.GetTarget(), FPSCamera.GetUp());
-    glm::mat4 ModelMatrix(1.0f);
-    
-    // Current angle around Y axis, with regards to XZ plane at which the point light is situated at
-    float Angle = 0.0f;
-    // Distance of point light from center of rotation
-    float Distance = 5.0f;
+    }
+
+    FramePacer Pacer;
+    JobSystem Jobs;
+    Scene CampScene;
+    if (!InitRenderer(Options, Pacer, Jobs, CampScene)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    Hud Overlay;
+    bool OverlayReady = Overlay.Init();
+    if (!OverlayReady) {
+        std::cerr << "[Warn] Performance overlay unavailable" << std::endl;
+    }
+
+    RenderStats Stats;
+    Stats.mCPUTime = 0.0f;
+    Stats.mGPUTime = 0.0f;
+    Stats.mQueueDepth = 0;
+    Stats.mFramesRendered = 0;
+    Stats.mDrawCalls = 0;
+
+    SnapshotBuffer Snapshots;
+    RenderThreadContext RenderContext = { Window, &CampScene, &Pacer, &Snapshots, &Stats, OverlayReady ? &Overlay : 0 };
+    std::thread Renderer;
+    if (!Options.mSingleThread) {
+        // NOTE: A context can only be current on one thread, hand it over to the renderer
+        glfwMakeContextCurrent(0);
+        Renderer = std::thread(RenderThread, &RenderContext);
+    }
+
     float TargetFrameTime = 1.0f / TargetFPS;
     float StartTime = glfwGetTime();
     float EndTime = glfwGetTime();
-    glClearColor(0.3f, 0.7f, 1.0f, 0.0f);
-
-    Shader* CurrentShader = &PhongShaderMaterialTexture;
-    float x = 0, y = 0, z = 0;
+    float TitleUpdateTime = EndTime;
+    unsigned FrameIndex = 0;
     while (!glfwWindowShouldClose(Window)) {
-        glfwPollEvents();
-        HandleInput(&State);
-
-        glUseProgram(CurrentShader->GetId());
-        PhongShaderMaterialTexture.SetUniform3f("uPointLight.Kd", glm::vec3(0.5f * fenjer, 0.5f * fenjer, 0.0f));
-        PhongShaderMaterialTexture.SetUniform3f("uSpotlight.Position", glm::vec3(5.5f, -1.0f+y, 0.8f));
-        PhongShaderMaterialTexture.SetUniform3f("uSpotlight1.Position", glm::vec3(5.9f, -1.0f+y, 0.8));
-        PhongShaderMaterialTexture.SetUniform3f("uSpotlight2.Position", glm::vec3(5.7f, -1.0f+y, 0.6f));
-        PhongShaderMaterialTexture.SetUniform3f("uSpotlight3.Position", glm::vec3(5.70f, -1.0f+y, 1.0f));
-        PhongShaderMaterialTexture.SetUniform3f("uSpotlight4.Position", glm::vec3(5.7f, -0.8f+y, 0.8f));
-        PhongShaderMaterialTexture.SetUniform3f("uSpotlight5.Position", glm::vec3(5.7f, -1.2f+y, 0.8f));
-        glUseProgram(0);
-
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        // NOTE(Jovan): In case of window resize, update projection. Bit bad for performance to do it every iteration.
-        // If laggy, remove this line
-        Projection = glm::perspective(45.0f, WindowWidth / (float)WindowHeight, 0.1f, 100.0f);
-        View = glm::lookAt(FPSCamera.GetPosition(), FPSCamera.GetTarget(), FPSCamera.GetUp());
+        PROFILE_ZONE("Frame");
         StartTime = glfwGetTime();
-        glUseProgram(CurrentShader->GetId());
-        CurrentShader->SetProjection(Projection);
-        CurrentShader->SetView(View);
-        CurrentShader->SetUniform3f("uViewPos", FPSCamera.GetPosition());
-
-        Angle += State.mDT; 
-        MoveCube(Window, x, y, z);
-        glm::mat4 identity(1.0f);
-
-        // NOTE(Jovan): Set cube specular and diffuse textures
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(6.0, -2.65, 1.0));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(1.5f));
-        CurrentShader->SetModel(ModelMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, WaterDiffuseTexture);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, WaterSpecularTexture);
-        glBindVertexArray(CubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, CubeVertices.size() / 8);
-
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(5.7, -1.0+y, 0.8));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.5f));
-        CurrentShader->SetModel(ModelMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, FishTexture);
-        glBindVertexArray(CubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, CubeVertices.size() / 8);
-        
-        //levo krilo staora
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::rotate(identity, GetRadians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        ModelMatrix = glm::rotate(ModelMatrix, GetRadians(-45.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(-4.4, -2.2, 0.6));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(3.0f,6.5f,0.05f));
-        CurrentShader->SetModel(ModelMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, TentTexture);
-        glBindVertexArray(CubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, CubeVertices.size() / 8);
-
-        //desno krilo satora
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::rotate(identity, GetRadians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        ModelMatrix = glm::rotate(ModelMatrix, GetRadians(45.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(-4.4, -2.6, -1.0));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(3.0f, 6.5f, 0.05f));
-        CurrentShader->SetModel(ModelMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, TentTexture);
-        glBindVertexArray(CubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, CubeVertices.size() / 8);
-
-        //pozadina satora
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::rotate(identity, GetRadians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ModelMatrix = glm::rotate(ModelMatrix, GetRadians(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(-1.2, -1.6, -5.9));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(4.5f, 4.5f, 0.05f));
-        CurrentShader->SetModel(ModelMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, TentTexture);
-        glBindVertexArray(CubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, CubeVertices.size() / 8);
-
-        //stap
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::rotate(identity, GetRadians(-45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ModelMatrix = glm::rotate(ModelMatrix, GetRadians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(4.4, 1.9, -1.2));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.1f, 3.0f, 0.1f));
-        CurrentShader->SetModel(ModelMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, CubeDiffuseTexture);
-        glBindVertexArray(CubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, CubeVertices.size() / 8);
-
-        // NOTE(Jovan): Models have their textures automatically loaded and set (if existent)
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::rotate(identity, GetRadians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(2.1, -1.5, -2.4));
-        CurrentShader->SetModel(ModelMatrix);
-        Fox.Render();
-
-        DrawFloor(CubeVAO, *CurrentShader, FloorDiffuseTexture, FloorSpecularTexture);
-
-        glUseProgram(ColorShader.GetId());
-        ColorShader.SetProjection(Projection);
-        ColorShader.SetView(View);
-        ModelMatrix = glm::mat4(1.0f);
-        ModelMatrix = glm::translate(ModelMatrix, glm::vec3(0.0f, 1.0f, -2.0f));
-        ColorShader.SetModel(ModelMatrix);
-        
-        //crvena
-        ModelMatrix = glm::translate(identity, glm::vec3(5.70f, -1.0f+y, 1.0f));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(1.0, 0.0f, 0.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        //zuto
-        ModelMatrix = glm::translate(identity, glm::vec3(5.9f, -1.0f+y, 0.8));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(1.0f, 1.0f, 0.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        //zeleno
-        ModelMatrix = glm::translate(identity, glm::vec3(5.5f, -1.0f+y, 0.8f));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(0.0f, 1.0f, 0.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        //plavo
-        ModelMatrix = glm::translate(identity, glm::vec3(5.7f, -1.0f+y, 0.6f));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(0.0f, 0.0f, 1.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        //tirkizno
-        ModelMatrix = glm::translate(identity, glm::vec3(5.7f, -0.8f+y, 0.8f));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(0.0f, 1.0f, 1.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        //magneta
-        ModelMatrix = glm::translate(identity, glm::vec3(5.7f, -1.2f+y, 0.8f));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(1.0f, 0.0f, 1.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-
-        //fenjer
-        ModelMatrix = glm::translate(identity, glm::vec3(0.3f, 0.5f, -3.3f));
-        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
-        ColorShader.SetModel(ModelMatrix);
-        glBindVertexArray(CubeVAO);
-        ColorShader.SetUniform3f("uColor", glm::vec3(1.0f, 1.0f, 0.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glfwSwapBuffers(Window);
+        glfwPollEvents();
+        unsigned short InputState = PollInputState(&State, Window);
+        // NOTE: Replays step with the recorded deltas instead of the clock, so the simulation retraces the session
+        if (Options.mReplayPath && !Player.Advance(State.mDT, InputState)) {
+            break;
+        }
+        Recorder.Record(State.mDT, InputState);
+        Simulate(&State, InputState);
+
+        FrameSnapshot& Snapshot = Snapshots.BeginWrite();
+        WriteSnapshot(&State, FrameIndex++, Snapshot);
+        if (Options.mSingleThread) {
+            RenderFrame(Window, CampScene, Pacer, Stats, RenderContext.mHud, Snapshot);
+        } else {
+            Snapshots.Publish();
+        }
 
         // NOTE(Jovan): Time management
         EndTime = glfwGetTime();
         float WorkTime = EndTime - StartTime;
         if (WorkTime < TargetFrameTime) {
+            PROFILE_ZONE("Frame limiter");
             int DeltaMS = (int)((TargetFrameTime - WorkTime) * 1000.0f);
             std::this_thread::sleep_for(std::chrono::milliseconds(DeltaMS));
             EndTime = glfwGetTime();
         }
         State.mDT = EndTime - StartTime;
+
+        if (EndTime - TitleUpdateTime > TitleUpdateInterval) {
+            // NOTE: Formatted into a stack buffer, a string stream here allocated twice a second
+            char Title[128];
+            snprintf(Title, sizeof(Title), "%s | CPU %.2f ms | GPU %.2f ms | Queue %u/%u | Draws %u", WindowTitle,
+                Stats.mCPUTime * 1000.0, Stats.mGPUTime * 1000.0, (unsigned)Stats.mQueueDepth, Pacer.GetFramesInFlight(),
+                (unsigned)Stats.mDrawCalls);
+            glfwSetWindowTitle(Window, Title);
+            TitleUpdateTime = EndTime;
+        }
     }
 
+    if (Options.mSingleThread) {
+        Overlay.Destroy();
+        CampScene.Destroy();
+        Pacer.Destroy();
+    } else {
+        Snapshots.Close();
+        Renderer.join();
+    }
+
+    if (Recorder.IsOpen()) {
+        Recorder.Close();
+        std::cout << "Input recording: " << Recorder.GetFrameCount() << " frames over " << Recorder.GetDuration() << " s written to "
+            << Options.mRecordPath << std::endl;
+    }
+    PrintRendererStats(CampScene, Pacer, FrameIndex);
+    WriteExitReports(Options);
+    FinishProfiling(Options);
     glfwTerminate();
     return 0;
-}
+}
\ No newline at end of file
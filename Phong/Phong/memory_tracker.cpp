@@ -0,0 +1,274 @@
+#include "memory_tracker.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+static const char* CATEGORY_NAMES[MEMORY_CATEGORY_COUNT] = {
+    "Mesh data", "Staging", "Vertex buffers", "Index buffers", "Stream buffers", "Textures", "Render targets", "Programs",
+};
+
+struct TrackedResource {
+    unsigned long long mBytes;
+    std::string mOwner;
+};
+
+struct OwnerUsage {
+    unsigned long long mBytes[MEMORY_CATEGORY_COUNT];
+};
+
+typedef std::pair<unsigned, unsigned long long> ResourceKey;
+
+// NOTE: Function statics so tracking works no matter when the first resource is created
+static std::mutex&
+TrackerMutex() {
+    static std::mutex Mutex;
+    return Mutex;
+}
+
+static std::map<ResourceKey, TrackedResource>&
+Resources() {
+    static std::map<ResourceKey, TrackedResource> Map;
+    return Map;
+}
+
+static std::map<std::string, OwnerUsage>&
+Owners() {
+    static std::map<std::string, OwnerUsage> Map;
+    return Map;
+}
+
+static MemoryCategoryStats sCategories[MEMORY_CATEGORY_COUNT];
+static unsigned long long sCPUPeak = 0;
+static unsigned long long sGPUPeak = 0;
+
+static void
+ChargeOwner(const std::string& owner, unsigned category, long long delta) {
+    std::map<std::string, OwnerUsage>::iterator Owner = Owners().find(owner);
+    if (Owner == Owners().end()) {
+        OwnerUsage Usage = { { 0 } };
+        Owner = Owners().insert(std::make_pair(owner, Usage)).first;
+    }
+    Owner->second.mBytes[category] += delta;
+}
+
+static void
+ChargeCategory(unsigned category, long long delta, int allocations) {
+    MemoryCategoryStats& Stats = sCategories[category];
+    Stats.mBytes += delta;
+    Stats.mAllocations += allocations;
+    Stats.mPeakBytes = std::max(Stats.mPeakBytes, Stats.mBytes);
+
+    unsigned long long CPU = 0;
+    unsigned long long GPU = 0;
+    for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+        (MemoryTracker::IsGPUCategory((EMemoryCategory)CategoryIdx) ? GPU : CPU) += sCategories[CategoryIdx].mBytes;
+    }
+    sCPUPeak = std::max(sCPUPeak, CPU);
+    sGPUPeak = std::max(sGPUPeak, GPU);
+}
+
+void
+MemoryTracker::Track(EMemoryCategory category, unsigned long long id, unsigned long long bytes, const std::string& owner) {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    ResourceKey Key(category, id);
+    std::map<ResourceKey, TrackedResource>::iterator Found = Resources().find(Key);
+    if (Found != Resources().end()) {
+        // NOTE: Resized or handed to a new owner, move the old charge over
+        ChargeOwner(Found->second.mOwner, category, -(long long)Found->second.mBytes);
+        ChargeCategory(category, -(long long)Found->second.mBytes, -1);
+        Resources().erase(Found);
+    }
+
+    TrackedResource Resource = { bytes, owner };
+    Resources().insert(std::make_pair(Key, Resource));
+    ChargeOwner(owner, category, bytes);
+    ChargeCategory(category, bytes, 1);
+}
+
+void
+MemoryTracker::Resize(EMemoryCategory category, unsigned long long id, unsigned long long bytes) {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    std::map<ResourceKey, TrackedResource>::iterator Found = Resources().find(ResourceKey(category, id));
+    if (Found == Resources().end()) {
+        return;
+    }
+
+    long long Delta = (long long)bytes - (long long)Found->second.mBytes;
+    Found->second.mBytes = bytes;
+    ChargeOwner(Found->second.mOwner, category, Delta);
+    ChargeCategory(category, Delta, 0);
+}
+
+void
+MemoryTracker::Untrack(EMemoryCategory category, unsigned long long id) {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    std::map<ResourceKey, TrackedResource>::iterator Found = Resources().find(ResourceKey(category, id));
+    if (Found == Resources().end()) {
+        return;
+    }
+
+    ChargeOwner(Found->second.mOwner, category, -(long long)Found->second.mBytes);
+    ChargeCategory(category, -(long long)Found->second.mBytes, -1);
+    Resources().erase(Found);
+}
+
+MemoryCategoryStats
+MemoryTracker::GetCategoryStats(EMemoryCategory category) {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    return sCategories[category];
+}
+
+unsigned long long
+MemoryTracker::GetCPUBytes() {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    unsigned long long Bytes = 0;
+    for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+        Bytes += IsGPUCategory((EMemoryCategory)CategoryIdx) ? 0 : sCategories[CategoryIdx].mBytes;
+    }
+    return Bytes;
+}
+
+unsigned long long
+MemoryTracker::GetGPUBytes() {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    unsigned long long Bytes = 0;
+    for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+        Bytes += IsGPUCategory((EMemoryCategory)CategoryIdx) ? sCategories[CategoryIdx].mBytes : 0;
+    }
+    return Bytes;
+}
+
+unsigned long long
+MemoryTracker::GetCPUPeakBytes() {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    return sCPUPeak;
+}
+
+unsigned long long
+MemoryTracker::GetGPUPeakBytes() {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    return sGPUPeak;
+}
+
+const char*
+MemoryTracker::GetCategoryName(EMemoryCategory category) {
+    return category < MEMORY_CATEGORY_COUNT ? CATEGORY_NAMES[category] : "Unknown";
+}
+
+bool
+MemoryTracker::IsGPUCategory(EMemoryCategory category) {
+    return category >= MEMORY_VERTEX_BUFFER;
+}
+
+unsigned long long
+MemoryTracker::TextureBytes(int width, int height, unsigned bytesPerTexel, bool mipmapped) {
+    unsigned long long Bytes = 0;
+    for (;;) {
+        Bytes += (unsigned long long)width * height * bytesPerTexel;
+        if (!mipmapped || (width <= 1 && height <= 1)) {
+            return Bytes;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+}
+
+static bool
+CompareOwners(const std::pair<std::string, unsigned long long>& a, const std::pair<std::string, unsigned long long>& b) {
+    return a.second > b.second;
+}
+
+void
+MemoryTracker::Report(std::ostream& output, unsigned ownerCount) {
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    std::ios::fmtflags Flags = output.flags();
+    output << std::fixed << std::setprecision(2);
+    output << "Memory by category (MB)" << std::endl;
+    output << "                      live      peak   count" << std::endl;
+    unsigned long long Totals[2] = { 0, 0 };
+    for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+        const MemoryCategoryStats& Stats = sCategories[CategoryIdx];
+        Totals[IsGPUCategory((EMemoryCategory)CategoryIdx)] += Stats.mBytes;
+        output << std::left << std::setw(18) << CATEGORY_NAMES[CategoryIdx] << std::right
+            << std::setw(10) << Stats.mBytes / (1024.0 * 1024.0) << std::setw(10) << Stats.mPeakBytes / (1024.0 * 1024.0)
+            << std::setw(8) << Stats.mAllocations << std::endl;
+    }
+    output << "CPU total " << Totals[0] / (1024.0 * 1024.0) << " MB (peak " << sCPUPeak / (1024.0 * 1024.0) << "), GPU total "
+        << Totals[1] / (1024.0 * 1024.0) << " MB (peak " << sGPUPeak / (1024.0 * 1024.0) << ")" << std::endl;
+
+    std::vector<std::pair<std::string, unsigned long long> > Sorted;
+    for (std::map<std::string, OwnerUsage>::const_iterator Owner = Owners().begin(); Owner != Owners().end(); ++Owner) {
+        unsigned long long Bytes = 0;
+        for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+            Bytes += Owner->second.mBytes[CategoryIdx];
+        }
+        if (Bytes) {
+            Sorted.push_back(std::make_pair(Owner->first, Bytes));
+        }
+    }
+    std::sort(Sorted.begin(), Sorted.end(), CompareOwners);
+    unsigned Listed = ownerCount && ownerCount < Sorted.size() ? ownerCount : Sorted.size();
+    output << "Largest owners (MB)" << std::endl;
+    for (unsigned OwnerIdx = 0; OwnerIdx < Listed; ++OwnerIdx) {
+        const OwnerUsage& Usage = Owners()[Sorted[OwnerIdx].first];
+        unsigned long long Split[2] = { 0, 0 };
+        for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+            Split[IsGPUCategory((EMemoryCategory)CategoryIdx)] += Usage.mBytes[CategoryIdx];
+        }
+        output << std::setw(10) << Sorted[OwnerIdx].second / (1024.0 * 1024.0) << "  CPU " << Split[0] / (1024.0 * 1024.0)
+            << "  GPU " << Split[1] / (1024.0 * 1024.0) << "  " << Sorted[OwnerIdx].first << std::endl;
+    }
+    output.flags(Flags);
+}
+
+static void
+WriteJSONString(std::ostream& output, const std::string& value) {
+    output << '"';
+    for (unsigned CharIdx = 0; CharIdx < value.size(); ++CharIdx) {
+        char Character = value[CharIdx];
+        if (Character == '"' || Character == '\\') {
+            output << '\\';
+        }
+        output << Character;
+    }
+    output << '"';
+}
+
+bool
+MemoryTracker::WriteJSON(const std::string& filename) {
+    std::ofstream Output(filename.c_str());
+    if (!Output) {
+        std::cerr << "[Err] Failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> Lock(TrackerMutex());
+    Output << "{\n  \"cpu_peak_bytes\": " << sCPUPeak << ",\n  \"gpu_peak_bytes\": " << sGPUPeak << ",\n  \"categories\": [\n";
+    for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+        const MemoryCategoryStats& Stats = sCategories[CategoryIdx];
+        Output << "    { \"name\": \"" << CATEGORY_NAMES[CategoryIdx] << "\", \"gpu\": "
+            << (IsGPUCategory((EMemoryCategory)CategoryIdx) ? "true" : "false") << ", \"bytes\": " << Stats.mBytes
+            << ", \"peak_bytes\": " << Stats.mPeakBytes << ", \"count\": " << Stats.mAllocations << " }"
+            << (CategoryIdx + 1 < MEMORY_CATEGORY_COUNT ? ",\n" : "\n");
+    }
+    Output << "  ],\n  \"owners\": [\n";
+    unsigned OwnerIdx = 0;
+    for (std::map<std::string, OwnerUsage>::const_iterator Owner = Owners().begin(); Owner != Owners().end(); ++Owner, ++OwnerIdx) {
+        Output << "    { \"owner\": ";
+        WriteJSONString(Output, Owner->first);
+        for (unsigned CategoryIdx = 0; CategoryIdx < MEMORY_CATEGORY_COUNT; ++CategoryIdx) {
+            if (Owner->second.mBytes[CategoryIdx]) {
+                Output << ", ";
+                WriteJSONString(Output, CATEGORY_NAMES[CategoryIdx]);
+                Output << ": " << Owner->second.mBytes[CategoryIdx];
+            }
+        }
+        Output << " }" << (OwnerIdx + 1 < Owners().size() ? ",\n" : "\n");
+    }
+    Output << "  ]\n}\n";
+    return true;
+}
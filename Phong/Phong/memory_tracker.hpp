@@ -0,0 +1,105 @@
+/**
+ * @file memory_tracker.hpp
+ * @brief CPU and GPU memory accounting by category and owner
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <ostream>
+#include <string>
+
+enum EMemoryCategory {
+    // NOTE: CPU side
+    MEMORY_MESH_DATA = 0,
+    MEMORY_STAGING = 1,
+    // NOTE: GPU side, everything from here on
+    MEMORY_VERTEX_BUFFER = 2,
+    MEMORY_INDEX_BUFFER = 3,
+    MEMORY_STREAM_BUFFER = 4,
+    MEMORY_TEXTURE = 5,
+    MEMORY_RENDER_TARGET = 6,
+    MEMORY_PROGRAM = 7,
+    MEMORY_CATEGORY_COUNT = 8,
+};
+
+struct MemoryCategoryStats {
+    unsigned long long mBytes;
+    unsigned long long mPeakBytes;
+    unsigned mAllocations;
+};
+
+/**
+ * @brief Every tracked resource is keyed by its category and an id, the GL name for GL objects.
+ * Tracking happens when resources are created or resized, so a single lock keeps it safe for
+ * loaders running on job threads. Resize doesn't allocate and may run inside a frame
+ */
+class MemoryTracker {
+public:
+    /**
+     * @brief Records a resource or updates the size of one already tracked
+     *
+     * @param category What kind of memory the resource uses
+     * @param id Unique within the category, GL names work as is
+     * @param bytes Current size
+     * @param owner Model, mesh, texture path or subsystem the memory is charged to
+     */
+    static void Track(EMemoryCategory category, unsigned long long id, unsigned long long bytes, const std::string& owner);
+
+    /**
+     * @brief Updates the size of a tracked resource in place, keeping its owner. Unknown ids are ignored
+     *
+     * @param category Category it was tracked under
+     * @param id Id it was tracked under
+     * @param bytes New size
+     */
+    static void Resize(EMemoryCategory category, unsigned long long id, unsigned long long bytes);
+
+    /**
+     * @brief Forgets a resource. Unknown ids are ignored
+     *
+     * @param category Category it was tracked under
+     * @param id Id it was tracked under
+     */
+    static void Untrack(EMemoryCategory category, unsigned long long id);
+
+    static MemoryCategoryStats GetCategoryStats(EMemoryCategory category);
+    static unsigned long long GetCPUBytes();
+    static unsigned long long GetGPUBytes();
+    static unsigned long long GetCPUPeakBytes();
+    static unsigned long long GetGPUPeakBytes();
+    static const char* GetCategoryName(EMemoryCategory category);
+    static bool IsGPUCategory(EMemoryCategory category);
+
+    /**
+     * @brief Size of a 2D texture including its mip chain
+     *
+     * @param width Base level width
+     * @param height Base level height
+     * @param bytesPerTexel Bytes per texel as stored by the driver
+     * @param mipmapped Whether levels down to 1x1 exist
+     *
+     * @returns Size in bytes
+     */
+    static unsigned long long TextureBytes(int width, int height, unsigned bytesPerTexel, bool mipmapped);
+
+    /**
+     * @brief Prints live and peak usage per category followed by the largest owners
+     *
+     * @param output Stream to print to
+     * @param ownerCount Number of owners listed, 0 lists all
+     */
+    static void Report(std::ostream& output, unsigned ownerCount);
+
+    /**
+     * @brief Writes categories and every owner as JSON
+     *
+     * @param filename Output path
+     *
+     * @returns true - Success, false - Failure
+     */
+    static bool WriteJSON(const std::string& filename);
+};
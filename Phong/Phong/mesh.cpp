@@ -1,93 +1,420 @@
 #include "mesh.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
+#include "shader.hpp"
+#include <cmath>
 
-Mesh::Mesh(const aiMesh* mesh, const aiMaterial* material, const std::string &resPath) {
-    processMesh(mesh, material, resPath);
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MESH_IMPORT_SSE2
+#endif
+
+Mesh::Mesh(PreparedMesh& prepared, const TexturePacker& textures, EMeshResidency residency) {
+    mResidency = residency;
+    upload(prepared, textures);
 }
 
 void
 Mesh::Render() const {
-    glBindVertexArray(mVAO);
+    glBindVertexArray(mVAO.Get());
+    FrameStats::CountVAOBind();
 
-    if (mDiffuseTexture) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, mDiffuseTexture);
-    }
+    // NOTE: Leaves the PerMaterial block to the caller, Record is the path that sets it
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mDiffuseTexture);
+    glBindSampler(0, mDiffuseSampler);
+    FrameStats::CountTextureBind();
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mSpecularTexture);
+    glBindSampler(1, mSpecularSampler);
+    FrameStats::CountTextureBind();
 
-    if (mSpecularTexture) {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, mSpecularTexture);
+    // NOTE: The element buffer is part of the VAO state, unbinding it here would detach it from the VAO
+    if (mIndexCount) {
+        glPrimitiveRestartIndex(IndexEncoding::GetRestartIndex(mIndexType));
+        glDrawElements(mPrimitive, mDrawIndexCount, mIndexType, (void*)0);
+        FrameStats::CountDraw(mPrimitive, mDrawIndexCount, mTriangleCount);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, mVertexCount);
+        FrameStats::CountDraw(GL_TRIANGLES, mVertexCount);
     }
+    glBindVertexArray(0);
+}
+
+void
+Mesh::Record(CommandBuffer& commands) const {
+    commands.BindVertexArray(mVAO.Get());
+    commands.BindTexture(0, mDiffuseTexture, GL_TEXTURE_2D_ARRAY);
+    commands.BindTexture(1, mSpecularTexture, GL_TEXTURE_2D_ARRAY);
+    commands.BindSampler(0, mDiffuseSampler);
+    commands.BindSampler(1, mSpecularSampler);
+    commands.SetUniformBlock(Shader::PER_MATERIAL_BINDING, &mMaterial, sizeof(mMaterial));
 
+    // NOTE: The element buffer is part of the VAO state, binding the VAO is enough
     if (mIndexCount) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
-        glDrawElements(GL_TRIANGLES, mIndexCount, GL_UNSIGNED_INT, (void*)0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        commands.DrawElements(mPrimitive, mDrawIndexCount, mIndexType, 0, mTriangleCount);
+    } else {
+        commands.DrawArrays(GL_TRIANGLES, 0, mVertexCount);
+    }
+}
+
+void
+Mesh::RequestTextureLevels(TexturePacker& textures, float pixelsPerUnit) const {
+    if (!(pixelsPerUnit > 0.0f)) {
         return;
     }
 
-    glDrawArrays(GL_TRIANGLES, 0, mVertexCount);
-    glBindVertexArray(0);
+    // NOTE: UVs were remapped into the diffuse slot at import, the block maps them on into both slots
+    float UVPerPixel = mUVDensity / pixelsPerUnit;
+    textures.RequestLevel(mDiffuseArray, UVPerPixel * std::max(mMaterial.DiffuseRect.x, mMaterial.DiffuseRect.y));
+    textures.RequestLevel(mSpecularArray, UVPerPixel * std::max(mMaterial.SpecularRect.x, mMaterial.SpecularRect.y));
+}
+
+const glm::vec3&
+Mesh::GetBoundsMin() const {
+    return mBoundsMin;
+}
+
+const glm::vec3&
+Mesh::GetBoundsMax() const {
+    return mBoundsMax;
+}
+
+bool
+Mesh::Prepare(const aiMesh* const* meshes, unsigned meshCount, const glm::vec4* uvRects, const MeshMaterial& material, const std::string& resPath, LinearArena& arena, EIndexEncoding encoding, PreparedMesh& prepared) {
+    PROFILE_FUNCTION();
+    const aiMesh* First = meshes[0];
+    prepared.mName = resPath + "/" + (First->mName.length ? First->mName.C_Str() : "mesh");
+    if (meshCount > 1) {
+        prepared.mName += " + " + std::to_string(meshCount - 1) + " merged";
+    }
+    prepared.mMaterial = material;
+    MeshImportData& Geometry = prepared.mGeometry;
+    if (!Import(meshes, meshCount, arena, Geometry, uvRects)
+        || !IndexEncoding::Encode(Geometry.mIndices, Geometry.mIndexCount, Geometry.mVertexCount, encoding, arena, Geometry.mEncoded)) {
+        std::cerr << "[Err] Failed to import mesh " << prepared.mName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+EMeshResidency
+Mesh::GetResidency() const {
+    return mResidency;
 }
 
 unsigned
-Mesh::loadMeshTexture(const aiMaterial* material, const std::string& resPath, aiTextureType type) {
-    if (material && material->GetTextureCount(type) > 0) {
-        aiString Path;
-        if (material->GetTexture(type, 0, &Path, NULL, NULL, NULL, NULL, NULL) == AI_SUCCESS) {
-            std::string FullPath = resPath + "/" + Path.data;
-            unsigned TextureID = Texture::LoadImageToTexture(FullPath);
-            return TextureID;
+Mesh::GetVertexCount() const {
+    return mVertexCount;
+}
+
+unsigned
+Mesh::GetIndexCount() const {
+    return mIndexCount;
+}
+
+unsigned
+Mesh::GetSubmeshCount() const {
+    return mSubmeshCount;
+}
+
+float
+Mesh::GetUVDensity() const {
+    return mUVDensity;
+}
+
+unsigned
+Mesh::GetIndexType() const {
+    return mIndexType;
+}
+
+unsigned
+Mesh::GetPrimitive() const {
+    return mPrimitive;
+}
+
+unsigned
+Mesh::GetIndexBytes() const {
+    return mDrawIndexCount * IndexEncoding::GetIndexSize(mIndexType);
+}
+
+const std::vector<float>&
+Mesh::GetVertices() const {
+    return mVertices;
+}
+
+const std::vector<glm::vec3>&
+Mesh::GetPositions() const {
+    return mPositions;
+}
+
+const std::vector<unsigned>&
+Mesh::GetIndices() const {
+    return mIndices;
+}
+
+unsigned
+Mesh::GetResidentBytes() const {
+    return mVertices.capacity() * sizeof(float) + mPositions.capacity() * sizeof(glm::vec3) + mIndices.capacity() * sizeof(unsigned);
+}
+
+const char*
+Mesh::GetResidencyName(EMeshResidency residency) {
+    static const char* Names[MESH_RESIDENCY_COUNT] = { "none", "positions", "full" };
+    return residency < MESH_RESIDENCY_COUNT ? Names[residency] : "unknown";
+}
+
+unsigned
+Mesh::GetImportSize(const aiMesh* mesh, EIndexEncoding encoding) {
+    return GetImportSize(&mesh, 1, encoding);
+}
+
+unsigned
+Mesh::GetImportSize(const aiMesh* const* meshes, unsigned meshCount, EIndexEncoding encoding) {
+    unsigned VertexCount = 0;
+    unsigned FaceCount = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < meshCount; ++MeshIdx) {
+        VertexCount += meshes[MeshIdx]->mNumVertices;
+        FaceCount += meshes[MeshIdx]->mNumFaces;
+    }
+    unsigned TransformBytes = meshCount > 1 ? LinearArena::AlignedSize(VertexCount * sizeof(unsigned short)) : 0;
+    return LinearArena::AlignedSize(VertexCount * VERTEX_STRIDE * sizeof(float))
+        + LinearArena::AlignedSize(FaceCount * 3 * sizeof(unsigned))
+        + TransformBytes + IndexEncoding::GetEncodeSize(FaceCount, encoding);
+}
+
+bool
+Mesh::Import(const aiMesh* mesh, LinearArena& arena, MeshImportData& data) {
+    return Import(&mesh, 1, arena, data);
+}
+
+bool
+Mesh::Import(const aiMesh* const* meshes, unsigned meshCount, LinearArena& arena, MeshImportData& data, const glm::vec4* uvRects) {
+    PROFILE_FUNCTION();
+    unsigned VertexCount = 0;
+    unsigned FaceCount = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < meshCount; ++MeshIdx) {
+        VertexCount += meshes[MeshIdx]->mNumVertices;
+        FaceCount += meshes[MeshIdx]->mNumFaces;
+    }
+
+    data.mVertexCount = 0;
+    data.mIndexCount = 0;
+    data.mVertices = arena.AllocateArray<float>(VertexCount * VERTEX_STRIDE);
+    data.mIndices = arena.AllocateArray<unsigned>(FaceCount * 3);
+    data.mTransformIndices = meshCount > 1 ? arena.AllocateArray<unsigned short>(VertexCount) : 0;
+    data.mSubmeshCount = meshCount;
+    data.mBoundsMin = glm::vec3(0.0f);
+    data.mBoundsMax = glm::vec3(0.0f);
+    data.mUVDensity = 0.0f;
+    data.mEncoded.mData = 0;
+    data.mEncoded.mCount = 0;
+    data.mEncoded.mType = GL_UNSIGNED_INT;
+    data.mEncoded.mMode = GL_TRIANGLES;
+    data.mEncoded.mTriangleCount = 0;
+    if (!data.mVertices || !data.mIndices || (meshCount > 1 && !data.mTransformIndices)) {
+        return false;
+    }
+
+    float Min[4] = { 3.4e38f, 3.4e38f, 3.4e38f, 3.4e38f };
+    float Max[4] = { -3.4e38f, -3.4e38f, -3.4e38f, -3.4e38f };
+    unsigned BaseVertex = 0;
+    unsigned IndexCount = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < meshCount; ++MeshIdx) {
+        const aiMesh* Current = meshes[MeshIdx];
+        glm::vec4 UVRect = uvRects ? uvRects[MeshIdx] : glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+        interleaveVertices(Current, UVRect, data.mVertices + BaseVertex * VERTEX_STRIDE, Min, Max);
+        for (unsigned FaceIdx = 0; FaceIdx < Current->mNumFaces; ++FaceIdx) {
+            const aiFace& Face = Current->mFaces[FaceIdx];
+            // NOTE: Triangulation keeps point and line primitives, they have no place in a triangle list
+            if (Face.mNumIndices != 3) {
+                continue;
+            }
+
+            data.mIndices[IndexCount] = BaseVertex + Face.mIndices[0];
+            data.mIndices[IndexCount + 1] = BaseVertex + Face.mIndices[1];
+            data.mIndices[IndexCount + 2] = BaseVertex + Face.mIndices[2];
+            IndexCount += 3;
+        }
+
+        if (data.mTransformIndices) {
+            for (unsigned VertexIdx = 0; VertexIdx < Current->mNumVertices; ++VertexIdx) {
+                data.mTransformIndices[BaseVertex + VertexIdx] = (unsigned short)MeshIdx;
+            }
         }
+        BaseVertex += Current->mNumVertices;
+    }
+
+    data.mVertexCount = VertexCount;
+    data.mIndexCount = IndexCount;
+    data.mEncoded.mData = data.mIndices;
+    data.mEncoded.mCount = IndexCount;
+    data.mEncoded.mTriangleCount = IndexCount / 3;
+    if (VertexCount) {
+        data.mBoundsMin = glm::vec3(Min[0], Min[1], Min[2]);
+        data.mBoundsMax = glm::vec3(Max[0], Max[1], Max[2]);
     }
+    data.mUVDensity = getUVDensity(data.mVertices, data.mIndices, IndexCount);
+    return true;
+}
+
+float
+Mesh::getUVDensity(const float* vertices, const unsigned* indices, unsigned indexCount) {
+    // NOTE: Ratio of the summed UV and object space triangle areas, the square root turns it
+    // into UV units per object space unit
+    double Area = 0.0;
+    double UVArea = 0.0;
+    for (unsigned Idx = 0; Idx + 2 < indexCount; Idx += 3) {
+        const float* A = vertices + indices[Idx] * VERTEX_STRIDE;
+        const float* B = vertices + indices[Idx + 1] * VERTEX_STRIDE;
+        const float* C = vertices + indices[Idx + 2] * VERTEX_STRIDE;
+        float AB[3] = { B[0] - A[0], B[1] - A[1], B[2] - A[2] };
+        float AC[3] = { C[0] - A[0], C[1] - A[1], C[2] - A[2] };
+        float Cross[3] = { AB[1] * AC[2] - AB[2] * AC[1], AB[2] * AC[0] - AB[0] * AC[2], AB[0] * AC[1] - AB[1] * AC[0] };
+        Area += std::sqrt(Cross[0] * Cross[0] + Cross[1] * Cross[1] + Cross[2] * Cross[2]);
+        UVArea += std::fabs((B[6] - A[6]) * (C[7] - A[7]) - (B[7] - A[7]) * (C[6] - A[6]));
+    }
+    return Area > 0.0 ? (float)std::sqrt(UVArea / Area) : 0.0f;
+}
+
+void
+Mesh::interleaveVertices(const aiMesh* mesh, const glm::vec4& uvRect, float* out, float* min, float* max) {
+    static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "Interleaving expects packed float vectors");
+    // NOTE: Missing attributes read this with a zero step, four floats so a 4 wide load stays inside it
+    static const float ZeroAttribute[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-    return 0;
+    unsigned VertexCount = mesh->mNumVertices;
+    const float* Positions = VertexCount ? &mesh->mVertices[0].x : ZeroAttribute;
+    const float* Normals = mesh->mNormals ? &mesh->mNormals[0].x : ZeroAttribute;
+    unsigned NormalStep = mesh->mNormals ? 3 : 0;
+    const float* UVs = mesh->HasTextureCoords(0) ? &mesh->mTextureCoords[0][0].x : ZeroAttribute;
+    unsigned UVStep = mesh->HasTextureCoords(0) ? 3 : 0;
+    float* Out = out;
+    unsigned VertexIdx = 0;
+
+#ifdef MESH_IMPORT_SSE2
+    // NOTE: A 4 wide load of a packed vec3 also reads the first float of the next vertex. Each store
+    // spills one float into the next attribute, which the following store overwrites. The last
+    // vertex goes through the scalar loop so no load runs past the end of the arrays
+    __m128 MinLanes = _mm_loadu_ps(min);
+    __m128 MaxLanes = _mm_loadu_ps(max);
+    __m128 UVScale = _mm_setr_ps(uvRect.x, uvRect.y, 0.0f, 0.0f);
+    __m128 UVOffset = _mm_setr_ps(uvRect.z, uvRect.w, 0.0f, 0.0f);
+    for (; VertexIdx + 1 < VertexCount; ++VertexIdx) {
+        __m128 Position = _mm_loadu_ps(Positions + VertexIdx * 3);
+        __m128 Normal = _mm_loadu_ps(Normals + VertexIdx * NormalStep);
+        __m128 UV = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(UVs + VertexIdx * UVStep));
+        UV = _mm_add_ps(_mm_mul_ps(UV, UVScale), UVOffset);
+        _mm_storeu_ps(Out, Position);
+        _mm_storeu_ps(Out + 3, Normal);
+        _mm_storel_pi((__m64*)(Out + 6), UV);
+        MinLanes = _mm_min_ps(MinLanes, Position);
+        MaxLanes = _mm_max_ps(MaxLanes, Position);
+        Out += VERTEX_STRIDE;
+    }
+    _mm_storeu_ps(min, MinLanes);
+    _mm_storeu_ps(max, MaxLanes);
+#endif
+
+    for (; VertexIdx < VertexCount; ++VertexIdx) {
+        const float* Position = Positions + VertexIdx * 3;
+        const float* Normal = Normals + VertexIdx * NormalStep;
+        const float* UV = UVs + VertexIdx * UVStep;
+        for (unsigned Component = 0; Component < 3; ++Component) {
+            Out[Component] = Position[Component];
+            Out[3 + Component] = Normal[Component];
+            min[Component] = Position[Component] < min[Component] ? Position[Component] : min[Component];
+            max[Component] = Position[Component] > max[Component] ? Position[Component] : max[Component];
+        }
+        Out[6] = UV[0] * uvRect.x + uvRect.z;
+        Out[7] = UV[1] * uvRect.y + uvRect.w;
+        Out += VERTEX_STRIDE;
+    }
 }
 
 void
-Mesh::processMesh(const aiMesh* mesh, const aiMaterial* material, const std::string& resPath) {
-    const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
-
-    for (unsigned VertexIndex = 0; VertexIndex < mesh->mNumVertices; ++VertexIndex) {
-        std::vector<float> Position = { mesh->mVertices[VertexIndex].x, mesh->mVertices[VertexIndex].y, mesh->mVertices[VertexIndex].z };
-        mVertices.insert(mVertices.end(), Position.begin(), Position.end());
-        std::vector<float> Normals = { mesh->mNormals[VertexIndex].x, mesh->mNormals[VertexIndex].y, mesh->mNormals[VertexIndex].z };
-        mVertices.insert(mVertices.end(), Normals.begin(), Normals.end());
-        const aiVector3D* TexCoords = mesh->HasTextureCoords(0) ? &(mesh->mTextureCoords[0][VertexIndex]) : &Zero3D;
-        std::vector<float> UV = { TexCoords->x, TexCoords->y };
-        mVertices.insert(mVertices.end(), UV.begin(), UV.end());
-    }
-
-    for (unsigned FaceIndex = 0; FaceIndex < mesh->mNumFaces; ++FaceIndex) {
-        const aiFace& Face = mesh->mFaces[FaceIndex];
-        mIndices.push_back(Face.mIndices[0]);
-        mIndices.push_back(Face.mIndices[1]);
-        mIndices.push_back(Face.mIndices[2]);
-    }
-
-    mVertexCount = mVertices.size() / 6;
-    mIndexCount = mIndices.size();
-
-    mDiffuseTexture = loadMeshTexture(material, resPath, aiTextureType_DIFFUSE);
-    mSpecularTexture = loadMeshTexture(material, resPath, aiTextureType_SPECULAR);
-
-    glGenVertexArrays(1, &mVAO);
-    glBindVertexArray(mVAO);
-    glGenBuffers(1, &mVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-    glBufferData(GL_ARRAY_BUFFER, mVertices.size() * sizeof(float), mVertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+Mesh::upload(PreparedMesh& prepared, const TexturePacker& textures) {
+    PROFILE_FUNCTION();
+    const MeshImportData& Data = prepared.mGeometry;
+    mName = prepared.mName;
+    mBoundsMin = Data.mBoundsMin;
+    mBoundsMax = Data.mBoundsMax;
+    mVertexCount = Data.mVertexCount;
+    mIndexCount = Data.mIndexCount;
+    mSubmeshCount = Data.mSubmeshCount;
+    mDrawIndexCount = Data.mEncoded.mCount;
+    mIndexType = Data.mEncoded.mType;
+    mPrimitive = Data.mEncoded.mMode;
+    mTriangleCount = Data.mEncoded.mTriangleCount;
+    unsigned VertexBytes = mVertexCount * VERTEX_STRIDE * sizeof(float);
+    unsigned IndexBytes = GetIndexBytes();
+
+    mDiffuseTexture = textures.GetTexture(prepared.mMaterial.mDiffuseArray);
+    mSpecularTexture = textures.GetTexture(prepared.mMaterial.mSpecularArray);
+    mDiffuseSampler = SamplerCache::Resolve(prepared.mMaterial.mDiffuseSampler);
+    mSpecularSampler = SamplerCache::Resolve(prepared.mMaterial.mSpecularSampler);
+    mMaterial = prepared.mMaterial.mBlock;
+    mDiffuseArray = prepared.mMaterial.mDiffuseArray;
+    mSpecularArray = prepared.mMaterial.mSpecularArray;
+    mUVDensity = Data.mUVDensity;
+
+    mVAO = GLVertexArray::Create();
+    glBindVertexArray(mVAO.Get());
+    mVBO = GLBuffer::Create();
+    glBindBuffer(GL_ARRAY_BUFFER, mVBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, VertexBytes, Data.mVertices, GL_STATIC_DRAW);
+    FrameStats::CountUploadBytes(VertexBytes);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_STRIDE * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
+
+    // NOTE: Merged meshes carry the submesh each vertex came from in a stream of its own, so the
+    // interleaved layout stays the same for every mesh
+    if (Data.mTransformIndices) {
+        unsigned TransformBytes = mVertexCount * sizeof(unsigned short);
+        mTransformBuffer = GLBuffer::Create();
+        glBindBuffer(GL_ARRAY_BUFFER, mTransformBuffer.Get());
+        glBufferData(GL_ARRAY_BUFFER, TransformBytes, Data.mTransformIndices, GL_STATIC_DRAW);
+        FrameStats::CountUploadBytes(TransformBytes);
+        glVertexAttribIPointer(TRANSFORM_INDEX_LOCATION, 1, GL_UNSIGNED_SHORT, sizeof(unsigned short), (void*)0);
+        glEnableVertexAttribArray(TRANSFORM_INDEX_LOCATION);
+        mTransformBuffer.Track(MEMORY_VERTEX_BUFFER, TransformBytes, mName);
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
     if (mIndexCount) {
-        glGenBuffers(1, &mEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mIndexCount * sizeof(float), mIndices.data(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        mEBO = GLBuffer::Create();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO.Get());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexBytes, Data.mEncoded.mData, GL_STATIC_DRAW);
+        FrameStats::CountUploadBytes(IndexBytes);
+        // NOTE: Stays bound while the VAO is, so the VAO keeps it for every later draw
+        mEBO.Track(MEMORY_INDEX_BUFFER, IndexBytes, mName);
     }
     glBindVertexArray(0);
-}
\ No newline at end of file
+
+    mVBO.Track(MEMORY_VERTEX_BUFFER, VertexBytes, mName);
+    keepResidentCopies(Data);
+}
+
+void
+Mesh::keepResidentCopies(const MeshImportData& data) {
+    // NOTE: One exactly sized allocation per copy. Accounted to the VAO handle, which is tracked
+    // under nothing else, so the copies are released from the report when the mesh goes away
+    if (mResidency == MESH_RESIDENCY_FULL) {
+        mVertices.assign(data.mVertices, data.mVertices + mVertexCount * VERTEX_STRIDE);
+    } else if (mResidency == MESH_RESIDENCY_POSITIONS) {
+        mPositions.resize(mVertexCount);
+        for (unsigned VertexIdx = 0; VertexIdx < mVertexCount; ++VertexIdx) {
+            const float* Position = data.mVertices + VertexIdx * VERTEX_STRIDE;
+            mPositions[VertexIdx] = glm::vec3(Position[0], Position[1], Position[2]);
+        }
+    }
+    if (mResidency != MESH_RESIDENCY_NONE) {
+        mIndices.assign(data.mIndices, data.mIndices + mIndexCount);
+        mVAO.Track(MEMORY_MESH_DATA, GetResidentBytes(), mName);
+    }
+}
@@ -15,22 +15,133 @@
 #include<vector>
 #include <GL/glew.h>
 #include <iostream>
+#include <glm/glm.hpp>
 #include "texture.hpp"
+#include "command_buffer.hpp"
+#include "linear_arena.hpp"
+#include "gl_handle.hpp"
+#include "index_encoding.hpp"
+#include "texture_packer.hpp"
+
+// NOTE: CPU half of a mesh import. Arrays point into the import arena and die with it
+struct MeshImportData {
+    float* mVertices;
+    unsigned mVertexCount;
+    unsigned* mIndices;
+    unsigned mIndexCount;
+    // NOTE: Source mesh of every vertex when several were merged into one, 0 for a single mesh
+    unsigned short* mTransformIndices;
+    unsigned mSubmeshCount;
+    // NOTE: Index buffer as uploaded, the triangle list above unless Prepare encoded it
+    EncodedIndices mEncoded;
+    glm::vec3 mBoundsMin;
+    glm::vec3 mBoundsMax;
+    // NOTE: UV units per object space unit, averaged over the triangle areas
+    float mUVDensity;
+};
+
+// NOTE: What a mesh keeps in system memory once its buffers are uploaded
+enum EMeshResidency {
+    // NOTE: Nothing, the GL buffers are the only copy
+    MESH_RESIDENCY_NONE = 0,
+    // NOTE: Positions and indices for CPU queries such as picking
+    MESH_RESIDENCY_POSITIONS = 1,
+    // NOTE: Interleaved vertices and indices as uploaded, for editing and re-uploading
+    MESH_RESIDENCY_FULL = 2,
+    MESH_RESIDENCY_COUNT = 3,
+};
+
+// NOTE: Textures a draw samples. Arrays index the model's texture packer, the block places both
+// textures inside them and the samplers are SamplerCache ids. Meshes with equal materials can be
+// merged even when their source materials differ
+struct MeshMaterial {
+    unsigned mDiffuseArray;
+    unsigned mSpecularArray;
+    unsigned mDiffuseSampler;
+    unsigned mSpecularSampler;
+    MaterialBlock mBlock;
+};
+
+// NOTE: Everything a mesh needs before it touches the GL, filled by Mesh::Prepare on any thread
+struct PreparedMesh {
+    std::string mName;
+    MeshImportData mGeometry;
+    MeshMaterial mMaterial;
+};
 
 class Mesh {
 public:
-    std::vector<unsigned> mIndices;
-    std::vector<float> mVertices;
+    // NOTE: Floats per interleaved vertex, position, normal and UV
+    static const unsigned VERTEX_STRIDE = 8;
+    // NOTE: Attribute holding the submesh index of merged meshes, for per submesh transforms
+    static const unsigned TRANSFORM_INDEX_LOCATION = 3;
+
+    // NOTE: Owner name used for memory accounting, model directory and mesh name
+    std::string mName;
 
     /**
-     * @brief Ctor - buffers mesh data
+     * @brief Ctor - buffers mesh data. Requires a current GL context
      *
-     * @param mesh - Assimp mesh
-     * @param MeshMaterial - Assimp material
-     * @param resPath - Resource relative path. For loading textures, etc...
+     * @param prepared - Output of Prepare. The geometry stays in its arena
+     * @param textures - Uploaded packer the material's arrays index, the mesh doesn't own them
+     * @param residency - CPU copies kept after the upload
      * 
      */
-    Mesh(const aiMesh* mesh, const aiMaterial* material, const std::string& resPath);
+    Mesh(PreparedMesh& prepared, const TexturePacker& textures, EMeshResidency residency);
+
+    // NOTE: Owns GL objects, moving hands them over, copying would delete them twice
+    Mesh(Mesh&& other) = default;
+    Mesh& operator=(Mesh&& other) = default;
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    /**
+     * @brief CPU half of loading a mesh, interleaves the geometry into the arena. Touches no GL,
+     * so meshes of one model can be prepared in parallel. Several meshes sharing the material
+     * are merged into one draw
+     *
+     * @param meshes Assimp meshes, all drawn with material
+     * @param meshCount Number of meshes, at most 65536 so the submesh index fits 16 bits
+     * @param uvRects Rect each mesh's UVs are remapped into, xy scale and zw offset
+     * @param material Packed textures of the draw
+     * @param resPath Resource relative path, names the mesh
+     * @param arena Import arena with at least GetImportSize bytes free, shared between threads
+     * @param encoding Index encodings the mesh may pick from
+     * @param prepared Receives the data the constructor uploads
+     *
+     * @returns true - Success, false - Geometry didn't fit the arena
+     */
+    static bool Prepare(const aiMesh* const* meshes, unsigned meshCount, const glm::vec4* uvRects, const MeshMaterial& material, const std::string& resPath, LinearArena& arena, EIndexEncoding encoding, PreparedMesh& prepared);
+
+    /**
+     * @brief Arena bytes Import and the index encoding need for a mesh, sized exactly from its vertex and face counts
+     *
+     * @param mesh Assimp mesh
+     * @param encoding Index encoding Prepare is given, LIST_32 sizes for Import alone
+     */
+    static unsigned GetImportSize(const aiMesh* mesh, EIndexEncoding encoding = INDEX_ENCODING_LIST_32);
+    static unsigned GetImportSize(const aiMesh* const* meshes, unsigned meshCount, EIndexEncoding encoding);
+
+    /**
+     * @brief Interleaves vertices and flattens faces into the arena and computes the bounds.
+     * Touches neither the GL nor the heap
+     *
+     * @param mesh Assimp mesh, triangulated
+     * @param arena Arena with at least GetImportSize bytes free
+     * @param data Receives the arrays and counts
+     *
+     * @returns true - Success, false - Arena too small
+     */
+    static bool Import(const aiMesh* mesh, LinearArena& arena, MeshImportData& data);
+
+    /**
+     * @brief Imports several meshes into one vertex and index range, the indices of each rebased
+     * past the vertices before it. Every mesh interleaves to the same layout, attributes it lacks
+     * are zero, so any meshes can be merged. Records the source mesh of every vertex
+     *
+     * @param uvRects Rect per mesh the UVs are remapped into, 0 keeps them as they are
+     */
+    static bool Import(const aiMesh* const* meshes, unsigned meshCount, LinearArena& arena, MeshImportData& data, const glm::vec4* uvRects = 0);
 
     /**
      * @brief Renders the current mesh
@@ -38,14 +149,106 @@ public:
      */
     void Render() const;
 
+    /**
+     * @brief Records the same binds and draw Render issues, without touching the GL
+     *
+     * @param commands Command buffer to record into
+     */
+    void Record(CommandBuffer& commands) const;
+
+    /**
+     * @brief Requests the texture levels the mesh samples at its size on screen. Thread safe
+     *
+     * @param textures Packer the mesh's arrays belong to
+     * @param pixelsPerUnit Screen pixels one object space unit covers
+     */
+    void RequestTextureLevels(TexturePacker& textures, float pixelsPerUnit) const;
+
+    const glm::vec3& GetBoundsMin() const;
+    const glm::vec3& GetBoundsMax() const;
+    EMeshResidency GetResidency() const;
+    unsigned GetVertexCount() const;
+    unsigned GetIndexCount() const;
+
+    /**
+     * @brief Source meshes merged into this one, 1 when nothing was merged
+     *
+     */
+    unsigned GetSubmeshCount() const;
+
+    /**
+     * @brief UV units per object space unit, 0 when the mesh has no UVs or no area
+     *
+     */
+    float GetUVDensity() const;
+
+    /**
+     * @brief Format of the uploaded index buffer, the resident indices are always a 32 bit triangle list
+     *
+     */
+    unsigned GetIndexType() const;
+    unsigned GetPrimitive() const;
+    unsigned GetIndexBytes() const;
+
+    /**
+     * @brief Interleaved vertices, VERTEX_STRIDE floats each. Empty unless the residency is full
+     *
+     */
+    const std::vector<float>& GetVertices() const;
+
+    /**
+     * @brief Vertex positions. Empty unless the residency keeps positions, full residency
+     * has them inside GetVertices instead
+     *
+     */
+    const std::vector<glm::vec3>& GetPositions() const;
+
+    /**
+     * @brief Triangle list indices. Empty when nothing is resident
+     *
+     */
+    const std::vector<unsigned>& GetIndices() const;
+
+    /**
+     * @brief Bytes of system memory held by the CPU copies
+     *
+     */
+    unsigned GetResidentBytes() const;
+
+    static const char* GetResidencyName(EMeshResidency residency);
+
 private:
-    unsigned mVAO;
-    unsigned mVBO;
-    unsigned mEBO;
+    EMeshResidency mResidency;
+    std::vector<float> mVertices;
+    std::vector<glm::vec3> mPositions;
+    std::vector<unsigned> mIndices;
+    GLVertexArray mVAO;
+    GLBuffer mVBO;
+    GLBuffer mEBO;
+    GLBuffer mTransformBuffer;
+    unsigned mSubmeshCount;
     unsigned mVertexCount;
     unsigned mIndexCount;
+    // NOTE: What the element buffer holds and how it is drawn
+    unsigned mDrawIndexCount;
+    unsigned mIndexType;
+    unsigned mPrimitive;
+    unsigned mTriangleCount;
+    // NOTE: Array textures owned by the model's packer
     unsigned mDiffuseTexture;
     unsigned mSpecularTexture;
-    unsigned loadMeshTexture(const aiMaterial* material, const std::string& resPath, aiTextureType type);
-    void processMesh(const aiMesh* mesh, const aiMaterial* material, const std::string& resPath);
+    // NOTE: GL sampler objects, resolved from the material's SamplerCache ids on upload
+    unsigned mDiffuseSampler;
+    unsigned mSpecularSampler;
+    MaterialBlock mMaterial;
+    unsigned mDiffuseArray;
+    unsigned mSpecularArray;
+    float mUVDensity;
+    // NOTE: Object space bounds of the vertex positions
+    glm::vec3 mBoundsMin;
+    glm::vec3 mBoundsMax;
+    void upload(PreparedMesh& prepared, const TexturePacker& textures);
+    void keepResidentCopies(const MeshImportData& data);
+    static void interleaveVertices(const aiMesh* mesh, const glm::vec4& uvRect, float* out, float* min, float* max);
+    static float getUVDensity(const float* vertices, const unsigned* indices, unsigned indexCount);
 };
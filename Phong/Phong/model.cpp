@@ -1,12 +1,303 @@
 #include "model.hpp"
+#include "profiler.hpp"
+#include "memory_tracker.hpp"
+#include "texture_streamer.hpp"
+#include <chrono>
+#include <thread>
+#include <cstring>
 
-Model::Model(std::string filename) {
+static double
+SecondsNow() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool
+GetTexturePath(const aiMaterial* material, aiTextureType type, const std::string& directory, std::string& path) {
+    aiString Path;
+    if (!material || !material->GetTextureCount(type) || material->GetTexture(type, 0, &Path, NULL, NULL, NULL, NULL, NULL) != AI_SUCCESS) {
+        return false;
+    }
+    path = directory + "/" + Path.data;
+    return true;
+}
+
+// NOTE: Textures sampled outside [0, 1] wrap, which an atlas rect can't
+static bool
+SamplesOutsideUnit(const aiMesh* mesh) {
+    if (!mesh->HasTextureCoords(0)) {
+        return false;
+    }
+
+    for (unsigned VertexIdx = 0; VertexIdx < mesh->mNumVertices; ++VertexIdx) {
+        const aiVector3D& UV = mesh->mTextureCoords[0][VertexIdx];
+        if (UV.x < 0.0f || UV.x > 1.0f || UV.y < 0.0f || UV.y > 1.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool
+SameMaterial(const MeshMaterial& a, const MeshMaterial& b) {
+    return a.mDiffuseArray == b.mDiffuseArray && a.mSpecularArray == b.mSpecularArray && a.mDiffuseSampler == b.mDiffuseSampler
+        && a.mSpecularSampler == b.mSpecularSampler && !memcmp(&a.mBlock, &b.mBlock, sizeof(MaterialBlock));
+}
+
+Model::Model(std::string filename) : mState(MODEL_UNLOADED), mCancelled(false) {
     mFilename = filename;
     mDirectory = filename.substr(0, filename.find_last_of('/'));
+    mUploadedCount = 0;
+    mLoadStartTime = 0.0;
+    mResidency = MESH_RESIDENCY_NONE;
+    mIndexEncoding = INDEX_ENCODING_AUTO;
+    mMergeByMaterial = false;
+    mSourceMeshCount = 0;
+}
+
+Model::~Model() {
+    CancelStreaming();
+}
+
+Model::Model(Model&& other) : mState(MODEL_UNLOADED), mCancelled(false) {
+    mUploadedCount = 0;
+    mLoadStartTime = 0.0;
+    mResidency = MESH_RESIDENCY_NONE;
+    mIndexEncoding = INDEX_ENCODING_AUTO;
+    mMergeByMaterial = false;
+    mSourceMeshCount = 0;
+    *this = std::move(other);
+}
+
+Model&
+Model::operator=(Model&& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // NOTE: A worker still decoding holds a pointer to the source, so it has to finish first
+    CancelStreaming();
+    other.waitForDecode();
+    mMeshes = std::move(other.mMeshes);
+    mPrepared = std::move(other.mPrepared);
+    mArena = std::move(other.mArena);
+    mTextures = std::move(other.mTextures);
+    if (mArena.GetCapacity()) {
+        MemoryTracker::Untrack(MEMORY_STAGING, (unsigned long long)&other.mArena);
+        MemoryTracker::Track(MEMORY_STAGING, (unsigned long long)&mArena, mArena.GetCapacity(), other.mFilename);
+    }
+    mUploadedCount = other.mUploadedCount;
+    mLoadStartTime = other.mLoadStartTime;
+    mResidency = other.mResidency;
+    mIndexEncoding = other.mIndexEncoding;
+    mMergeByMaterial = other.mMergeByMaterial;
+    mSourceMeshCount = other.mSourceMeshCount;
+    mFilename = std::move(other.mFilename);
+    mDirectory = std::move(other.mDirectory);
+    mState.store(other.mState.load(std::memory_order_acquire), std::memory_order_release);
+    mCancelled = false;
+    other.mUploadedCount = 0;
+    other.mState = MODEL_UNLOADED;
+    return *this;
+}
+
+bool
+Model::Load(JobSystem* jobs) {
+    PROFILE_FUNCTION();
+    mLoadStartTime = SecondsNow();
+    mState = MODEL_DECODING;
+    if (!decode(jobs)) {
+        mState = MODEL_FAILED;
+        return false;
+    }
+
+    mState = MODEL_UPLOADING;
+    uploadPrepared(1e30);
+    return true;
+}
+
+bool
+Model::LoadAsync(JobSystem* jobs) {
+    if (!jobs || jobs->GetThreadCount() < 2) {
+        return Load(jobs);
+    }
+
+    mLoadStartTime = SecondsNow();
+    mCancelled = false;
+    mState = MODEL_QUEUED;
+    Model* Self = this;
+    jobs->RunBackground(loadJob, &Self, sizeof(Self), 0);
+    return true;
+}
+
+void
+Model::UpdateStreaming(double budget) {
+    if (mState.load(std::memory_order_acquire) == MODEL_UPLOADING) {
+        uploadPrepared(budget);
+    }
 }
 
 bool
-Model::Load() {
+Model::FinishStreaming() {
+    waitForDecode();
+    UpdateStreaming(1e30);
+    return mState.load(std::memory_order_acquire) == MODEL_READY;
+}
+
+void
+Model::CancelStreaming() {
+    mCancelled = true;
+    waitForDecode();
+    if (mState.load(std::memory_order_acquire) == MODEL_UPLOADING) {
+        releasePrepared();
+        // NOTE: The failed model draws nothing, so the meshes already uploaded can lose their textures
+        mTextures.Destroy();
+        mState = MODEL_FAILED;
+    }
+}
+
+void
+Model::Unload() {
+    CancelStreaming();
+    // NOTE: Swapped out so the mesh array itself is freed along with the meshes' GL objects
+    std::vector<Mesh>().swap(mMeshes);
+    mTextures.Destroy();
+    mState = MODEL_UNLOADED;
+}
+
+void
+Model::waitForDecode() const {
+    while (mState.load(std::memory_order_acquire) == MODEL_QUEUED || mState.load(std::memory_order_acquire) == MODEL_DECODING) {
+        std::this_thread::yield();
+    }
+}
+
+void
+Model::SetResidency(EMeshResidency residency) {
+    if (mState.load(std::memory_order_acquire) != MODEL_UNLOADED) {
+        std::cerr << "[Warn] Residency of " << mFilename << " changed after loading started, applies to meshes uploaded from now on" << std::endl;
+    }
+    mResidency = residency;
+}
+
+EMeshResidency
+Model::GetResidency() const {
+    return mResidency;
+}
+
+void
+Model::SetIndexEncoding(EIndexEncoding encoding) {
+    if (mState.load(std::memory_order_acquire) != MODEL_UNLOADED) {
+        std::cerr << "[Warn] Index encoding of " << mFilename << " changed after loading started, applies to the next load" << std::endl;
+    }
+    mIndexEncoding = encoding;
+}
+
+EIndexEncoding
+Model::GetIndexEncoding() const {
+    return mIndexEncoding;
+}
+
+void
+Model::SetMergeByMaterial(bool merge) {
+    if (mState.load(std::memory_order_acquire) != MODEL_UNLOADED) {
+        std::cerr << "[Warn] Mesh merging of " << mFilename << " changed after loading started, applies to the next load" << std::endl;
+    }
+    mMergeByMaterial = merge;
+}
+
+bool
+Model::GetMergeByMaterial() const {
+    return mMergeByMaterial;
+}
+
+unsigned
+Model::GetDrawCount() const {
+    return mMeshes.size();
+}
+
+unsigned
+Model::GetSourceMeshCount() const {
+    return mSourceMeshCount;
+}
+
+const TexturePacker&
+Model::GetTextures() const {
+    return mTextures;
+}
+
+TexturePacker&
+Model::GetTextures() {
+    return mTextures;
+}
+
+void
+Model::GroupMeshes(const aiScene* scene, bool mergeByMaterial, const unsigned* materialKeys, std::vector<std::vector<const aiMesh*> >& groups) {
+    groups.clear();
+    // NOTE: Group of each material, in order of first use so merged models draw in file order
+    std::vector<unsigned> MaterialGroups(mergeByMaterial ? scene->mNumMaterials : 0, INVALID_MATERIAL);
+    for (unsigned MeshIdx = 0; MeshIdx < scene->mNumMeshes; ++MeshIdx) {
+        const aiMesh* Current = scene->mMeshes[MeshIdx];
+        unsigned Material = Current->mMaterialIndex;
+        if (materialKeys && Material < scene->mNumMaterials) {
+            Material = materialKeys[Material];
+        }
+        // NOTE: The submesh index is 16 bit, a full group starts a new one
+        if (!mergeByMaterial || Material >= MaterialGroups.size() || MaterialGroups[Material] == INVALID_MATERIAL
+            || groups[MaterialGroups[Material]].size() > 0xFFFF) {
+            if (Material < MaterialGroups.size()) {
+                MaterialGroups[Material] = groups.size();
+            }
+            groups.push_back(std::vector<const aiMesh*>());
+            groups.back().push_back(Current);
+            continue;
+        }
+
+        groups[MaterialGroups[Material]].push_back(Current);
+    }
+}
+
+unsigned
+Model::GetIndexBytes() const {
+    unsigned Bytes = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < mMeshes.size(); ++MeshIdx) {
+        Bytes += mMeshes[MeshIdx].GetIndexBytes();
+    }
+    return Bytes;
+}
+
+unsigned
+Model::GetResidentBytes() const {
+    unsigned Bytes = 0;
+    for (unsigned MeshIdx = 0; MeshIdx < mMeshes.size(); ++MeshIdx) {
+        Bytes += mMeshes[MeshIdx].GetResidentBytes();
+    }
+    return Bytes;
+}
+
+EModelState
+Model::GetState() const {
+    return (EModelState)mState.load(std::memory_order_acquire);
+}
+
+void
+Model::loadJob(void* data) {
+    Model* Self = 0;
+    memcpy(&Self, data, sizeof(Self));
+    if (Self->mCancelled) {
+        Self->mState.store(MODEL_FAILED, std::memory_order_release);
+        return;
+    }
+
+    Self->mState.store(MODEL_DECODING, std::memory_order_release);
+    // NOTE: Meshes are prepared serially here. Splitting them into jobs would let a thread waiting
+    // on frame work steal them and stall its frame, which is what streaming is meant to avoid
+    bool Decoded = Self->decode(0);
+    Self->mState.store(Decoded ? MODEL_UPLOADING : MODEL_FAILED, std::memory_order_release);
+}
+
+bool
+Model::decode(JobSystem* jobs) {
+    PROFILE_FUNCTION();
     Assimp::Importer Importer;
     const aiScene *Scene = Importer.ReadFile(mFilename, POSTPROCESS_FLAGS);
 
@@ -14,21 +305,236 @@ Model::Load() {
         std::cerr << "[Err] Failed to load model:" << std::endl << Importer.GetErrorString() << std::endl;
         return false;
     }
-    mMeshes.reserve(Scene->mNumMeshes);
-    for(unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
-        aiMesh* CurrAIMesh = Scene->mMeshes[MeshIdx];
-        Mesh CurrMesh(CurrAIMesh, Scene->mMaterials[CurrAIMesh->mMaterialIndex], mDirectory);
-        mMeshes.push_back(CurrMesh);
 
+    std::vector<MeshMaterial> Materials;
+    std::vector<glm::vec4> UVRects;
+    std::vector<unsigned> MaterialKeys;
+    packTextures(Scene, jobs, Materials, UVRects, MaterialKeys);
+
+    // NOTE: One arena sized for every mesh of the file stages the interleaved data until it is
+    // uploaded, then goes away in a single free
+    std::vector<std::vector<const aiMesh*> > Groups;
+    GroupMeshes(Scene, mMergeByMaterial, MaterialKeys.data(), Groups);
+    mSourceMeshCount = Scene->mNumMeshes;
+    unsigned ArenaSize = 0;
+    for (unsigned GroupIdx = 0; GroupIdx < Groups.size(); ++GroupIdx) {
+        ArenaSize += Mesh::GetImportSize(Groups[GroupIdx].data(), Groups[GroupIdx].size(), mIndexEncoding);
+    }
+    if (!mArena.Init(ArenaSize)) {
+        return false;
+    }
+    MemoryTracker::Track(MEMORY_STAGING, (unsigned long long)&mArena, mArena.GetCapacity(), mFilename);
+
+    // NOTE: One task per group interleaves geometry, anything touching the GL waits for the upload
+    // on the thread owning the context
+    mPrepared.resize(Groups.size());
+    std::atomic<unsigned> FailedCount(0);
+    auto PrepareMeshes = [&](unsigned begin, unsigned end) {
+        for (unsigned GroupIdx = begin; GroupIdx < end; ++GroupIdx) {
+            const std::vector<const aiMesh*>& Group = Groups[GroupIdx];
+            std::vector<glm::vec4> GroupRects(Group.size());
+            for (unsigned MeshIdx = 0; MeshIdx < Group.size(); ++MeshIdx) {
+                GroupRects[MeshIdx] = UVRects[Group[MeshIdx]->mMaterialIndex];
+            }
+            const MeshMaterial& Material = Materials[Group[0]->mMaterialIndex];
+            if (!Mesh::Prepare(Group.data(), Group.size(), GroupRects.data(), Material, mDirectory, mArena, mIndexEncoding, mPrepared[GroupIdx])) {
+                ++FailedCount;
+            }
+        }
+    };
+    if (jobs) {
+        jobs->ParallelFor(Groups.size(), 1, PrepareMeshes);
+    } else {
+        PrepareMeshes(0, Groups.size());
+    }
+    if (FailedCount) {
+        std::cerr << "[Warn] " << FailedCount << " meshes of " << mFilename << " failed to import and stay empty" << std::endl;
     }
-    std::cout << mFilename << " Loaded " << mMeshes.size() << " meshes" << std::endl;
+
+    mUploadedCount = 0;
+    mMeshes.reserve(Groups.size());
     return true;
 }
 
+void
+Model::packTextures(const aiScene* scene, JobSystem* jobs, std::vector<MeshMaterial>& materials, std::vector<glm::vec4>& uvRects, std::vector<unsigned>& keys) {
+    PROFILE_FUNCTION();
+    static const aiTextureType SLOT_TYPES[2] = { aiTextureType_DIFFUSE, aiTextureType_SPECULAR };
+    unsigned MaterialCount = scene->mNumMaterials;
+    std::vector<unsigned char> MaterialRepeats(MaterialCount, 0);
+    for (unsigned MeshIdx = 0; MeshIdx < scene->mNumMeshes; ++MeshIdx) {
+        const aiMesh* Current = scene->mMeshes[MeshIdx];
+        if (Current->mMaterialIndex < MaterialCount && SamplesOutsideUnit(Current)) {
+            MaterialRepeats[Current->mMaterialIndex] = 1;
+        }
+    }
+
+    // NOTE: Each file decodes once however many materials use it, and repeats if any of them does
+    std::vector<std::string> Paths;
+    std::vector<unsigned char> PathRepeats;
+    std::vector<unsigned> MaterialPaths(MaterialCount * 2, INVALID_MATERIAL);
+    for (unsigned MaterialIdx = 0; MaterialIdx < MaterialCount; ++MaterialIdx) {
+        for (unsigned Slot = 0; Slot < 2; ++Slot) {
+            std::string Path;
+            if (!GetTexturePath(scene->mMaterials[MaterialIdx], SLOT_TYPES[Slot], mDirectory, Path)) {
+                continue;
+            }
+
+            unsigned PathIdx = std::find(Paths.begin(), Paths.end(), Path) - Paths.begin();
+            if (PathIdx == Paths.size()) {
+                Paths.push_back(Path);
+                PathRepeats.push_back(0);
+            }
+            PathRepeats[PathIdx] |= MaterialRepeats[MaterialIdx];
+            MaterialPaths[MaterialIdx * 2 + Slot] = PathIdx;
+        }
+    }
+
+    std::vector<TextureImage> Images(Paths.size());
+    auto DecodeImages = [&Paths, &Images](unsigned begin, unsigned end) {
+        for (unsigned PathIdx = begin; PathIdx < end; ++PathIdx) {
+            Texture::DecodeImage(Paths[PathIdx], Images[PathIdx]);
+        }
+    };
+    if (jobs) {
+        jobs->ParallelFor(Paths.size(), 1, DecodeImages);
+    } else {
+        DecodeImages(0, Paths.size());
+    }
+
+    // NOTE: Empty slots read a single texel, white diffuse and no specular highlight
+    mTextures.Destroy();
+    unsigned White = mTextures.AddColor(255, 255, 255);
+    unsigned Black = mTextures.AddColor(0, 0, 0);
+    std::vector<unsigned> PathSlots(Paths.size());
+    for (unsigned PathIdx = 0; PathIdx < Paths.size(); ++PathIdx) {
+        PathSlots[PathIdx] = Images[PathIdx].mData ? mTextures.Add(Images[PathIdx], PathRepeats[PathIdx]) : White;
+    }
+    mTextures.Pack();
+    for (unsigned PathIdx = 0; PathIdx < Paths.size(); ++PathIdx) {
+        Texture::FreeImage(Images[PathIdx]);
+    }
+
+    materials.resize(MaterialCount);
+    uvRects.resize(MaterialCount);
+    keys.resize(MaterialCount);
+    for (unsigned MaterialIdx = 0; MaterialIdx < MaterialCount; ++MaterialIdx) {
+        unsigned DiffusePath = MaterialPaths[MaterialIdx * 2];
+        unsigned SpecularPath = MaterialPaths[MaterialIdx * 2 + 1];
+        unsigned Diffuse = DiffusePath != INVALID_MATERIAL ? PathSlots[DiffusePath] : White;
+        unsigned Specular = SpecularPath != INVALID_MATERIAL ? PathSlots[SpecularPath] : Black;
+        const TextureSlot& DiffuseSlot = mTextures.GetSlot(Diffuse);
+        MeshMaterial& Material = materials[MaterialIdx];
+        Material.mDiffuseArray = DiffuseSlot.mArray;
+        Material.mSpecularArray = mTextures.GetSlot(Specular).mArray;
+        Material.mDiffuseSampler = mTextures.GetSampler(Material.mDiffuseArray);
+        Material.mSpecularSampler = mTextures.GetSampler(Material.mSpecularArray);
+        Material.mBlock = mTextures.MakeMaterial(Diffuse, Specular);
+        uvRects[MaterialIdx] = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+
+        // NOTE: The diffuse atlas rect is baked into the UVs at import, which leaves materials on
+        // one atlas page differing only by their specular rect, a constant for untextured slots
+        if (DiffuseSlot.mRect.x > 0.0f && DiffuseSlot.mRect.x < 1.0f) {
+            uvRects[MaterialIdx] = DiffuseSlot.mRect;
+            Material.mBlock.DiffuseRect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+            Material.mBlock.SpecularRect = TexturePacker::RebaseRect(Material.mBlock.SpecularRect, DiffuseSlot.mRect);
+        }
+
+        keys[MaterialIdx] = MaterialIdx;
+        for (unsigned OtherIdx = 0; OtherIdx < MaterialIdx; ++OtherIdx) {
+            if (keys[OtherIdx] == OtherIdx && SameMaterial(materials[OtherIdx], Material)) {
+                keys[MaterialIdx] = OtherIdx;
+                break;
+            }
+        }
+    }
+}
+
+void
+Model::uploadPrepared(double budget) {
+    PROFILE_FUNCTION();
+    double Start = SecondsNow();
+    // NOTE: The shared arrays go up with the first mesh, every mesh binds them
+    if (!mUploadedCount) {
+        mTextures.Upload();
+    }
+    // NOTE: Whole meshes are the unit of work, a single large mesh can overrun the budget
+    do {
+        if (mUploadedCount == mPrepared.size()) {
+            break;
+        }
+        mMeshes.emplace_back(mPrepared[mUploadedCount++], mTextures, mResidency);
+    } while (SecondsNow() - Start < budget);
+
+    if (mUploadedCount < mPrepared.size()) {
+        return;
+    }
+
+    releasePrepared();
+    mState.store(MODEL_READY, std::memory_order_release);
+    std::cout << mFilename << " Loaded " << mSourceMeshCount << " meshes as " << mMeshes.size() << " draws in " << (SecondsNow() - mLoadStartTime) * 1000.0
+        << " ms, CPU copies: " << Mesh::GetResidencyName(mResidency) << ", " << GetResidentBytes() / 1024 << " KB, indices: "
+        << IndexEncoding::GetEncodingName(mIndexEncoding) << ", " << GetIndexBytes() / 1024 << " KB, textures: " << mTextures.GetTextureCount()
+        << " in " << mTextures.GetArrayCount() << " arrays, " << mTextures.GetAtlasTextureCount() << " atlased" << std::endl;
+}
+
+void
+Model::releasePrepared() {
+    // NOTE: Swapped out so the vector's storage is freed too, not just its elements
+    std::vector<PreparedMesh>().swap(mPrepared);
+    mUploadedCount = 0;
+    MemoryTracker::Untrack(MEMORY_STAGING, (unsigned long long)&mArena);
+    mArena.Release();
+}
+
 void
 Model::Render() {
+    if (GetState() != MODEL_READY) {
+        return;
+    }
+
     for(unsigned MeshIdx = 0; MeshIdx < mMeshes.size(); ++MeshIdx) {
         Mesh &Mesh = mMeshes[MeshIdx];
         mMeshes[MeshIdx].Render();
     }
 }
+
+void
+Model::Record(CommandBuffer& commands) const {
+    if (GetState() != MODEL_READY) {
+        return;
+    }
+
+    for (unsigned MeshIdx = 0; MeshIdx < mMeshes.size(); ++MeshIdx) {
+        mMeshes[MeshIdx].Record(commands);
+    }
+}
+
+void
+Model::RequestTextureLevels(const glm::mat4& model, const glm::vec3& camera, float pixelScale) {
+    if (GetState() != MODEL_READY) {
+        return;
+    }
+
+    for (unsigned MeshIdx = 0; MeshIdx < mMeshes.size(); ++MeshIdx) {
+        const Mesh& Current = mMeshes[MeshIdx];
+        glm::vec3 Center = (Current.GetBoundsMin() + Current.GetBoundsMax()) * 0.5f;
+        float Radius = glm::length(Current.GetBoundsMax() - Current.GetBoundsMin()) * 0.5f;
+        Current.RequestTextureLevels(mTextures, TextureStreamer::GetPixelsPerUnit(model, Center, Radius, camera, pixelScale));
+    }
+}
+
+bool
+Model::GetBounds(glm::vec3& min, glm::vec3& max) const {
+    if (mMeshes.empty() || GetState() != MODEL_READY) {
+        return false;
+    }
+
+    min = mMeshes[0].GetBoundsMin();
+    max = mMeshes[0].GetBoundsMax();
+    for (unsigned MeshIdx = 1; MeshIdx < mMeshes.size(); ++MeshIdx) {
+        min = glm::min(min, mMeshes[MeshIdx].GetBoundsMin());
+        max = glm::max(max, mMeshes[MeshIdx].GetBoundsMax());
+    }
+    return true;
+}
@@ -9,18 +9,21 @@
  *
  */
 
-#ifndef MESH_H
+#ifndef MODEL_HPP
+#define MODEL_HPP
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <algorithm>
 #include <vector>
+#include <atomic>
 #include <iostream>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.hpp"
 #include "mesh.hpp"
+#include "jobs.hpp"
 
 #define POSITION_LOCATION 0
 #define NORMAL_LOCATION 1
@@ -38,9 +41,45 @@ enum EBufferType {
     BUFFER_COUNT = 4,
 };
 
+enum EModelState {
+    MODEL_UNLOADED = 0,
+    // NOTE: Waiting for a worker to pick up the load
+    MODEL_QUEUED = 1,
+    // NOTE: Reading the file, interleaving meshes and decoding textures on a worker
+    MODEL_DECODING = 2,
+    // NOTE: Decoded, meshes are being uploaded a few per frame on the GL thread
+    MODEL_UPLOADING = 3,
+    MODEL_READY = 4,
+    MODEL_FAILED = 5,
+};
+
 class Model {
 private:
     std::vector<Mesh> mMeshes;
+    std::atomic<int> mState;
+    std::atomic<bool> mCancelled;
+    // NOTE: Decoded meshes waiting for upload and the arena their geometry lives in. Written by the
+    // loading job before it publishes MODEL_UPLOADING, only touched by the GL thread afterwards
+    std::vector<PreparedMesh> mPrepared;
+    LinearArena mArena;
+    unsigned mUploadedCount;
+    double mLoadStartTime;
+    EMeshResidency mResidency;
+    EIndexEncoding mIndexEncoding;
+    bool mMergeByMaterial;
+    // NOTE: Meshes in the file, more than mMeshes holds when they were merged
+    unsigned mSourceMeshCount;
+
+    // NOTE: Every texture of the model, packed into arrays the meshes share
+    TexturePacker mTextures;
+
+    bool decode(JobSystem* jobs);
+    void packTextures(const aiScene* scene, JobSystem* jobs, std::vector<MeshMaterial>& materials, std::vector<glm::vec4>& uvRects, std::vector<unsigned>& keys);
+    void waitForDecode() const;
+    void uploadPrepared(double budget);
+    void releasePrepared();
+
+    static void loadJob(void* data);
 
 public:
     std::string mFilename;
@@ -53,13 +92,131 @@ public:
      *
      */
     Model(std::string filename);
+    ~Model();
+
+    // NOTE: Move-only, the meshes own GL objects. Moving waits for a background load to let go of the source
+    Model(Model&& other);
+    Model& operator=(Model&& other);
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
 
     /**
-     * @brief Loads all the meshes and model data
+     * @brief Loads all the meshes and model data. Meshes are prepared in parallel, GL objects
+     * are created on the calling thread, which must own the context
+     *
+     * @param jobs Job system preparing one mesh per task, 0 prepares them serially
      *
      * @returns true - Success, false - Failure
      */
-    bool Load();
+    bool Load(JobSystem* jobs);
+
+    /**
+     * @brief Starts loading on a background worker and returns immediately. Decoded meshes are
+     * uploaded by UpdateStreaming, the model draws nothing until it is ready. Falls back to Load
+     * when there is no worker to run it
+     *
+     * @param jobs Job system with at least one worker thread
+     *
+     * @returns true - Load started or finished, false - Synchronous fallback failed
+     */
+    bool LoadAsync(JobSystem* jobs);
+
+    /**
+     * @brief Uploads decoded meshes until the budget is spent, at least one per call. Must run on
+     * the thread owning the GL context, once per frame while the model streams in
+     *
+     * @param budget Seconds of upload work allowed
+     */
+    void UpdateStreaming(double budget);
+
+    /**
+     * @brief Blocks until the background load is done and uploads everything left
+     *
+     * @returns true - Model is ready, false - Loading failed
+     */
+    bool FinishStreaming();
+
+    /**
+     * @brief Stops a background load and waits for its worker to let go of the model,
+     * dropping anything decoded but not uploaded yet
+     *
+     */
+    void CancelStreaming();
+
+    /**
+     * @brief Cancels any load and deletes every mesh with its GL objects right away.
+     * Must run on the thread owning the GL context, the model can be loaded again afterwards
+     *
+     */
+    void Unload();
+
+    EModelState GetState() const;
+
+    /**
+     * @brief Picks what the meshes keep in system memory after upload. Set before loading,
+     * the default drops all CPU copies
+     *
+     * @param residency Residency policy of every mesh in the model
+     */
+    void SetResidency(EMeshResidency residency);
+    EMeshResidency GetResidency() const;
+
+    /**
+     * @brief Picks the index formats meshes may use. Set before loading, the default lets every
+     * mesh take the smallest of 16 bit, 32 bit, list and strips
+     *
+     * @param encoding Index encoding of every mesh in the model
+     */
+    void SetIndexEncoding(EIndexEncoding encoding);
+    EIndexEncoding GetIndexEncoding() const;
+
+    /**
+     * @brief Bytes of index buffer memory of all uploaded meshes
+     *
+     */
+    unsigned GetIndexBytes() const;
+
+    /**
+     * @brief Merges all meshes sharing a material into one draw when loading. Materials whose
+     * textures were packed into the same array layers count as one. Off by default,
+     * the meshes keep no transforms of their own yet, so merging never changes the result
+     *
+     * @param merge Whether to merge
+     */
+    void SetMergeByMaterial(bool merge);
+    bool GetMergeByMaterial() const;
+
+    /**
+     * @brief Draws one render of the model issues, against the meshes in the file
+     *
+     */
+    unsigned GetDrawCount() const;
+    unsigned GetSourceMeshCount() const;
+    const TexturePacker& GetTextures() const;
+
+    /**
+     * @brief Packer the meshes sample, for the texture streamer to change what is resident. The
+     * loading job fills it while decoding, so only touch it once the state is MODEL_UPLOADING or MODEL_READY
+     *
+     */
+    TexturePacker& GetTextures();
+
+    /**
+     * @brief Splits the meshes of a scene into the groups loaded as one mesh each, in file order
+     *
+     * @param scene Assimp scene
+     * @param mergeByMaterial false gives one group per mesh
+     * @param materialKeys Key of each material, meshes whose materials share a key are merged.
+     * 0 merges meshes of the same material only
+     * @param groups Receives the groups
+     */
+    static void GroupMeshes(const aiScene* scene, bool mergeByMaterial, const unsigned* materialKeys, std::vector<std::vector<const aiMesh*> >& groups);
+
+    /**
+     * @brief Bytes of system memory held by the CPU copies of all uploaded meshes
+     *
+     */
+    unsigned GetResidentBytes() const;
 
     /**
      * @brief Renderable Render implementation
@@ -67,7 +224,32 @@ public:
      */
     void Render();
 
+    /**
+     * @brief Records all meshes into a command buffer, nothing until the model is ready
+     *
+     * @param commands Command buffer to record into
+     */
+    void Record(CommandBuffer& commands) const;
+
+    /**
+     * @brief Requests the texture levels each mesh samples at its distance from the camera,
+     * nothing until the model is ready. Thread safe against other requests
+     *
+     * @param model Model matrix the meshes are drawn with
+     * @param camera World space camera position
+     * @param pixelScale TextureStreamer::GetPixelScale of the frame
+     */
+    void RequestTextureLevels(const glm::mat4& model, const glm::vec3& camera, float pixelScale);
+
+    /**
+     * @brief Object space bounds enclosing every mesh
+     *
+     * @param min Smallest corner
+     * @param max Largest corner
+     *
+     * @returns true - Bounds written, false - Model has no meshes or isn't ready
+     */
+    bool GetBounds(glm::vec3& min, glm::vec3& max) const;
 };
 
-#define MESH_HP
 #endif
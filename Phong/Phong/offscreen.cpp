@@ -0,0 +1,268 @@
+#include "offscreen.hpp"
+#include "memory_tracker.hpp"
+#include <iostream>
+#include <fstream>
+
+OffscreenContext::OffscreenContext() {
+#if defined(PHONG_USE_EGL)
+    mDisplay = EGL_NO_DISPLAY;
+    mContext = EGL_NO_CONTEXT;
+#elif defined(PHONG_USE_OSMESA)
+    mContext = 0;
+#else
+    mWindow = 0;
+#endif
+}
+
+OffscreenContext::~OffscreenContext() {
+    Destroy();
+}
+
+#if defined(PHONG_USE_EGL)
+
+bool
+OffscreenContext::Create() {
+    // NOTE: The surfaceless platform needs no display server at all, Mesa's llvmpipe supports it
+    PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (GetPlatformDisplay) {
+        mDisplay = GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+    }
+    if (mDisplay == EGL_NO_DISPLAY) {
+        mDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint Major = 0;
+    EGLint Minor = 0;
+    if (mDisplay == EGL_NO_DISPLAY || !eglInitialize(mDisplay, &Major, &Minor)) {
+        std::cerr << "[Err] Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "[Err] EGL has no desktop OpenGL support" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint ConfigAttributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig Config = 0;
+    EGLint ConfigCount = 0;
+    if (!eglChooseConfig(mDisplay, ConfigAttributes, &Config, 1, &ConfigCount) || !ConfigCount) {
+        std::cerr << "[Err] No EGL config supports OpenGL" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint ContextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    mContext = eglCreateContext(mDisplay, Config, EGL_NO_CONTEXT, ContextAttributes);
+    if (mContext == EGL_NO_CONTEXT || !eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, mContext)) {
+        std::cerr << "[Err] Failed to create a surfaceless GL 3.3 core context" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void
+OffscreenContext::Destroy() {
+    if (mDisplay == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (mContext != EGL_NO_CONTEXT) {
+        eglDestroyContext(mDisplay, mContext);
+    }
+    eglTerminate(mDisplay);
+    mContext = EGL_NO_CONTEXT;
+    mDisplay = EGL_NO_DISPLAY;
+}
+
+const char*
+OffscreenContext::GetBackendName() const {
+    return "EGL";
+}
+
+#elif defined(PHONG_USE_OSMESA)
+
+bool
+OffscreenContext::Create() {
+    const int Attributes[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 24,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    mContext = OSMesaCreateContextAttribs(Attributes, 0);
+    if (!mContext) {
+        std::cerr << "[Err] Failed to create a GL 3.3 core OSMesa context" << std::endl;
+        return false;
+    }
+
+    mDummyBuffer.resize(4);
+    if (!OSMesaMakeCurrent(mContext, mDummyBuffer.data(), GL_UNSIGNED_BYTE, 1, 1)) {
+        std::cerr << "[Err] Failed to make the OSMesa context current" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void
+OffscreenContext::Destroy() {
+    if (mContext) {
+        OSMesaDestroyContext(mContext);
+        mContext = 0;
+    }
+}
+
+const char*
+OffscreenContext::GetBackendName() const {
+    return "OSMesa";
+}
+
+#else
+
+bool
+OffscreenContext::Create() {
+    if (!glfwInit()) {
+        std::cerr << "[Err] Failed to init glfw" << std::endl;
+        return false;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    mWindow = glfwCreateWindow(1, 1, "Phong (headless)", 0, 0);
+    if (!mWindow) {
+        std::cerr << "[Err] Failed to create hidden window, build with PHONG_USE_EGL or PHONG_USE_OSMESA on display-less machines" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(mWindow);
+    return true;
+}
+
+void
+OffscreenContext::Destroy() {
+    if (mWindow) {
+        glfwDestroyWindow(mWindow);
+        glfwTerminate();
+        mWindow = 0;
+    }
+}
+
+const char*
+OffscreenContext::GetBackendName() const {
+    return "GLFW";
+}
+
+#endif
+
+OffscreenTarget::OffscreenTarget() {
+    mFBO = 0;
+    mColorRBO = 0;
+    mDepthRBO = 0;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+OffscreenTarget::~OffscreenTarget() {
+    Destroy();
+}
+
+bool
+OffscreenTarget::Init(int width, int height) {
+    Destroy();
+    mWidth = width;
+    mHeight = height;
+
+    glGenRenderbuffers(1, &mColorRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, mColorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &mDepthRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, mDepthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &mFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mColorRBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, mDepthRBO);
+    GLenum Status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (Status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "[Err] Offscreen framebuffer " << width << "x" << height << " incomplete: 0x" << std::hex << Status << std::dec << std::endl;
+        Destroy();
+        return false;
+    }
+
+    MemoryTracker::Track(MEMORY_RENDER_TARGET, mColorRBO, MemoryTracker::TextureBytes(width, height, 4, false), "Offscreen target");
+    MemoryTracker::Track(MEMORY_RENDER_TARGET, mDepthRBO, MemoryTracker::TextureBytes(width, height, 4, false), "Offscreen target");
+    return true;
+}
+
+void
+OffscreenTarget::Destroy() {
+    if (mFBO) {
+        glDeleteFramebuffers(1, &mFBO);
+    }
+    if (mColorRBO) {
+        MemoryTracker::Untrack(MEMORY_RENDER_TARGET, mColorRBO);
+        glDeleteRenderbuffers(1, &mColorRBO);
+    }
+    if (mDepthRBO) {
+        MemoryTracker::Untrack(MEMORY_RENDER_TARGET, mDepthRBO);
+        glDeleteRenderbuffers(1, &mDepthRBO);
+    }
+    mFBO = 0;
+    mColorRBO = 0;
+    mDepthRBO = 0;
+}
+
+void
+OffscreenTarget::Bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+}
+
+bool
+OffscreenTarget::SaveToPPM(const std::string& path) const {
+    std::vector<unsigned char> Pixels(mWidth * mHeight * 3);
+    Bind();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, mWidth, mHeight, GL_RGB, GL_UNSIGNED_BYTE, Pixels.data());
+
+    std::ofstream Output(path.c_str(), std::ios::binary);
+    if (!Output) {
+        std::cerr << "[Err] Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    Output << "P6\n" << mWidth << " " << mHeight << "\n255\n";
+    // NOTE: GL rows start at the bottom, PPM rows at the top
+    for (int Row = mHeight - 1; Row >= 0; --Row) {
+        Output.write((const char*)&Pixels[Row * mWidth * 3], mWidth * 3);
+    }
+    return true;
+}
+
+int
+OffscreenTarget::GetWidth() const {
+    return mWidth;
+}
+
+int
+OffscreenTarget::GetHeight() const {
+    return mHeight;
+}
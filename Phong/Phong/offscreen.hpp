@@ -0,0 +1,111 @@
+/**
+ * @file offscreen.hpp
+ * @brief Windowless GL context and framebuffer object target for headless runs
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <vector>
+
+// NOTE: Define PHONG_USE_EGL (link libEGL) or PHONG_USE_OSMESA (link libOSMesa) to create the
+// context without any display server. Otherwise a hidden GLFW window provides the context
+#if defined(PHONG_USE_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(PHONG_USE_OSMESA)
+#include <GL/osmesa.h>
+#endif
+
+/**
+ * @brief GL 3.3 core context that is not tied to a visible window
+ */
+class OffscreenContext {
+public:
+    OffscreenContext();
+    ~OffscreenContext();
+
+    /**
+     * @brief Creates the context and makes it current on the calling thread
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Create();
+
+    /**
+     * @brief Releases the context. Must run on the thread it is current on
+     *
+     */
+    void Destroy();
+
+    /**
+     * @brief Returns the name of the backend that created the context
+     *
+     * @returns "EGL", "OSMesa" or "GLFW"
+     */
+    const char* GetBackendName() const;
+
+private:
+#if defined(PHONG_USE_EGL)
+    EGLDisplay mDisplay;
+    EGLContext mContext;
+#elif defined(PHONG_USE_OSMESA)
+    OSMesaContext mContext;
+    // NOTE: OSMesa needs a color buffer to make a context current, rendering goes to the FBO
+    std::vector<unsigned char> mDummyBuffer;
+#else
+    GLFWwindow* mWindow;
+#endif
+};
+
+/**
+ * @brief Framebuffer object with a color and a depth renderbuffer, the draw target of headless runs
+ */
+class OffscreenTarget {
+public:
+    OffscreenTarget();
+    ~OffscreenTarget();
+
+    /**
+     * @brief Creates the framebuffer. Requires a current GL context
+     *
+     * @param width Width in pixels
+     * @param height Height in pixels
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(int width, int height);
+
+    void Destroy();
+
+    /**
+     * @brief Binds the framebuffer for drawing and reading
+     *
+     */
+    void Bind() const;
+
+    /**
+     * @brief Reads the color buffer back and writes it as a binary PPM
+     *
+     * @param path Output file path
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool SaveToPPM(const std::string& path) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+
+private:
+    unsigned mFBO;
+    unsigned mColorRBO;
+    unsigned mDepthRBO;
+    int mWidth;
+    int mHeight;
+};
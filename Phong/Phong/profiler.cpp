@@ -0,0 +1,158 @@
+#include "profiler.hpp"
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+thread_local ProfileThreadBuffer* tProfileBuffer = 0;
+std::atomic<bool> Profiler::sEnabled(false);
+
+// NOTE: Buffers outlive their threads so zones from finished loader and worker threads still export
+static std::mutex sBufferMutex;
+static std::vector<ProfileThreadBuffer*> sBuffers;
+static double sTicksPerSecond = 1.0;
+static unsigned long long sBaseTicks = 0;
+
+void
+Profiler::Init() {
+#ifdef PROFILER_USE_RDTSC
+    // NOTE: The TSC runs at a fixed rate on anything recent, measure it against steady_clock once
+    std::chrono::steady_clock::time_point ClockStart = std::chrono::steady_clock::now();
+    unsigned long long TicksStart = ProfilerTicks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    unsigned long long TicksEnd = ProfilerTicks();
+    double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - ClockStart).count();
+    sTicksPerSecond = (TicksEnd - TicksStart) / Elapsed;
+#else
+    sTicksPerSecond = (double)std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+#endif
+    sBaseTicks = ProfilerTicks();
+    SetEnabled(true);
+}
+
+void
+Profiler::Shutdown() {
+    SetEnabled(false);
+    std::lock_guard<std::mutex> Lock(sBufferMutex);
+    // NOTE: Never freed, other threads' thread_local pointers can't be reached from here. A zone
+    // still in flight lands in the emptied buffer and is dropped at export for predating Init
+    for (unsigned BufferIdx = 0; BufferIdx < sBuffers.size(); ++BufferIdx) {
+        sBuffers[BufferIdx]->mHead.store(0, std::memory_order_relaxed);
+    }
+}
+
+void
+Profiler::SetEnabled(bool enabled) {
+    sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void
+Profiler::SetThreadName(const char* name) {
+    // NOTE: Naming registers the thread's buffer, don't pay for it when nothing is recorded
+    if (!IsEnabled()) {
+        return;
+    }
+
+    ProfileThreadBuffer* Buffer = tProfileBuffer ? tProfileBuffer : registerThread();
+    std::lock_guard<std::mutex> Lock(sBufferMutex);
+    strncpy(Buffer->mName, name, ProfileThreadBuffer::NAME_SIZE - 1);
+    Buffer->mName[ProfileThreadBuffer::NAME_SIZE - 1] = 0;
+}
+
+double
+Profiler::TicksToSeconds(unsigned long long ticks) {
+    return ticks / sTicksPerSecond;
+}
+
+double
+Profiler::GetTicksPerSecond() {
+    return sTicksPerSecond;
+}
+
+ProfileThreadBuffer*
+Profiler::CreateTrack(const char* name) {
+    return createBuffer(name);
+}
+
+ProfileThreadBuffer*
+Profiler::registerThread() {
+    tProfileBuffer = createBuffer("");
+    return tProfileBuffer;
+}
+
+ProfileThreadBuffer*
+Profiler::createBuffer(const char* name) {
+    ProfileThreadBuffer* Buffer = new ProfileThreadBuffer();
+    Buffer->mHead.store(0, std::memory_order_relaxed);
+    strncpy(Buffer->mName, name, ProfileThreadBuffer::NAME_SIZE - 1);
+    Buffer->mName[ProfileThreadBuffer::NAME_SIZE - 1] = 0;
+
+    std::lock_guard<std::mutex> Lock(sBufferMutex);
+    Buffer->mThreadId = sBuffers.size() + 1;
+    sBuffers.push_back(Buffer);
+    return Buffer;
+}
+
+static void
+WriteJSONString(std::ostream& output, const char* text) {
+    output << '"';
+    for (const char* Char = text; *Char; ++Char) {
+        if (*Char == '"' || *Char == '\\') {
+            output << '\\';
+        }
+        output << *Char;
+    }
+    output << '"';
+}
+
+bool
+Profiler::ExportChromeTrace(const std::string& filename) {
+    std::ofstream Output(filename.c_str());
+    if (!Output) {
+        std::cerr << "[Err] Failed to open " << filename << " for the trace" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> Lock(sBufferMutex);
+    double MicrosecondsPerTick = 1e6 / sTicksPerSecond;
+    unsigned long long EventCount = 0;
+    Output.precision(3);
+    Output << std::fixed << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool First = true;
+    for (unsigned BufferIdx = 0; BufferIdx < sBuffers.size(); ++BufferIdx) {
+        const ProfileThreadBuffer* Buffer = sBuffers[BufferIdx];
+        Output << (First ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Buffer->mThreadId << ",\"args\":{\"name\":";
+        First = false;
+        if (Buffer->mName[0]) {
+            WriteJSONString(Output, Buffer->mName);
+        } else {
+            Output << "\"Thread " << Buffer->mThreadId << "\"";
+        }
+        Output << "}}";
+
+        // NOTE: Zones still being written by a live thread may be torn, export after the frames of interest
+        unsigned long long Head = Buffer->mHead.load(std::memory_order_acquire);
+        unsigned long long Tail = Head > ProfileThreadBuffer::CAPACITY ? Head - ProfileThreadBuffer::CAPACITY : 0;
+        for (unsigned long long EventIdx = Tail; EventIdx < Head; ++EventIdx) {
+            const ProfileEvent& Event = Buffer->mEvents[EventIdx & (ProfileThreadBuffer::CAPACITY - 1)];
+            if (Event.mStart < sBaseTicks) {
+                continue;
+            }
+            Output << ",\n{\"name\":";
+            WriteJSONString(Output, Event.mName);
+            Output << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << Buffer->mThreadId
+                << ",\"ts\":" << (Event.mStart - sBaseTicks) * MicrosecondsPerTick
+                << ",\"dur\":" << (Event.mEnd - Event.mStart) * MicrosecondsPerTick;
+            if (Event.mAllocations) {
+                Output << ",\"args\":{\"allocations\":" << Event.mAllocations << "}";
+            }
+            Output << "}";
+            ++EventCount;
+        }
+    }
+    Output << "\n]}\n";
+    std::cout << "Profiler: " << EventCount << " zones from " << sBuffers.size() << " threads written to " << filename << std::endl;
+    return true;
+}
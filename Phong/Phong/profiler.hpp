@@ -0,0 +1,192 @@
+/**
+ * @file profiler.hpp
+ * @brief Low overhead CPU profiler with scoped zones and Chrome trace export
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "alloc_tracker.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USE_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILER_USE_RDTSC
+#endif
+
+/**
+ * @brief Raw timestamp. The TSC on x86, steady_clock ticks elsewhere.
+ * Profiler::TicksToSeconds converts a difference to seconds
+ *
+ * @returns Timestamp in ticks
+ */
+inline unsigned long long
+ProfilerTicks() {
+#ifdef PROFILER_USE_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+struct ProfileEvent {
+    // NOTE: Must point to a string that lives forever, normally a literal
+    const char* mName;
+    unsigned long long mStart;
+    unsigned long long mEnd;
+    // NOTE: Heap allocations the thread made inside the zone, nested zones included
+    unsigned long long mAllocations;
+};
+
+/**
+ * @brief Single producer ring of completed zones. Only the owning thread writes, the exporter
+ * reads everything below mHead. When full the oldest zones are overwritten
+ */
+struct ProfileThreadBuffer {
+    static const unsigned CAPACITY = 1 << 16;
+    static const unsigned NAME_SIZE = 32;
+
+    ProfileEvent mEvents[CAPACITY];
+    std::atomic<unsigned long long> mHead;
+    unsigned mThreadId;
+    char mName[NAME_SIZE];
+};
+
+extern thread_local ProfileThreadBuffer* tProfileBuffer;
+
+class Profiler {
+public:
+    /**
+     * @brief Calibrates the timestamp frequency and starts recording zones
+     *
+     */
+    static void Init();
+
+    /**
+     * @brief Stops recording and empties every buffer. The buffers themselves stay alive until the
+     * process exits, threads keep pointing at theirs and pick them up again after the next Init
+     *
+     */
+    static void Shutdown();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    /**
+     * @brief Names the calling thread in exported traces. Ignored while the profiler is disabled,
+     * so call Init before starting threads that should show up by name
+     *
+     * @param name Thread name, copied
+     */
+    static void SetThreadName(const char* name);
+
+    /**
+     * @brief Appends a completed zone to the calling thread's buffer
+     *
+     * @param name Zone name, must outlive the profiler
+     * @param start Start timestamp from ProfilerTicks
+     * @param end End timestamp from ProfilerTicks
+     * @param allocations Heap allocations made inside the zone
+     */
+    static void Record(const char* name, unsigned long long start, unsigned long long end, unsigned long long allocations);
+
+    /**
+     * @brief Creates a named track that isn't tied to a thread, for timings measured elsewhere
+     * such as on the GPU. Only one thread may record to a track
+     *
+     * @param name Track name, copied
+     *
+     * @returns Track buffer, owned by the profiler
+     */
+    static ProfileThreadBuffer* CreateTrack(const char* name);
+
+    /**
+     * @brief Appends a completed zone to a track
+     *
+     * @param track Track from CreateTrack
+     * @param name Zone name, must outlive the profiler
+     * @param start Start timestamp in ticks
+     * @param end End timestamp in ticks
+     * @param allocations Heap allocations made inside the zone
+     */
+    static void RecordTo(ProfileThreadBuffer* track, const char* name, unsigned long long start, unsigned long long end, unsigned long long allocations);
+
+    /**
+     * @brief Writes all buffered zones as Chrome trace event JSON,
+     * loadable in chrome://tracing and Perfetto
+     *
+     * @param filename Output path
+     *
+     * @returns true - Success, false - Failure
+     */
+    static bool ExportChromeTrace(const std::string& filename);
+
+    static double TicksToSeconds(unsigned long long ticks);
+    static double GetTicksPerSecond();
+
+private:
+    static std::atomic<bool> sEnabled;
+
+    static ProfileThreadBuffer* registerThread();
+    static ProfileThreadBuffer* createBuffer(const char* name);
+};
+
+inline bool
+Profiler::IsEnabled() {
+    return sEnabled.load(std::memory_order_relaxed);
+}
+
+inline void
+Profiler::Record(const char* name, unsigned long long start, unsigned long long end, unsigned long long allocations) {
+    RecordTo(tProfileBuffer ? tProfileBuffer : registerThread(), name, start, end, allocations);
+}
+
+inline void
+Profiler::RecordTo(ProfileThreadBuffer* track, const char* name, unsigned long long start, unsigned long long end, unsigned long long allocations) {
+    unsigned long long Head = track->mHead.load(std::memory_order_relaxed);
+    ProfileEvent& Event = track->mEvents[Head & (ProfileThreadBuffer::CAPACITY - 1)];
+    Event.mName = name;
+    Event.mStart = start;
+    Event.mEnd = end;
+    Event.mAllocations = allocations;
+    track->mHead.store(Head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Times the enclosing scope. Use through PROFILE_ZONE and PROFILE_FUNCTION
+ */
+class ProfileZone {
+public:
+    ProfileZone(const char* name) : mName(name), mStart(Profiler::IsEnabled() ? ProfilerTicks() : 0), mAllocations(tAllocationCount) {}
+
+    ~ProfileZone() {
+        if (mStart) {
+            Profiler::Record(mName, mStart, ProfilerTicks(), tAllocationCount - mAllocations);
+        }
+    }
+
+private:
+    const char* mName;
+    unsigned long long mStart;
+    unsigned long long mAllocations;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// NOTE: Define PHONG_DISABLE_PROFILER to compile every zone out
+#ifdef PHONG_DISABLE_PROFILER
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#else
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(ProfileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+#endif
@@ -0,0 +1,145 @@
+#include "sampler_cache.hpp"
+#include "gl_handle.hpp"
+#include <GL/glew.h>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+struct SamplerEntry {
+    SamplerDesc mDesc;
+    GLSampler mSampler;
+};
+
+// NOTE: Function statics so materials can register samplers no matter when the first one loads
+static std::mutex&
+CacheMutex() {
+    static std::mutex Mutex;
+    return Mutex;
+}
+
+static std::vector<SamplerEntry>&
+Entries() {
+    static std::vector<SamplerEntry> Samplers;
+    return Samplers;
+}
+
+static ETextureQuality sQuality = TEXTURE_QUALITY_MEDIUM;
+// NOTE: 0 until the first sampler is created, 1 when the driver has no anisotropic filtering
+static float sHardwareAnisotropy = 0.0f;
+
+static void
+ApplySampler(unsigned sampler, const SamplerDesc& desc) {
+    static const GLint MIN_FILTERS[SAMPLER_FILTER_COUNT] = { GL_NEAREST_MIPMAP_NEAREST, GL_LINEAR_MIPMAP_NEAREST, GL_LINEAR_MIPMAP_LINEAR };
+    TextureQualitySettings Settings = SamplerCache::GetQualitySettings(sQuality);
+    ESamplerFilter Filter = desc.mFilter < Settings.mMaxFilter ? desc.mFilter : Settings.mMaxFilter;
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, MIN_FILTERS[Filter]);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, desc.mMagFilter);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, desc.mWrap);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, desc.mWrap);
+    glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, desc.mLodBias + Settings.mLodBias);
+
+    if (!sHardwareAnisotropy) {
+        sHardwareAnisotropy = 1.0f;
+        if (GLEW_EXT_texture_filter_anisotropic || GLEW_ARB_texture_filter_anisotropic) {
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &sHardwareAnisotropy);
+        }
+    }
+    if (sHardwareAnisotropy > 1.0f) {
+        float Anisotropy = (float)(desc.mMaxAnisotropy < Settings.mMaxAnisotropy ? desc.mMaxAnisotropy : Settings.mMaxAnisotropy);
+        Anisotropy = Anisotropy < sHardwareAnisotropy ? Anisotropy : sHardwareAnisotropy;
+        glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, Anisotropy > 1.0f ? Anisotropy : 1.0f);
+    }
+}
+
+unsigned
+SamplerCache::Get(const SamplerDesc& desc) {
+    std::lock_guard<std::mutex> Lock(CacheMutex());
+    std::vector<SamplerEntry>& Samplers = Entries();
+    for (unsigned SamplerIdx = 0; SamplerIdx < Samplers.size(); ++SamplerIdx) {
+        const SamplerDesc& Desc = Samplers[SamplerIdx].mDesc;
+        if (Desc.mFilter == desc.mFilter && Desc.mMagFilter == desc.mMagFilter && Desc.mWrap == desc.mWrap
+            && Desc.mMaxAnisotropy == desc.mMaxAnisotropy && Desc.mLodBias == desc.mLodBias) {
+            return SamplerIdx;
+        }
+    }
+
+    Samplers.push_back(SamplerEntry());
+    Samplers.back().mDesc = desc;
+    return Samplers.size() - 1;
+}
+
+unsigned
+SamplerCache::Resolve(unsigned sampler) {
+    std::lock_guard<std::mutex> Lock(CacheMutex());
+    std::vector<SamplerEntry>& Samplers = Entries();
+    if (sampler >= Samplers.size()) {
+        return 0;
+    }
+
+    SamplerEntry& Entry = Samplers[sampler];
+    if (!Entry.mSampler.Get()) {
+        Entry.mSampler = GLSampler::Create();
+        ApplySampler(Entry.mSampler.Get(), Entry.mDesc);
+    }
+    return Entry.mSampler.Get();
+}
+
+void
+SamplerCache::SetQuality(ETextureQuality quality) {
+    std::lock_guard<std::mutex> Lock(CacheMutex());
+    sQuality = quality < TEXTURE_QUALITY_COUNT ? quality : TEXTURE_QUALITY_MEDIUM;
+    std::vector<SamplerEntry>& Samplers = Entries();
+    for (unsigned SamplerIdx = 0; SamplerIdx < Samplers.size(); ++SamplerIdx) {
+        if (Samplers[SamplerIdx].mSampler.Get()) {
+            ApplySampler(Samplers[SamplerIdx].mSampler.Get(), Samplers[SamplerIdx].mDesc);
+        }
+    }
+}
+
+ETextureQuality
+SamplerCache::GetQuality() {
+    return sQuality;
+}
+
+void
+SamplerCache::Destroy() {
+    std::lock_guard<std::mutex> Lock(CacheMutex());
+    std::vector<SamplerEntry>& Samplers = Entries();
+    for (unsigned SamplerIdx = 0; SamplerIdx < Samplers.size(); ++SamplerIdx) {
+        Samplers[SamplerIdx].mSampler.Reset();
+    }
+    sHardwareAnisotropy = 0.0f;
+}
+
+unsigned
+SamplerCache::GetSamplerCount() {
+    std::lock_guard<std::mutex> Lock(CacheMutex());
+    return Entries().size();
+}
+
+TextureQualitySettings
+SamplerCache::GetQualitySettings(ETextureQuality quality) {
+    static const TextureQualitySettings Settings[TEXTURE_QUALITY_COUNT] = {
+        { SAMPLER_FILTER_BILINEAR, 1, 1.0f },
+        { SAMPLER_FILTER_TRILINEAR, 1, 0.0f },
+        { SAMPLER_FILTER_TRILINEAR, 16, 0.0f },
+    };
+    return Settings[quality < TEXTURE_QUALITY_COUNT ? quality : TEXTURE_QUALITY_MEDIUM];
+}
+
+const char*
+SamplerCache::GetQualityName(ETextureQuality quality) {
+    static const char* Names[TEXTURE_QUALITY_COUNT] = { "low", "medium", "high" };
+    return quality < TEXTURE_QUALITY_COUNT ? Names[quality] : "unknown";
+}
+
+bool
+SamplerCache::ParseQuality(const char* name, ETextureQuality& quality) {
+    for (unsigned QualityIdx = 0; QualityIdx < TEXTURE_QUALITY_COUNT; ++QualityIdx) {
+        if (!strcmp(name, GetQualityName((ETextureQuality)QualityIdx))) {
+            quality = (ETextureQuality)QualityIdx;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file sampler_cache.hpp
+ * @brief Shared sampler objects keyed by filter, wrap and anisotropy, with a global texture quality setting
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+enum ESamplerFilter {
+    // NOTE: Nearest texel of the nearest mip
+    SAMPLER_FILTER_NEAREST = 0,
+    // NOTE: Linear within the nearest mip
+    SAMPLER_FILTER_BILINEAR = 1,
+    // NOTE: Linear within and between the two nearest mips
+    SAMPLER_FILTER_TRILINEAR = 2,
+    SAMPLER_FILTER_COUNT = 3,
+};
+
+enum ETextureQuality {
+    // NOTE: Bilinear, no anisotropy and one mip smaller, for weak GPUs short on bandwidth
+    TEXTURE_QUALITY_LOW = 0,
+    // NOTE: Trilinear without anisotropy, what every texture used before samplers
+    TEXTURE_QUALITY_MEDIUM = 1,
+    // NOTE: Trilinear with up to 16x anisotropy
+    TEXTURE_QUALITY_HIGH = 2,
+    TEXTURE_QUALITY_COUNT = 3,
+};
+
+// NOTE: Sampling a material asks for. The quality setting caps the filter and anisotropy and adds its bias
+struct SamplerDesc {
+    ESamplerFilter mFilter;
+    // NOTE: GL_NEAREST or GL_LINEAR, the quality setting leaves magnification alone
+    unsigned mMagFilter;
+    // NOTE: GL_REPEAT or GL_CLAMP_TO_EDGE, used for both S and T
+    unsigned mWrap;
+    unsigned mMaxAnisotropy;
+    float mLodBias;
+};
+
+struct TextureQualitySettings {
+    ESamplerFilter mMaxFilter;
+    unsigned mMaxAnisotropy;
+    // NOTE: Added to every sampler's bias, positive picks smaller mips and saves bandwidth
+    float mLodBias;
+};
+
+/**
+ * @brief One sampler object per distinct SamplerDesc, shared by every material asking for it.
+ * Materials hold ids, so changing the quality updates the samplers in place and touches no
+ * texture or material. Get is thread safe and needs no GL, sampler objects are created on the
+ * first Resolve, which like SetQuality and Destroy has to run on the thread owning the context.
+ * Resolve locks, so owners resolve once on upload and record the GL name instead of the id
+ */
+class SamplerCache {
+public:
+    static const unsigned INVALID_SAMPLER = 0xFFFFFFFF;
+
+    /**
+     * @brief Id of the sampler matching the description, registered if it is new
+     *
+     * @param desc Sampling state
+     * @returns Sampler id, stays valid for the rest of the run
+     */
+    static unsigned Get(const SamplerDesc& desc);
+
+    /**
+     * @brief GL name of a sampler, created with the current quality if it doesn't exist yet. The
+     * name stays the same across quality changes, only Destroy invalidates it
+     *
+     * @param sampler Id from Get
+     * @returns Sampler object, 0 for unknown ids which leaves the texture's own state in effect
+     */
+    static unsigned Resolve(unsigned sampler);
+
+    /**
+     * @brief Re-applies every sampler's state under a new quality setting
+     *
+     * @param quality Quality preset
+     */
+    static void SetQuality(ETextureQuality quality);
+    static ETextureQuality GetQuality();
+
+    /**
+     * @brief Deletes the sampler objects. Ids stay registered and resolve to new objects afterwards
+     *
+     */
+    static void Destroy();
+
+    static unsigned GetSamplerCount();
+    static TextureQualitySettings GetQualitySettings(ETextureQuality quality);
+    static const char* GetQualityName(ETextureQuality quality);
+
+    /**
+     * @brief Reads a quality name as printed by GetQualityName
+     *
+     * @returns true - Known name, false - quality is left unchanged
+     */
+    static bool ParseQuality(const char* name, ETextureQuality& quality);
+};
@@ -0,0 +1,603 @@
+#include "scene.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+
+static_assert(sizeof(PositionalLightBlock) == 64, "PositionalLightBlock must match std140 layout");
+static_assert(sizeof(DirectionalLightBlock) == 80, "DirectionalLightBlock must match std140 layout");
+
+static float
+GetRadians(float angle) {
+    return 3.14 * angle / 180;
+}
+
+// NOTE: GPU scope names, indexed by chunk
+static const char* CHUNK_NAMES[] = { "Props", "Fox", "Floor", "Indicators" };
+static const float FLOOR_TILE_SIZE = 4.0f;
+static const int FLOOR_TILE_FIRST = -2;
+static const int FLOOR_TILE_END = 4;
+static const unsigned DEBUG_DRAW_VERTICES = 4096;
+// NOTE: Seconds per frame spent uploading models that stream in, a fraction of the 60 FPS frame
+static const double MODEL_STREAMING_BUDGET = 0.002;
+// NOTE: Bounding sphere of the unit cube, whose faces each span the UV square once
+static const float CUBE_RADIUS = 0.866f;
+
+static glm::mat4
+FoxModelMatrix() {
+    glm::mat4 ModelMatrix = glm::rotate(glm::mat4(1.0f), GetRadians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return glm::translate(ModelMatrix, glm::vec3(2.1, -1.5, -2.4));
+}
+
+static glm::mat4
+FloorTileMatrix(int i, int j) {
+    glm::mat4 Model(1.0f);
+    Model = glm::translate(Model, glm::vec3(i * FLOOR_TILE_SIZE, -2.0f, j * FLOOR_TILE_SIZE));
+    return glm::scale(Model, glm::vec3(FLOOR_TILE_SIZE, 0.1f, FLOOR_TILE_SIZE));
+}
+
+static DirectionalLightBlock
+MakeSpotlight(const glm::vec3& position, const glm::vec3& direction, const glm::vec3& color) {
+    DirectionalLightBlock Light = { };
+    Light.Position = position;
+    Light.Direction = direction;
+    Light.Ka = color;
+    Light.Kd = color;
+    Light.Ks = glm::vec3(1.0f);
+    Light.Kc = 1.0f;
+    Light.Kl = 0.092f;
+    Light.Kq = 0.032f;
+    Light.InnerCutOff = glm::cos(glm::radians(10.0f));
+    Light.OuterCutOff = glm::cos(glm::radians(10.0f));
+    return Light;
+}
+
+Scene::Scene() : mFox("res/low-poly-fox/low-poly-fox.obj") {
+    mPhongShader = 0;
+    mColorShader = 0;
+    mJobs = 0;
+    mCommandStats = { 0 };
+    mLights = { };
+    mCubeVertexCount = 0;
+    mCubeDiffuseTexture = 0;
+    mCubeSpecularTexture = 0;
+    mWaterDiffuseTexture = 0;
+    mWaterSpecularTexture = 0;
+    mTentTexture = 0;
+    mFishTexture = 0;
+    mFloorDiffuseTexture = 0;
+    mFloorSpecularTexture = 0;
+    mPropBoundArrays[0] = 0;
+    mPropBoundArrays[1] = 0;
+    mStreamCamera = glm::vec3(0.0f);
+    mPixelScale = 0.0f;
+    mViewportWidth = 0;
+    mViewportHeight = 0;
+}
+
+Scene::~Scene() {
+    delete mPhongShader;
+    delete mColorShader;
+}
+
+bool
+Scene::Init(unsigned framesInFlight, JobSystem* jobs) {
+    PROFILE_FUNCTION();
+    mJobs = jobs;
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    // NOTE: Strip encoded meshes separate their strips with the restart index. Every indexed draw sets
+    // the index for its own index width, which lists never reach
+    glEnable(GL_PRIMITIVE_RESTART);
+    glClearColor(0.3f, 0.7f, 1.0f, 0.0f);
+
+    loadPropTextures();
+    createCube();
+
+    // NOTE: The fox streams in while the scene already renders and shows up once it is uploaded
+    mFox.SetMergeByMaterial(true);
+    if (!mFox.LoadAsync(mJobs)) {
+        std::cerr << "Failed to load fox\n";
+        return false;
+    }
+
+    mColorShader = new Shader("shaders/color.vert", "shaders/color.frag");
+    mPhongShader = new Shader("shaders/basic.vert", "shaders/phong_material_texture.frag");
+    mPhongShader->SetUniformBlockBinding("PerFrame", Shader::PER_FRAME_BINDING);
+    mPhongShader->SetUniformBlockBinding("PerDraw", Shader::PER_DRAW_BINDING);
+    mPhongShader->SetUniformBlockBinding("Lights", Shader::LIGHTS_BINDING);
+    mPhongShader->SetUniformBlockBinding("PerMaterial", Shader::PER_MATERIAL_BINDING);
+    mColorShader->SetUniformBlockBinding("PerFrame", Shader::PER_FRAME_BINDING);
+    mColorShader->SetUniformBlockBinding("PerDraw", Shader::PER_DRAW_BINDING);
+
+    glUseProgram(mPhongShader->GetId());
+    // Diminishes the light's diffuse component by half, tinting it slightly red
+    mPhongShader->SetUniform1i("uMaterial.Kd", 0);
+    // Makes the object really shiny
+    mPhongShader->SetUniform1i("uMaterial.Ks", 1);
+    mPhongShader->SetUniform1f("uMaterial.Shininess", 128.0f);
+    glUseProgram(0);
+
+    setupLights();
+
+    // NOTE: Timings and debug geometry are diagnostics only, the scene still renders without them
+    mGpuProfiler.Init();
+    if (!mDebugDraw.Init(DEBUG_DRAW_VERTICES)) {
+        std::cerr << "[Warn] Debug lines unavailable" << std::endl;
+    }
+    mPropBoxes.reserve(16);
+    return mRing.Init(UPLOAD_RING_FRAME_SIZE, framesInFlight);
+}
+
+void
+Scene::Destroy() {
+    // NOTE: Everything the scene created is deleted here while the context is current, the leak report runs after
+    mFox.Unload();
+    mCubeVAO.Reset();
+    mCubeVBO.Reset();
+    mPropTextures.Destroy();
+    SamplerCache::Destroy();
+    mGpuProfiler.Destroy();
+    mDebugDraw.Destroy();
+    mRing.Destroy();
+    delete mPhongShader;
+    delete mColorShader;
+    mPhongShader = 0;
+    mColorShader = 0;
+}
+
+const UploadRing&
+Scene::GetUploadRing() const {
+    return mRing;
+}
+
+const CommandStats&
+Scene::GetCommandStats() const {
+    return mCommandStats;
+}
+
+const GpuProfiler&
+Scene::GetGpuProfiler() const {
+    return mGpuProfiler;
+}
+
+const TextureStreamer&
+Scene::GetTextureStreamer() const {
+    return mTextureStreamer;
+}
+
+void
+Scene::SetTextureBudget(unsigned long long bytes) {
+    mTextureStreamer.SetBudget(bytes);
+}
+
+DebugDraw&
+Scene::GetDebugDraw() {
+    return mDebugDraw;
+}
+
+bool
+Scene::FinishStreaming() {
+    return mFox.FinishStreaming();
+}
+
+void
+Scene::Render(const FrameSnapshot& snapshot) {
+    PROFILE_FUNCTION();
+    if (snapshot.mFramebufferWidth != mViewportWidth || snapshot.mFramebufferHeight != mViewportHeight) {
+        mViewportWidth = snapshot.mFramebufferWidth;
+        mViewportHeight = snapshot.mFramebufferHeight;
+        glViewport(0, 0, mViewportWidth, mViewportHeight);
+    }
+
+    mFox.UpdateStreaming(MODEL_STREAMING_BUDGET);
+    // NOTE: Only the shared samplers change, textures and recorded materials keep their ids
+    if (snapshot.mTextureQuality != SamplerCache::GetQuality()) {
+        SamplerCache::SetQuality((ETextureQuality)snapshot.mTextureQuality);
+        std::cout << "Texture quality: " << SamplerCache::GetQualityName(SamplerCache::GetQuality()) << ", "
+            << SamplerCache::GetSamplerCount() << " samplers updated" << std::endl;
+    }
+    mGpuProfiler.BeginFrame();
+    mGpuProfiler.BeginScope("Frame");
+    mGpuProfiler.BeginScope("Clear");
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    mGpuProfiler.EndScope();
+    mRing.BeginFrame();
+
+    float AspectRatio = mViewportHeight ? mViewportWidth / (float)mViewportHeight : 1.0f;
+    PerFrameBlock FrameUniforms;
+    FrameUniforms.Projection = glm::perspective(45.0f, AspectRatio, 0.1f, 100.0f);
+    FrameUniforms.View = glm::lookAt(snapshot.mCameraPosition, snapshot.mCameraTarget, snapshot.mCameraUp);
+    FrameUniforms.ViewPos = glm::vec4(snapshot.mCameraPosition, 1.0f);
+    mRing.WriteUniform(Shader::PER_FRAME_BINDING, &FrameUniforms, sizeof(FrameUniforms));
+
+    float y = snapshot.mCubeOffset;
+    mLights.PointLight.Kd = glm::vec3(0.5f * snapshot.mFenjer, 0.5f * snapshot.mFenjer, 0.0f);
+    for (unsigned SpotIdx = 0; SpotIdx < SPOTLIGHT_COUNT; ++SpotIdx) {
+        mLights.Spotlights[SpotIdx].Position = mSpotlightPositions[SpotIdx] + glm::vec3(0.0f, y, 0.0f);
+    }
+    mRing.WriteUniform(Shader::LIGHTS_BINDING, &mLights, sizeof(mLights));
+
+    mStreamCamera = snapshot.mCameraPosition;
+    mPixelScale = TextureStreamer::GetPixelScale(FrameUniforms.Projection, mViewportHeight);
+    recordChunks(snapshot);
+
+    PROFILE_ZONE("Scene replay");
+    std::chrono::high_resolution_clock::time_point ReplayStart = std::chrono::high_resolution_clock::now();
+    unsigned CommandCount = 0;
+    for (unsigned ChunkIdx = 0; ChunkIdx < CHUNK_COUNT; ++ChunkIdx) {
+        GPU_PROFILE_ZONE(mGpuProfiler, CHUNK_NAMES[ChunkIdx]);
+        mCommands[ChunkIdx].Execute(mRing);
+        CommandCount += mCommands[ChunkIdx].GetCommandCount();
+    }
+    if (snapshot.mDrawDebugLines) {
+        GPU_PROFILE_ZONE(mGpuProfiler, "Debug lines");
+        drawDebugGeometry();
+        mDebugDraw.Flush();
+    } else {
+        mDebugDraw.Clear();
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+    // NOTE: A bound sampler overrides the texture's own state, the overlay's font texture relies on its own
+    glBindSampler(0, 0);
+    glBindSampler(1, 0);
+
+    // NOTE: After replay, so the levels the recorded draws asked for are known and redefining
+    // a texture can't land between its draws. The fox packer is filled by its loading job until
+    // the model publishes MODEL_UPLOADING, only from then on does the GL thread own it
+    TexturePacker* StreamedPackers[] = { &mPropTextures, &mFox.GetTextures() };
+    EModelState FoxState = mFox.GetState();
+    unsigned StreamedCount = FoxState == MODEL_UPLOADING || FoxState == MODEL_READY ? 2 : 1;
+    mTextureStreamer.Update(StreamedPackers, StreamedCount);
+    mCommandStats.mReplayTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - ReplayStart).count();
+    mCommandStats.mCommands += CommandCount;
+    ++mCommandStats.mFrames;
+
+    mGpuProfiler.EndScope();
+    mGpuProfiler.EndFrame();
+    mRing.EndFrame();
+}
+
+void
+Scene::recordChunks(const FrameSnapshot& snapshot) {
+    PROFILE_FUNCTION();
+    std::chrono::high_resolution_clock::time_point RecordStart = std::chrono::high_resolution_clock::now();
+    if (mJobs && mJobs->GetThreadCount() > 1) {
+        JobCounter Counter;
+        for (unsigned ChunkIdx = 0; ChunkIdx < CHUNK_COUNT; ++ChunkIdx) {
+            RecordChunkJobData Data = { this, &snapshot, ChunkIdx };
+            mJobs->Run(recordChunkJob, &Data, sizeof(Data), &Counter);
+        }
+        mJobs->Wait(&Counter);
+    } else {
+        for (unsigned ChunkIdx = 0; ChunkIdx < CHUNK_COUNT; ++ChunkIdx) {
+            recordChunk(ChunkIdx, snapshot);
+        }
+    }
+    mCommandStats.mRecordTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - RecordStart).count();
+}
+
+void
+Scene::recordChunkJob(void* data) {
+    RecordChunkJobData Data;
+    memcpy(&Data, data, sizeof(Data));
+    Data.mScene->recordChunk(Data.mChunk, *Data.mSnapshot);
+}
+
+void
+Scene::recordChunk(unsigned chunk, const FrameSnapshot& snapshot) {
+    PROFILE_FUNCTION();
+    CommandBuffer& Commands = mCommands[chunk];
+    Commands.Reset();
+    switch (chunk) {
+    case CHUNK_PROPS: recordProps(Commands, snapshot); break;
+    case CHUNK_FOX: recordFox(Commands); break;
+    case CHUNK_FLOOR: recordFloor(Commands); break;
+    case CHUNK_INDICATORS: recordIndicators(Commands); break;
+    }
+}
+
+void
+Scene::recordProps(CommandBuffer& commands, const FrameSnapshot& snapshot) {
+    float y = snapshot.mCubeOffset;
+    mPropBoxes.clear();
+    mPropBoundArrays[0] = mPropBoundArrays[1] = ~0u;
+    commands.UseProgram(mPhongShader->GetId());
+    commands.BindVertexArray(mCubeVAO.Get());
+    glm::mat4 identity(1.0f);
+    glm::mat4 ModelMatrix(1.0f);
+
+    // NOTE(Jovan): Set cube specular and diffuse textures
+    ModelMatrix = glm::translate(identity, glm::vec3(6.0, -2.65, 1.0));
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(1.5f));
+    drawCube(commands, ModelMatrix, mWaterDiffuseTexture, mWaterSpecularTexture);
+
+    ModelMatrix = glm::translate(identity, glm::vec3(5.7, -1.0 + y, 0.8));
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.5f));
+    drawCube(commands, ModelMatrix, mFishTexture, mWaterSpecularTexture);
+
+    //levo krilo staora
+    ModelMatrix = glm::rotate(identity, GetRadians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    ModelMatrix = glm::rotate(ModelMatrix, GetRadians(-45.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    ModelMatrix = glm::translate(ModelMatrix, glm::vec3(-4.4, -2.2, 0.6));
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(3.0f, 6.5f, 0.05f));
+    drawCube(commands, ModelMatrix, mTentTexture, mWaterSpecularTexture);
+
+    //desno krilo satora
+    ModelMatrix = glm::rotate(identity, GetRadians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    ModelMatrix = glm::rotate(ModelMatrix, GetRadians(45.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    ModelMatrix = glm::translate(ModelMatrix, glm::vec3(-4.4, -2.6, -1.0));
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(3.0f, 6.5f, 0.05f));
+    drawCube(commands, ModelMatrix, mTentTexture, mWaterSpecularTexture);
+
+    //pozadina satora
+    ModelMatrix = glm::rotate(identity, GetRadians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ModelMatrix = glm::rotate(ModelMatrix, GetRadians(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    ModelMatrix = glm::translate(ModelMatrix, glm::vec3(-1.2, -1.6, -5.9));
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(4.5f, 4.5f, 0.05f));
+    drawCube(commands, ModelMatrix, mTentTexture, mWaterSpecularTexture);
+
+    //stap
+    ModelMatrix = glm::rotate(identity, GetRadians(-45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ModelMatrix = glm::rotate(ModelMatrix, GetRadians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    ModelMatrix = glm::translate(ModelMatrix, glm::vec3(4.4, 1.9, -1.2));
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.1f, 3.0f, 0.1f));
+    drawCube(commands, ModelMatrix, mCubeDiffuseTexture, mWaterSpecularTexture);
+}
+
+void
+Scene::recordFox(CommandBuffer& commands) {
+    commands.UseProgram(mPhongShader->GetId());
+    // NOTE(Jovan): Models have their textures automatically loaded and set (if existent)
+    pushDrawUniforms(commands, FoxModelMatrix(), glm::vec3(1.0f));
+    mFox.RequestTextureLevels(FoxModelMatrix(), mStreamCamera, mPixelScale);
+    mFox.Record(commands);
+}
+
+void
+Scene::recordIndicators(CommandBuffer& commands) {
+    glm::mat4 identity(1.0f);
+    glm::mat4 ModelMatrix(1.0f);
+    commands.UseProgram(mColorShader->GetId());
+    commands.BindVertexArray(mCubeVAO.Get());
+    // NOTE: Small cubes marking each spotlight, followed by the fenjer
+    for (unsigned SpotIdx = 0; SpotIdx < SPOTLIGHT_COUNT; ++SpotIdx) {
+        ModelMatrix = glm::translate(identity, mLights.Spotlights[SpotIdx].Position);
+        ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
+        pushDrawUniforms(commands, ModelMatrix, mLights.Spotlights[SpotIdx].Kd);
+        commands.DrawArrays(GL_TRIANGLES, 0, mCubeVertexCount);
+    }
+
+    //fenjer
+    ModelMatrix = glm::translate(identity, mLights.PointLight.Position);
+    ModelMatrix = glm::scale(ModelMatrix, glm::vec3(0.25f));
+    pushDrawUniforms(commands, ModelMatrix, glm::vec3(1.0f, 1.0f, 0.0f));
+    commands.DrawArrays(GL_TRIANGLES, 0, mCubeVertexCount);
+}
+
+void
+Scene::createCube() {
+    std::vector<float> CubeVertices = {
+        // X     Y     Z     NX    NY    NZ    U     V    FRONT SIDE
+        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // L D
+         0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, // R D
+        -0.5f,  0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, // L U
+         0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, // R D
+         0.5f,  0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, // R U
+        -0.5f,  0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, // L U
+                                                        // LEFT SIDE
+        -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, // L D
+        -0.5f, -0.5f,  0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
+        -0.5f,  0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
+        -0.5f, -0.5f,  0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
+        -0.5f,  0.5f,  0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // R U
+        -0.5f,  0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
+                                                        // RIGHT SIDE
+         0.5f, -0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, // L D
+         0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
+         0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
+         0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, // R D
+         0.5f,  0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // R U
+         0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, // L U
+                                                        // BOTTOM SIDE
+        -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, // L D
+         0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, // R D
+        -0.5f, -0.5f,  0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, // L U
+         0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, // R D
+         0.5f, -0.5f,  0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, // R U
+        -0.5f, -0.5f,  0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, // L U
+                                                        // TOP SIDE
+        -0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, // L D
+         0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // R D
+        -0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // L U
+         0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // R D
+         0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, // R U
+        -0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // L U
+                                                        // BACK SIDE
+         0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, // L D
+        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, // R D
+         0.5f,  0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, // L U
+        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, // R D
+        -0.5f,  0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f, // R U
+         0.5f,  0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, // L U
+    };
+    mCubeVertexCount = CubeVertices.size() / 8;
+
+    mCubeVAO = GLVertexArray::Create();
+    glBindVertexArray(mCubeVAO.Get());
+    mCubeVBO = GLBuffer::Create();
+    glBindBuffer(GL_ARRAY_BUFFER, mCubeVBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, CubeVertices.size() * sizeof(float), CubeVertices.data(), GL_STATIC_DRAW);
+    FrameStats::CountUploadBytes(CubeVertices.size() * sizeof(float));
+    mCubeVBO.Track(MEMORY_VERTEX_BUFFER, CubeVertices.size() * sizeof(float), "Scene cube");
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void
+Scene::loadPropTextures() {
+    PROFILE_FUNCTION();
+    static const char* Paths[] = {
+        "res/container_diffuse.png", "res/container_specular.png", "res/water.jpg", "res/water-diff.jpg",
+        "res/tent.png", "res/fish.jpg", "res/ice.jpg", "res/ice-diff.jpg",
+    };
+    static const unsigned PathCount = sizeof(Paths) / sizeof(Paths[0]);
+    TextureImage Images[PathCount] = { };
+    auto DecodeImages = [&Images](unsigned begin, unsigned end) {
+        for (unsigned ImageIdx = begin; ImageIdx < end; ++ImageIdx) {
+            Texture::DecodeImage(Paths[ImageIdx], Images[ImageIdx]);
+        }
+    };
+    if (mJobs) {
+        mJobs->ParallelFor(PathCount, 1, DecodeImages);
+    } else {
+        DecodeImages(0, PathCount);
+    }
+
+    // NOTE: Every prop samples its texture inside [0, 1], so they all share atlas pages and one bind
+    unsigned* Slots[PathCount] = {
+        &mCubeDiffuseTexture, &mCubeSpecularTexture, &mWaterDiffuseTexture, &mWaterSpecularTexture,
+        &mTentTexture, &mFishTexture, &mFloorDiffuseTexture, &mFloorSpecularTexture,
+    };
+    for (unsigned ImageIdx = 0; ImageIdx < PathCount; ++ImageIdx) {
+        *Slots[ImageIdx] = Images[ImageIdx].mData ? mPropTextures.Add(Images[ImageIdx], false) : mPropTextures.AddColor(255, 0, 255);
+    }
+    mPropTextures.Pack();
+    for (unsigned ImageIdx = 0; ImageIdx < PathCount; ++ImageIdx) {
+        Texture::FreeImage(Images[ImageIdx]);
+    }
+    mPropTextures.Upload();
+}
+
+void
+Scene::setupLights() {
+    float fenjer = 0.0f;
+    //Ambijentalno svetlo
+    mLights.DirLight.Direction = glm::vec3(1.0f, -1.0f, 0.0f);
+    mLights.DirLight.Ka = glm::vec3(0.9f, 0.9f, 0.9f);
+    mLights.DirLight.Kd = glm::vec3(0.1f, 0.1f, 0.1f);
+    mLights.DirLight.Ks = glm::vec3(1.0f);
+
+    //fenjer
+    mLights.PointLight.Position = glm::vec3(0.3f, 0.5f, -3.3f);
+    mLights.PointLight.Ka = glm::vec3(0.5f * fenjer, 0.5f * fenjer, 0.0f);
+    mLights.PointLight.Kd = glm::vec3(0.5f * fenjer, 0.5f * fenjer, 0.0f);
+    mLights.PointLight.Ks = glm::vec3(1.0f * fenjer);
+    mLights.PointLight.Kc = 1.0f;
+    mLights.PointLight.Kl = 0.092f;
+    mLights.PointLight.Kq = 0.032f;
+
+    //ZELENA, ZUTA, PLAVA, CRVENA, TIRKIZNO, MAGNETA
+    mSpotlightPositions[0] = glm::vec3(5.5f, -1.0f, 0.8f);
+    mSpotlightPositions[1] = glm::vec3(5.9f, -1.0f, 0.8f);
+    mSpotlightPositions[2] = glm::vec3(5.7f, -1.0f, 0.6f);
+    mSpotlightPositions[3] = glm::vec3(5.70f, -1.0f, 1.0f);
+    mSpotlightPositions[4] = glm::vec3(5.7f, -0.8f, 0.8f);
+    mSpotlightPositions[5] = glm::vec3(5.7f, -1.2f, 0.8f);
+    mLights.Spotlights[0] = MakeSpotlight(mSpotlightPositions[0], glm::vec3(-1.0f, -0.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    mLights.Spotlights[1] = MakeSpotlight(mSpotlightPositions[1], glm::vec3(1.0f, -0.5f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f));
+    mLights.Spotlights[2] = MakeSpotlight(mSpotlightPositions[2], glm::vec3(0.0f, -0.5f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    mLights.Spotlights[3] = MakeSpotlight(mSpotlightPositions[3], glm::vec3(0.0f, -0.5f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    mLights.Spotlights[4] = MakeSpotlight(mSpotlightPositions[4], glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 1.0f));
+    mLights.Spotlights[5] = MakeSpotlight(mSpotlightPositions[5], glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 1.0f));
+}
+
+void
+Scene::pushDrawUniforms(CommandBuffer& commands, const glm::mat4& model, const glm::vec3& color) {
+    PerDrawBlock Block;
+    Block.Model = model;
+    Block.NormalMatrix = glm::transpose(glm::inverse(model));
+    Block.Color = glm::vec4(color, 1.0f);
+    commands.SetUniformBlock(Shader::PER_DRAW_BINDING, &Block, sizeof(Block));
+}
+
+void
+Scene::bindMaterial(CommandBuffer& commands, unsigned diffuse, unsigned specular, unsigned* boundArrays) {
+    // NOTE: Props differing only by texture land in the same array, so mostly just the block changes
+    unsigned Arrays[2] = { mPropTextures.GetSlot(diffuse).mArray, mPropTextures.GetSlot(specular).mArray };
+    for (unsigned Unit = 0; Unit < 2; ++Unit) {
+        if (boundArrays[Unit] != Arrays[Unit]) {
+            commands.BindTexture(Unit, mPropTextures.GetTexture(Arrays[Unit]), GL_TEXTURE_2D_ARRAY);
+            commands.BindSampler(Unit, mPropTextures.GetSamplerObject(Arrays[Unit]));
+            boundArrays[Unit] = Arrays[Unit];
+        }
+    }
+    MaterialBlock Block = mPropTextures.MakeMaterial(diffuse, specular);
+    commands.SetUniformBlock(Shader::PER_MATERIAL_BINDING, &Block, sizeof(Block));
+}
+
+void
+Scene::drawCube(CommandBuffer& commands, const glm::mat4& model, unsigned diffuse, unsigned specular) {
+    mPropBoxes.push_back(model);
+    pushDrawUniforms(commands, model, glm::vec3(1.0f));
+    bindMaterial(commands, diffuse, specular, mPropBoundArrays);
+    requestCubeLevels(model, diffuse, specular);
+    commands.DrawArrays(GL_TRIANGLES, 0, mCubeVertexCount);
+}
+
+void
+Scene::requestCubeLevels(const glm::mat4& model, unsigned diffuse, unsigned specular) {
+    float UVPerPixel = 1.0f / TextureStreamer::GetPixelsPerUnit(model, glm::vec3(0.0f), CUBE_RADIUS, mStreamCamera, mPixelScale);
+    mPropTextures.RequestSlotLevel(diffuse, UVPerPixel);
+    mPropTextures.RequestSlotLevel(specular, UVPerPixel);
+}
+
+void
+Scene::recordFloor(CommandBuffer& commands) {
+    commands.UseProgram(mPhongShader->GetId());
+    commands.BindVertexArray(mCubeVAO.Get());
+    unsigned BoundArrays[2] = { ~0u, ~0u };
+    bindMaterial(commands, mFloorDiffuseTexture, mFloorSpecularTexture, BoundArrays);
+    for (int i = FLOOR_TILE_FIRST; i < FLOOR_TILE_END; ++i) {
+        for (int j = FLOOR_TILE_FIRST; j < FLOOR_TILE_END; ++j) {
+            pushDrawUniforms(commands, FloorTileMatrix(i, j), glm::vec3(1.0f));
+            requestCubeLevels(FloorTileMatrix(i, j), mFloorDiffuseTexture, mFloorSpecularTexture);
+            commands.DrawArrays(GL_TRIANGLES, 0, 36);
+        }
+    }
+}
+
+void
+Scene::drawDebugGeometry() {
+    PROFILE_FUNCTION();
+    // NOTE: Scene geometry is depth tested, light gizmos stay visible through the tent
+    for (unsigned BoxIdx = 0; BoxIdx < mPropBoxes.size(); ++BoxIdx) {
+        mDebugDraw.Box(mPropBoxes[BoxIdx], glm::vec3(1.0f, 1.0f, 1.0f));
+    }
+    for (int i = FLOOR_TILE_FIRST; i < FLOOR_TILE_END; ++i) {
+        for (int j = FLOOR_TILE_FIRST; j < FLOOR_TILE_END; ++j) {
+            mDebugDraw.Box(FloorTileMatrix(i, j), glm::vec3(0.4f, 0.4f, 0.4f));
+        }
+    }
+
+    glm::vec3 FoxMin;
+    glm::vec3 FoxMax;
+    if (mFox.GetBounds(FoxMin, FoxMax)) {
+        glm::mat4 Bounds = glm::translate(FoxModelMatrix(), (FoxMin + FoxMax) * 0.5f);
+        mDebugDraw.Box(glm::scale(Bounds, FoxMax - FoxMin), glm::vec3(1.0f, 0.5f, 0.0f));
+    }
+
+    for (unsigned SpotIdx = 0; SpotIdx < SPOTLIGHT_COUNT; ++SpotIdx) {
+        const DirectionalLightBlock& Spotlight = mLights.Spotlights[SpotIdx];
+        mDebugDraw.Cone(Spotlight.Position, Spotlight.Direction, 1.5f, Spotlight.OuterCutOff, Spotlight.Kd, DEBUG_DEPTH_ALWAYS);
+    }
+    // NOTE: Radius where the point light's attenuation falls to half
+    const PositionalLightBlock& Point = mLights.PointLight;
+    float Radius = (-Point.Kl + sqrtf(Point.Kl * Point.Kl - 4.0f * Point.Kq * (Point.Kc - 2.0f))) / (2.0f * Point.Kq);
+    mDebugDraw.Sphere(Point.Position, Radius, glm::vec3(1.0f, 1.0f, 0.0f), DEBUG_DEPTH_ALWAYS);
+
+    glm::vec3 Origin(0.0f);
+    mDebugDraw.Line(Origin, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), DEBUG_DEPTH_ALWAYS);
+    mDebugDraw.Line(Origin, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), DEBUG_DEPTH_ALWAYS);
+    mDebugDraw.Line(Origin, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, 1.0f), DEBUG_DEPTH_ALWAYS);
+}
@@ -0,0 +1,207 @@
+/**
+ * @file scene.hpp
+ * @brief The camping scene: resources, lights and the draw calls that render a frame snapshot
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "shader.hpp"
+#include "model.hpp"
+#include "texture.hpp"
+#include "texture_packer.hpp"
+#include "texture_streamer.hpp"
+#include "upload_ring.hpp"
+#include "frame_snapshot.hpp"
+#include "command_buffer.hpp"
+#include "jobs.hpp"
+#include "gpu_profiler.hpp"
+#include "debug_draw.hpp"
+#include <vector>
+
+// NOTE: CPU mirrors of the std140 uniform blocks declared in the shaders. Every vec3 is
+// followed by a float so the packing matches std140 without explicit padding
+struct PerFrameBlock {
+    glm::mat4 Projection;
+    glm::mat4 View;
+    glm::vec4 ViewPos;
+};
+
+struct PerDrawBlock {
+    glm::mat4 Model;
+    glm::mat4 NormalMatrix;
+    glm::vec4 Color;
+};
+
+struct PositionalLightBlock {
+    glm::vec3 Position;
+    float Kc;
+    glm::vec3 Ka;
+    float Kl;
+    glm::vec3 Kd;
+    float Kq;
+    glm::vec3 Ks;
+    float Padding;
+};
+
+struct DirectionalLightBlock {
+    glm::vec3 Position;
+    float Kc;
+    glm::vec3 Direction;
+    float Kl;
+    glm::vec3 Ka;
+    float Kq;
+    glm::vec3 Kd;
+    float InnerCutOff;
+    glm::vec3 Ks;
+    float OuterCutOff;
+};
+
+static const unsigned SPOTLIGHT_COUNT = 6;
+
+struct LightsBlock {
+    DirectionalLightBlock DirLight;
+    PositionalLightBlock PointLight;
+    DirectionalLightBlock Spotlights[SPOTLIGHT_COUNT];
+};
+
+struct CommandStats {
+    unsigned long long mCommands;
+    unsigned mFrames;
+    // NOTE: Seconds spent recording all chunks and replaying them on the GL thread
+    double mRecordTime;
+    double mReplayTime;
+};
+
+class Scene {
+public:
+    Scene();
+    ~Scene();
+
+    /**
+     * @brief Loads textures, models and shaders and creates GL state. Requires a current GL context
+     *
+     * @param framesInFlight Number of frames the upload ring has to keep regions for
+     * @param jobs Job system used to record chunks in parallel, 0 records them serially
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(unsigned framesInFlight, JobSystem* jobs);
+
+    /**
+     * @brief Releases GL resources owned by the scene. Must run on the thread owning the context
+     *
+     */
+    void Destroy();
+
+    /**
+     * @brief Records the chunks of the snapshot into command buffers, in parallel when a job
+     * system is set, then replays them in order into the current framebuffer
+     *
+     * @param snapshot Simulation state to render
+     */
+    void Render(const FrameSnapshot& snapshot);
+
+    const UploadRing& GetUploadRing() const;
+    const CommandStats& GetCommandStats() const;
+    const GpuProfiler& GetGpuProfiler() const;
+    const TextureStreamer& GetTextureStreamer() const;
+
+    /**
+     * @brief GPU bytes the streamed textures of the scene and its models may take together
+     *
+     * @param bytes Budget in bytes
+     */
+    void SetTextureBudget(unsigned long long bytes);
+
+    /**
+     * @brief Shapes submitted here are drawn by the next Render when the snapshot has debug lines on
+     *
+     */
+    DebugDraw& GetDebugDraw();
+
+    /**
+     * @brief Blocks until every streamed model is uploaded, for runs that need the full scene from the first frame
+     *
+     * @returns true - All models ready, false - A model failed to load
+     */
+    bool FinishStreaming();
+
+private:
+    static const unsigned UPLOAD_RING_FRAME_SIZE = 64 * 1024;
+
+    // NOTE: Independent parts of the frame, each recorded into its own command buffer.
+    // Replayed in this order, which is the order the scene was originally drawn in
+    enum ESceneChunk {
+        CHUNK_PROPS = 0,
+        CHUNK_FOX = 1,
+        CHUNK_FLOOR = 2,
+        CHUNK_INDICATORS = 3,
+        CHUNK_COUNT = 4,
+    };
+
+    struct RecordChunkJobData {
+        Scene* mScene;
+        const FrameSnapshot* mSnapshot;
+        unsigned mChunk;
+    };
+
+    Shader* mPhongShader;
+    Shader* mColorShader;
+    Model mFox;
+    UploadRing mRing;
+    JobSystem* mJobs;
+    CommandBuffer mCommands[CHUNK_COUNT];
+    CommandStats mCommandStats;
+    GpuProfiler mGpuProfiler;
+    DebugDraw mDebugDraw;
+    // NOTE: Prop transforms of the current frame, only written by the props chunk
+    std::vector<glm::mat4> mPropBoxes;
+    LightsBlock mLights;
+    glm::vec3 mSpotlightPositions[SPOTLIGHT_COUNT];
+
+    GLVertexArray mCubeVAO;
+    GLBuffer mCubeVBO;
+    unsigned mCubeVertexCount;
+    // NOTE: Prop textures share the packer's arrays, the members below are its slot handles
+    TexturePacker mPropTextures;
+    unsigned mCubeDiffuseTexture;
+    unsigned mCubeSpecularTexture;
+    unsigned mWaterDiffuseTexture;
+    unsigned mWaterSpecularTexture;
+    unsigned mTentTexture;
+    unsigned mFishTexture;
+    unsigned mFloorDiffuseTexture;
+    unsigned mFloorSpecularTexture;
+    // NOTE: Arrays the props chunk last bound to units 0 and 1, only written by the props chunk
+    unsigned mPropBoundArrays[2];
+    TextureStreamer mTextureStreamer;
+    // NOTE: Camera and pixel scale of the frame being recorded, for the texture level requests
+    glm::vec3 mStreamCamera;
+    float mPixelScale;
+    int mViewportWidth;
+    int mViewportHeight;
+
+    void createCube();
+    void loadPropTextures();
+    void setupLights();
+    void recordChunks(const FrameSnapshot& snapshot);
+    void recordChunk(unsigned chunk, const FrameSnapshot& snapshot);
+    void recordProps(CommandBuffer& commands, const FrameSnapshot& snapshot);
+    void recordFox(CommandBuffer& commands);
+    void recordFloor(CommandBuffer& commands);
+    void recordIndicators(CommandBuffer& commands);
+    void pushDrawUniforms(CommandBuffer& commands, const glm::mat4& model, const glm::vec3& color);
+    void bindMaterial(CommandBuffer& commands, unsigned diffuse, unsigned specular, unsigned* boundArrays);
+    void drawCube(CommandBuffer& commands, const glm::mat4& model, unsigned diffuse, unsigned specular);
+    void requestCubeLevels(const glm::mat4& model, unsigned diffuse, unsigned specular);
+    void drawDebugGeometry();
+
+    static void recordChunkJob(void* data);
+};
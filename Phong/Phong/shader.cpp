@@ -1,34 +1,75 @@
 #include "shader.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
 
 Shader::Shader(const std::string& vShaderPath, const std::string& fShaderPath) {
+    PROFILE_ZONE("Shader::Shader");
     unsigned vs = loadAndCompileShader(vShaderPath, GL_VERTEX_SHADER);
     unsigned fs = loadAndCompileShader(fShaderPath, GL_FRAGMENT_SHADER);
-    mId = createBasicProgram(vs, fs);
+    mProgram = createBasicProgram(vs, fs);
+
+    // NOTE: The linked binary size is the closest thing to a program's footprint the GL exposes
+    int BinarySize = 0;
+    if (mProgram.Get() && GLEW_ARB_get_program_binary) {
+        glGetProgramiv(mProgram.Get(), GL_PROGRAM_BINARY_LENGTH, &BinarySize);
+    }
+    if (mProgram.Get()) {
+        mProgram.Track(MEMORY_PROGRAM, BinarySize, vShaderPath + " + " + fShaderPath);
+    }
 }
 
 unsigned
 Shader::GetId() const {
-    return mId;
+    return mProgram.Get();
 }
 
 void
 Shader::SetUniform1i(const std::string& uniform, int v) const {
-    glUniform1i(glGetUniformLocation(mId, uniform.c_str()), v);
+    SetUniform1i(uniform.c_str(), v);
+}
+
+void
+Shader::SetUniform1i(const char* uniform, int v) const {
+    FrameStats::CountUniformLookup();
+    FrameStats::CountUniformUpload();
+    glUniform1i(glGetUniformLocation(mProgram.Get(), uniform), v);
 }
 
 void
 Shader::SetUniform1f(const std::string& uniform, float v) const {
-    glUniform1f(glGetUniformLocation(mId, uniform.c_str()), v);
+    SetUniform1f(uniform.c_str(), v);
+}
+
+void
+Shader::SetUniform1f(const char* uniform, float v) const {
+    FrameStats::CountUniformLookup();
+    FrameStats::CountUniformUpload();
+    glUniform1f(glGetUniformLocation(mProgram.Get(), uniform), v);
 }
 
 void
 Shader::SetUniform3f(const std::string& uniform, const glm::vec3& v) const {
-    glUniform3f(glGetUniformLocation(mId, uniform.c_str()), v.x, v.y, v.z);
+    SetUniform3f(uniform.c_str(), v);
+}
+
+void
+Shader::SetUniform3f(const char* uniform, const glm::vec3& v) const {
+    FrameStats::CountUniformLookup();
+    FrameStats::CountUniformUpload();
+    glUniform3f(glGetUniformLocation(mProgram.Get(), uniform), v.x, v.y, v.z);
 }
 
 void
 Shader::SetUniform4m(const std::string& uniform, const glm::mat4& m) const {
-    glUniformMatrix4fv(glGetUniformLocation(mId, uniform.c_str()), 1, GL_FALSE, &m[0][0]);
+    SetUniform4m(uniform.c_str(), m);
+}
+
+void
+Shader::SetUniform4m(const char* uniform, const glm::mat4& m) const {
+    FrameStats::CountUniformLookup();
+    FrameStats::CountUniformUpload();
+    glUniformMatrix4fv(glGetUniformLocation(mProgram.Get(), uniform), 1, GL_FALSE, &m[0][0]);
 }
 
 void
@@ -45,8 +86,23 @@ void Shader::SetProjection(const glm::mat4& m) const {
     SetUniform4m("uProjection", m);
 }
 
+void
+Shader::SetUniformBlockBinding(const std::string& block, unsigned binding) const {
+    SetUniformBlockBinding(block.c_str(), binding);
+}
+
+void
+Shader::SetUniformBlockBinding(const char* block, unsigned binding) const {
+    FrameStats::CountUniformLookup();
+    unsigned BlockIndex = glGetUniformBlockIndex(mProgram.Get(), block);
+    if (BlockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(mProgram.Get(), BlockIndex, binding);
+    }
+}
+
 unsigned
 Shader::loadAndCompileShader(std::string filename, GLuint shaderType) {
+    PROFILE_FUNCTION();
     unsigned ShaderID = 0;
     std::ifstream In(filename);
     std::string Str;
@@ -77,10 +133,10 @@ Shader::loadAndCompileShader(std::string filename, GLuint shaderType) {
     return ShaderID;
 }
 
-unsigned
+GLProgram
 Shader::createBasicProgram(unsigned vShader, unsigned fShader) {
-    unsigned ProgramID = 0;
-    ProgramID = glCreateProgram();
+    GLProgram Program = GLProgram::Create();
+    unsigned ProgramID = Program.Get();
     glAttachShader(ProgramID, vShader);
     glAttachShader(ProgramID, fShader);
     glLinkProgram(ProgramID);
@@ -91,7 +147,7 @@ Shader::createBasicProgram(unsigned vShader, unsigned fShader) {
     if (!Success) {
         glGetProgramInfoLog(ProgramID, 512, NULL, InfoLog);
         std::cerr << "[Err] Failed to link shader program:" << std::endl << InfoLog << std::endl;
-        return 0;
+        return GLProgram();
     }
 
     glDetachShader(ProgramID, vShader);
@@ -99,5 +155,5 @@ Shader::createBasicProgram(unsigned vShader, unsigned fShader) {
     glDeleteShader(vShader);
     glDeleteShader(fShader);
 
-    return ProgramID;
+    return Program;
 }
\ No newline at end of file
@@ -15,14 +15,23 @@
 #include <fstream>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "gl_handle.hpp"
 
 class Shader {
 public:
     static const unsigned POSITION_LOCATION = 0;
     static const unsigned COLOR_LOCATION = 1;
-    unsigned mId;
+    static const unsigned PER_FRAME_BINDING = 0;
+    static const unsigned PER_DRAW_BINDING = 1;
+    static const unsigned LIGHTS_BINDING = 2;
+    static const unsigned PER_MATERIAL_BINDING = 3;
 
     Shader(const std::string& vShaderPath, const std::string& fShaderPath);
+    // NOTE: Owns the program, deleted with the shader
+    Shader(Shader&& other) = default;
+    Shader& operator=(Shader&& other) = default;
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
     unsigned GetId() const;
 
     /**
@@ -32,6 +41,8 @@ public:
      * @param v Value
      */
     void SetUniform1i(const std::string& uniform, int v) const;
+    // NOTE: Literal names resolve to the const char* overloads below and skip building a std::string
+    void SetUniform1i(const char* uniform, int v) const;
 
     /**
      * @brief Sets float uniform value
@@ -40,6 +51,7 @@ public:
      * @param v Value
      */
     void SetUniform1f(const std::string& uniform, float v) const;
+    void SetUniform1f(const char* uniform, float v) const;
 
     /**
     * @brief Sets float uniform value
@@ -48,6 +60,7 @@ public:
     * @param v Value
     */
     void SetUniform3f(const std::string& uniform, const glm::vec3& v) const;
+    void SetUniform3f(const char* uniform, const glm::vec3& v) const;
 
     /**
      * @brief Sets 4x4 matrix uniform value
@@ -56,6 +69,7 @@ public:
      * @param m GLM matrix
      */
     void SetUniform4m(const std::string& uniform, const glm::mat4& m) const;
+    void SetUniform4m(const char* uniform, const glm::mat4& m) const;
 
     /**
      * @brief Sets the Model matrix
@@ -77,7 +91,17 @@ public:
      * @param m Projection matrix
      */
     void SetProjection(const glm::mat4& m) const;
+
+    /**
+     * @brief Assigns a uniform block to a binding point. Blocks the program doesn't have are ignored
+     *
+     * @param block Name of uniform block
+     * @param binding Binding point
+     */
+    void SetUniformBlockBinding(const std::string& block, unsigned binding) const;
+    void SetUniformBlockBinding(const char* block, unsigned binding) const;
 private:
+    GLProgram mProgram;
 
     /**
      * @brief Loads shader from file and returns the compiled shader's ID
@@ -96,5 +120,5 @@ private:
      * 
      * @returns Shader program ID
      */
-    unsigned createBasicProgram(unsigned vShader, unsigned fShader);
+    GLProgram createBasicProgram(unsigned vShader, unsigned fShader);
 };
\ No newline at end of file
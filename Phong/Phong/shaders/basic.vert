@@ -4,9 +4,18 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
-uniform mat4 uModel;
+layout (std140) uniform PerFrame {
+	mat4 uProjection;
+	mat4 uView;
+	vec4 uViewPos;
+};
+
+layout (std140) uniform PerDraw {
+	mat4 uModel;
+	// NOTE: transpose(inverse(uModel)), computed once per draw on the CPU instead of per vertex
+	mat4 uNormalMatrix;
+	vec4 uColor;
+};
 
 out vec2 UV;
 out vec3 vWorldSpaceFragment;
@@ -14,7 +23,7 @@ out vec3 vWorldSpaceNormal;
 
 void main() {
 	vWorldSpaceFragment = vec3(uModel * vec4(aPos, 1.0f));
-	vWorldSpaceNormal = normalize(mat3(transpose(inverse(uModel))) * aNormal);
+	vWorldSpaceNormal = normalize(mat3(uNormalMatrix) * aNormal);
 
 	UV = aUV;
 	gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0f);
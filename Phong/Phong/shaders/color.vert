@@ -2,9 +2,17 @@
 
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
-uniform mat4 uModel;
+layout (std140) uniform PerFrame {
+	mat4 uProjection;
+	mat4 uView;
+	vec4 uViewPos;
+};
+
+layout (std140) uniform PerDraw {
+	mat4 uModel;
+	mat4 uNormalMatrix;
+	vec4 uColor;
+};
 
 void main() {
 	gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0f);
@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+
+layout (std140) uniform PerFrame {
+	mat4 uProjection;
+	mat4 uView;
+	vec4 uViewPos;
+};
+
+out vec4 Color;
+
+void main() {
+	Color = aColor;
+	gl_Position = uProjection * uView * vec4(aPos, 1.0f);
+}
\ No newline at end of file
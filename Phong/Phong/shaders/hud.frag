@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec2 UV;
+in vec4 Color;
+
+uniform sampler2D uAtlas;
+
+out vec4 FragColor;
+
+void main() {
+	FragColor = vec4(Color.rgb, Color.a * texture(uAtlas, UV).r);
+}
\ No newline at end of file
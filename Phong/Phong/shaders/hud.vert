@@ -0,0 +1,14 @@
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aUV;
+layout (location = 2) in vec4 aColor;
+
+out vec2 UV;
+out vec4 Color;
+
+void main() {
+	UV = aUV;
+	Color = aColor;
+	gl_Position = vec4(aPos, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -1,46 +1,61 @@
 #version 330 core
 
+// NOTE: Members are ordered so every vec3 shares a 16 byte std140 slot with a float,
+// keeping the block layout identical to the CPU side LightsBlock
 struct PositionalLight {
 	vec3 Position;
-	vec3 Ka;
-	vec3 Kd;
-	vec3 Ks;
 	float Kc;
+	vec3 Ka;
 	float Kl;
+	vec3 Kd;
 	float Kq;
+	vec3 Ks;
+	float Padding;
 };
 
 struct DirectionalLight {
 	vec3 Position;
+	float Kc;
 	vec3 Direction;
+	float Kl;
 	vec3 Ka;
+	float Kq;
 	vec3 Kd;
-	vec3 Ks;
 	float InnerCutOff;
+	vec3 Ks;
 	float OuterCutOff;
-	float Kc;
-	float Kl;
-	float Kq;
 };
 
 struct Material {
 	// NOTE(Jovan): Diffuse is used as ambient as well since the light source
 	// defines the ambient colour
-	sampler2D Kd;
-	sampler2D Ks;
+	sampler2DArray Kd;
+	sampler2DArray Ks;
 	float Shininess;
 };
 
-uniform PositionalLight uPointLight;
-uniform DirectionalLight uSpotlight;
-uniform DirectionalLight uSpotlight1;
-uniform DirectionalLight uSpotlight2;
-uniform DirectionalLight uSpotlight3;
-uniform DirectionalLight uSpotlight4;
-uniform DirectionalLight uSpotlight5;
-uniform DirectionalLight uDirLight;
+#define SPOTLIGHT_COUNT 6
+
+layout (std140) uniform PerFrame {
+	mat4 uProjection;
+	mat4 uView;
+	vec4 uViewPos;
+};
+
+// NOTE: Where this draw's textures sit in the bound arrays. Rects map UV into the layer, xy scale and zw offset
+layout (std140) uniform PerMaterial {
+	vec4 uDiffuseRect;
+	vec4 uSpecularRect;
+	vec4 uLayers;
+};
+
+layout (std140) uniform Lights {
+	DirectionalLight uDirLight;
+	PositionalLight uPointLight;
+	DirectionalLight uSpotlights[SPOTLIGHT_COUNT];
+};
+
 uniform Material uMaterial;
-uniform vec3 uViewPos;
 
 in vec2 UV;
 in vec3 vWorldSpaceFragment;
@@ -48,16 +63,16 @@ in vec3 vWorldSpaceNormal;
 
 out vec4 FragColor;
 
-vec3 SpotlightRender(DirectionalLight uSpotlight, vec3 vWorldSpaceFragment, vec3 vWorldSpaceNormal, vec3 ViewDirection, Material uMaterial, vec2 UV){
+vec3 SpotlightRender(DirectionalLight uSpotlight, vec3 vWorldSpaceFragment, vec3 vWorldSpaceNormal, vec3 ViewDirection, Material uMaterial, vec3 DiffuseUV, vec3 SpecularUV){
 	vec3 SpotlightVector = normalize(uSpotlight.Position - vWorldSpaceFragment);
 
 	float SpotDiffuse = max(dot(vWorldSpaceNormal, SpotlightVector), 0.0f);
 	vec3 SpotReflectDirection = reflect(-SpotlightVector, vWorldSpaceNormal);
 	float SpotSpecular = pow(max(dot(ViewDirection, SpotReflectDirection), 0.0f), uMaterial.Shininess);
 
-	vec3 SpotAmbientColor = uSpotlight.Ka * vec3(texture(uMaterial.Kd, UV));
-	vec3 SpotDiffuseColor = SpotDiffuse * uSpotlight.Kd * vec3(texture(uMaterial.Kd, UV));
-	vec3 SpotSpecularColor = SpotSpecular * uSpotlight.Ks * vec3(texture(uMaterial.Ks, UV));
+	vec3 SpotAmbientColor = uSpotlight.Ka * vec3(texture(uMaterial.Kd, DiffuseUV));
+	vec3 SpotDiffuseColor = SpotDiffuse * uSpotlight.Kd * vec3(texture(uMaterial.Kd, DiffuseUV));
+	vec3 SpotSpecularColor = SpotSpecular * uSpotlight.Ks * vec3(texture(uMaterial.Ks, SpecularUV));
 
 	float SpotlightDistance = length(uSpotlight.Position - vWorldSpaceFragment);
 	float SpotAttenuation = 1.0f / (uSpotlight.Kc + uSpotlight.Kl * SpotlightDistance + uSpotlight.Kq * (SpotlightDistance * SpotlightDistance));
@@ -71,7 +86,9 @@ vec3 SpotlightRender(DirectionalLight uSpotlight, vec3 vWorldSpaceFragment, vec3
 }
 
 void main() {
-	vec3 ViewDirection = normalize(uViewPos - vWorldSpaceFragment);
+	vec3 DiffuseUV = vec3(UV * uDiffuseRect.xy + uDiffuseRect.zw, uLayers.x);
+	vec3 SpecularUV = vec3(UV * uSpecularRect.xy + uSpecularRect.zw, uLayers.y);
+	vec3 ViewDirection = normalize(uViewPos.xyz - vWorldSpaceFragment);
 	// NOTE(Jovan): Directional light
 	vec3 DirLightVector = normalize(-uDirLight.Direction);
 	float DirDiffuse = max(dot(vWorldSpaceNormal, DirLightVector), 0.0f);
@@ -79,9 +96,9 @@ void main() {
 	// NOTE(Jovan): 32 is the specular shininess factor. Hardcoded for now
 	float DirSpecular = pow(max(dot(ViewDirection, DirReflectDirection), 0.0f), uMaterial.Shininess);
 
-	vec3 DirAmbientColor = uDirLight.Ka * vec3(texture(uMaterial.Kd, UV));
-	vec3 DirDiffuseColor = uDirLight.Kd * DirDiffuse * vec3(texture(uMaterial.Kd, UV));
-	vec3 DirSpecularColor = uDirLight.Ks * DirSpecular * vec3(texture(uMaterial.Ks, UV));
+	vec3 DirAmbientColor = uDirLight.Ka * vec3(texture(uMaterial.Kd, DiffuseUV));
+	vec3 DirDiffuseColor = uDirLight.Kd * DirDiffuse * vec3(texture(uMaterial.Kd, DiffuseUV));
+	vec3 DirSpecularColor = uDirLight.Ks * DirSpecular * vec3(texture(uMaterial.Ks, SpecularUV));
 	vec3 DirColor = DirAmbientColor + DirDiffuseColor + DirSpecularColor;
 
 	// NOTE(Jovan): Point light
@@ -90,22 +107,20 @@ void main() {
 	vec3 PtReflectDirection = reflect(-PtLightVector, vWorldSpaceNormal);
 	float PtSpecular = pow(max(dot(ViewDirection, PtReflectDirection), 0.0f), uMaterial.Shininess);
 
-	vec3 PtAmbientColor = uPointLight.Ka * vec3(texture(uMaterial.Kd, UV));
-	vec3 PtDiffuseColor = PtDiffuse * uPointLight.Kd * vec3(texture(uMaterial.Kd, UV));
-	vec3 PtSpecularColor = PtSpecular * uPointLight.Ks * vec3(texture(uMaterial.Ks, UV));
+	vec3 PtAmbientColor = uPointLight.Ka * vec3(texture(uMaterial.Kd, DiffuseUV));
+	vec3 PtDiffuseColor = PtDiffuse * uPointLight.Kd * vec3(texture(uMaterial.Kd, DiffuseUV));
+	vec3 PtSpecularColor = PtSpecular * uPointLight.Ks * vec3(texture(uMaterial.Ks, SpecularUV));
 
 	float PtLightDistance = length(uPointLight.Position - vWorldSpaceFragment);
 	float PtAttenuation = 1.0f / (uPointLight.Kc + uPointLight.Kl * PtLightDistance + uPointLight.Kq * (PtLightDistance * PtLightDistance));
 	vec3 PtColor = PtAttenuation * (PtAmbientColor + PtDiffuseColor + PtSpecularColor);
 
 	// NOTE(Jovan): Spotlight
-	vec3 SpotColor = SpotlightRender(uSpotlight, vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, UV);
-	vec3 SpotColor1 = SpotlightRender(uSpotlight1, vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, UV);
-	vec3 SpotColor2 = SpotlightRender(uSpotlight2, vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, UV);
-	vec3 SpotColor3 = SpotlightRender(uSpotlight3, vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, UV);
-	vec3 SpotColor4 = SpotlightRender(uSpotlight4, vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, UV);
-	vec3 SpotColor5 = SpotlightRender(uSpotlight5, vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, UV);
-	
-	vec3 FinalColor = DirColor + PtColor + SpotColor + SpotColor1 + SpotColor2 + SpotColor3 + SpotColor4 + SpotColor5;
+	vec3 SpotColor = vec3(0.0f);
+	for (int SpotIdx = 0; SpotIdx < SPOTLIGHT_COUNT; ++SpotIdx) {
+		SpotColor += SpotlightRender(uSpotlights[SpotIdx], vWorldSpaceFragment, vWorldSpaceNormal, ViewDirection, uMaterial, DiffuseUV, SpecularUV);
+	}
+
+	vec3 FinalColor = DirColor + PtColor + SpotColor;
 	FragColor = vec4(FinalColor, 1.0f);
 }
@@ -1,36 +1,63 @@
 #include "texture.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-unsigned
+GLTexture
 Texture::LoadImageToTexture(const std::string& filePath) {
-    int TextureWidth;
-    int TextureHeight;
-    int TextureChannels;
+    PROFILE_FUNCTION();
+    TextureImage Image;
+    if (!DecodeImage(filePath, Image)) {
+        return GLTexture();
+    }
+
+    GLTexture Texture = UploadImage(Image);
+    // NOTE(Jovan): ImageData is no longer necessary in RAM and can be deallocated
+    FreeImage(Image);
+    return Texture;
+}
+
+bool
+Texture::DecodeImage(const std::string& filePath, TextureImage& image) {
+    PROFILE_FUNCTION();
     std::cout << "Loading texture: " << filePath << std::endl;
-    unsigned char* ImageData = stbi_load(filePath.c_str(), &TextureWidth, &TextureHeight, &TextureChannels, 0);
+    image.mPath = filePath;
+    image.mData = stbi_load(filePath.c_str(), &image.mWidth, &image.mHeight, &image.mChannels, 0);
 
-    if (!ImageData) {
+    if (!image.mData) {
+        if (filePath == MISSING_TEXTURE_PATH) {
+            std::cerr << "[Err] Failed to load the missing texture " << MISSING_TEXTURE_PATH << std::endl;
+            return false;
+        }
         std::cerr << "Failed to load texture: " << filePath << " loading default instead" << std::endl;
-        return LoadImageToTexture(MISSING_TEXTURE_PATH);
+        return DecodeImage(MISSING_TEXTURE_PATH, image);
     }
 
     // NOTE(Jovan): Images should usually flipped vertically as they are loaded "upside-down"
-    stbi__vertical_flip(ImageData, TextureWidth, TextureHeight, TextureChannels);
+    stbi__vertical_flip(image.mData, image.mWidth, image.mHeight, image.mChannels);
+    return true;
+}
 
+GLTexture
+Texture::UploadImage(const TextureImage& image) {
+    PROFILE_ZONE("Texture upload");
     // NOTE(Jovan): Checks or "guesses" the loaded image's format
     GLint InternalFormat = -1;
-    switch (TextureChannels) {
+    switch (image.mChannels) {
     case 1: InternalFormat = GL_RED; break;
     case 3: InternalFormat = GL_RGB; break;
     case 4: InternalFormat = GL_RGBA; break;
     default: InternalFormat = GL_RGB; break;
     }
 
-    unsigned Texture;
-    glGenTextures(1, &Texture);
-    glBindTexture(GL_TEXTURE_2D, Texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, TextureWidth, TextureHeight, 0, InternalFormat, GL_UNSIGNED_BYTE, ImageData);
+    GLTexture Texture = GLTexture::Create();
+    glBindTexture(GL_TEXTURE_2D, Texture.Get());
+    glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, image.mWidth, image.mHeight, 0, InternalFormat, GL_UNSIGNED_BYTE, image.mData);
+    FrameStats::CountUploadBytes((unsigned long long)image.mWidth * image.mHeight * image.mChannels);
+    // NOTE: Drivers pad three channel textures to four bytes per texel
+    Texture.Track(MEMORY_TEXTURE, MemoryTracker::TextureBytes(image.mWidth, image.mHeight, image.mChannels == 1 ? 1 : 4, true), image.mPath);
     glGenerateMipmap(GL_TEXTURE_2D);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -38,7 +65,11 @@ Texture::LoadImageToTexture(const std::string& filePath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_2D, 0);
-    // NOTE(Jovan): ImageData is no longer necessary in RAM and can be deallocated
-    stbi_image_free(ImageData);
     return Texture;
-}
\ No newline at end of file
+}
+
+void
+Texture::FreeImage(TextureImage& image) {
+    stbi_image_free(image.mData);
+    image.mData = 0;
+}
@@ -2,9 +2,19 @@
 #include <string>
 #include <GL/glew.h>
 #include <iostream>
+#include "gl_handle.hpp"
 
 static const std::string MISSING_TEXTURE_PATH = "res/missing_texture.png";
 
+// NOTE: Decoded pixels waiting for upload. Decoding needs no GL context, so it can run on any thread
+struct TextureImage {
+	unsigned char* mData;
+	int mWidth;
+	int mHeight;
+	int mChannels;
+	std::string mPath;
+};
+
 class Texture {
 public:
 	/**
@@ -14,7 +24,26 @@ public:
 	 * negated with the addition of loss of quality
 	 *
 	 * @param filePath Image file path
-	 * @returns TextureID
+	 * @returns Texture handle, empty when even the fallback failed to load
+	 */
+	static GLTexture LoadImageToTexture(const std::string& filePath);
+
+	/**
+	 * @brief Decodes and flips an image file, falling back to the missing texture. Thread safe
+	 *
+	 * @param filePath Image file path
+	 * @param image Receives the pixels, release them with FreeImage
+	 * @returns true - Success, false - Neither the file nor the fallback could be decoded
+	 */
+	static bool DecodeImage(const std::string& filePath, TextureImage& image);
+
+	/**
+	 * @brief Creates a mipmapped OpenGL texture from decoded pixels. Requires a current GL context
+	 *
+	 * @param image Decoded image, stays owned by the caller
+	 * @returns Texture handle, accounted to the texture memory category
 	 */
-	static unsigned LoadImageToTexture(const std::string& filePath);
+	static GLTexture UploadImage(const TextureImage& image);
+
+	static void FreeImage(TextureImage& image);
 };
@@ -0,0 +1,490 @@
+#include "texture_packer.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
+#include <algorithm>
+#include <cstdint>
+
+static unsigned
+AlignUp(unsigned value, unsigned alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+TexturePacker::TexturePacker() {
+    mAtlasTextureCount = 0;
+}
+
+TexturePacker::~TexturePacker() {
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        trackPixels(mArrays[ArrayIdx], false);
+    }
+}
+
+unsigned
+TexturePacker::Add(const TextureImage& image, bool repeats) {
+    PackerEntry Entry = { &image, { 0, 0, 0, 255 }, repeats, { 0, 0, glm::vec4(1.0f, 1.0f, 0.0f, 0.0f) }, 0, 0 };
+    mEntries.push_back(Entry);
+    return mEntries.size() - 1;
+}
+
+unsigned
+TexturePacker::AddColor(unsigned char r, unsigned char g, unsigned char b) {
+    PackerEntry Entry = { 0, { r, g, b, 255 }, false, { 0, 0, glm::vec4(1.0f, 1.0f, 0.0f, 0.0f) }, 0, 0 };
+    mEntries.push_back(Entry);
+    return mEntries.size() - 1;
+}
+
+void
+TexturePacker::Pack() {
+    PROFILE_FUNCTION();
+    std::vector<unsigned> AtlasEntries;
+    for (unsigned EntryIdx = 0; EntryIdx < mEntries.size(); ++EntryIdx) {
+        PackerEntry& Entry = mEntries[EntryIdx];
+        unsigned Width = getWidth(Entry);
+        unsigned Height = getHeight(Entry);
+        if (!Entry.mRepeats && Width <= ATLAS_MAX_TEXTURE_SIZE && Height <= ATLAS_MAX_TEXTURE_SIZE) {
+            AtlasEntries.push_back(EntryIdx);
+            continue;
+        }
+
+        Entry.mSlot.mArray = findArray(Width, Height, false);
+        Entry.mSlot.mLayer = mArrays[Entry.mSlot.mArray].mLayerCount++;
+        Entry.mSlot.mRect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+    }
+    packAtlas(AtlasEntries);
+    mAtlasTextureCount = AtlasEntries.size();
+
+    // NOTE: Atlas pages stop at the last mip their gutters cover, everything else goes down to one texel
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        PackedArray& Array = mArrays[ArrayIdx];
+        unsigned Largest = std::max(Array.mWidth, Array.mHeight);
+        Array.mLevelCount = Array.mAtlas ? ATLAS_MIP_LEVELS + 1 : 1;
+        while (!Array.mAtlas && (Largest >> Array.mLevelCount)) {
+            ++Array.mLevelCount;
+        }
+
+        size_t Size = 0;
+        Array.mLevelOffsets.resize(Array.mLevelCount);
+        for (unsigned Level = 0; Level < Array.mLevelCount; ++Level) {
+            Array.mLevelOffsets[Level] = Size;
+            Size += getLevelSize(Array, Level);
+        }
+        Array.mPixels.assign(Size, 0);
+    }
+    for (unsigned EntryIdx = 0; EntryIdx < mEntries.size(); ++EntryIdx) {
+        copyEntry(mEntries[EntryIdx], mArrays[mEntries[EntryIdx].mSlot.mArray]);
+    }
+
+    mRequestedLevels.reset(new std::atomic<unsigned>[mArrays.size()]);
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        buildMips(mArrays[ArrayIdx]);
+        trackPixels(mArrays[ArrayIdx], true);
+        mRequestedLevels[ArrayIdx] = NO_LEVEL_REQUEST;
+    }
+}
+
+void
+TexturePacker::buildMips(PackedArray& array) {
+    // NOTE: 2x2 box filter per level. Odd sizes clamp the second texel, which is what the GL does
+    for (unsigned Level = 1; Level < array.mLevelCount; ++Level) {
+        unsigned SourceWidth = getLevelWidth(array, Level - 1);
+        unsigned SourceHeight = getLevelHeight(array, Level - 1);
+        unsigned Width = getLevelWidth(array, Level);
+        unsigned Height = getLevelHeight(array, Level);
+        for (unsigned Layer = 0; Layer < array.mLayerCount; ++Layer) {
+            const unsigned char* Source = array.mPixels.data() + array.mLevelOffsets[Level - 1] + (size_t)SourceWidth * SourceHeight * 4 * Layer;
+            unsigned char* Out = array.mPixels.data() + array.mLevelOffsets[Level] + (size_t)Width * Height * 4 * Layer;
+            for (unsigned Row = 0; Row < Height; ++Row) {
+                const unsigned char* Top = Source + (size_t)std::min(Row * 2, SourceHeight - 1) * SourceWidth * 4;
+                const unsigned char* Bottom = Source + (size_t)std::min(Row * 2 + 1, SourceHeight - 1) * SourceWidth * 4;
+                for (unsigned Column = 0; Column < Width; ++Column) {
+                    unsigned Left = std::min(Column * 2, SourceWidth - 1) * 4;
+                    unsigned Right = std::min(Column * 2 + 1, SourceWidth - 1) * 4;
+                    for (unsigned Channel = 0; Channel < 4; ++Channel) {
+                        Out[Channel] = (unsigned char)((Top[Left + Channel] + Top[Right + Channel]
+                            + Bottom[Left + Channel] + Bottom[Right + Channel] + 2) / 4);
+                    }
+                    Out += 4;
+                }
+            }
+        }
+    }
+}
+
+void
+TexturePacker::packAtlas(std::vector<unsigned>& entries) {
+    if (entries.empty()) {
+        return;
+    }
+
+    // NOTE: Shelf packing, tallest first so each shelf wastes little height
+    const std::vector<PackerEntry>& Entries = mEntries;
+    std::stable_sort(entries.begin(), entries.end(), [&Entries](unsigned a, unsigned b) {
+        return getHeight(Entries[a]) > getHeight(Entries[b]);
+    });
+
+    unsigned Array = findArray(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, true);
+    unsigned Layer = 0;
+    unsigned X = 0;
+    unsigned Y = 0;
+    unsigned ShelfHeight = 0;
+    bool HasPage = false;
+    for (unsigned Idx = 0; Idx < entries.size(); ++Idx) {
+        PackerEntry& Entry = mEntries[entries[Idx]];
+        // NOTE: Cells start on multiples of the gutter, so texels of the last atlas mip never straddle two cells
+        unsigned CellWidth = AlignUp(getWidth(Entry) + 2 * ATLAS_GUTTER, ATLAS_GUTTER);
+        unsigned CellHeight = AlignUp(getHeight(Entry) + 2 * ATLAS_GUTTER, ATLAS_GUTTER);
+        if (HasPage && X + CellWidth > ATLAS_PAGE_SIZE) {
+            X = 0;
+            Y += ShelfHeight;
+            ShelfHeight = 0;
+        }
+        if (!HasPage || Y + CellHeight > ATLAS_PAGE_SIZE) {
+            Layer = mArrays[Array].mLayerCount++;
+            HasPage = true;
+            X = 0;
+            Y = 0;
+            ShelfHeight = 0;
+        }
+
+        Entry.mX = X;
+        Entry.mY = Y;
+        Entry.mSlot.mArray = Array;
+        Entry.mSlot.mLayer = Layer;
+        Entry.mSlot.mRect = glm::vec4((float)getWidth(Entry) / ATLAS_PAGE_SIZE, (float)getHeight(Entry) / ATLAS_PAGE_SIZE,
+            (float)(X + ATLAS_GUTTER) / ATLAS_PAGE_SIZE, (float)(Y + ATLAS_GUTTER) / ATLAS_PAGE_SIZE);
+        if (!Entry.mImage) {
+            Entry.mSlot.mRect = glm::vec4(0.0f, 0.0f, (X + ATLAS_GUTTER + 0.5f) / ATLAS_PAGE_SIZE, (Y + ATLAS_GUTTER + 0.5f) / ATLAS_PAGE_SIZE);
+        }
+        X += CellWidth;
+        ShelfHeight = CellHeight > ShelfHeight ? CellHeight : ShelfHeight;
+    }
+}
+
+void
+TexturePacker::copyEntry(const PackerEntry& entry, PackedArray& array) {
+    unsigned Width = getWidth(entry);
+    unsigned Height = getHeight(entry);
+    unsigned Gutter = array.mAtlas ? ATLAS_GUTTER : 0;
+    const TextureImage* Image = entry.mImage;
+    unsigned Channels = Image ? Image->mChannels : 4;
+    const unsigned char* Source = Image ? Image->mData : entry.mColor;
+    unsigned char* Layer = array.mPixels.data() + (size_t)array.mWidth * array.mHeight * 4 * entry.mSlot.mLayer;
+
+    // NOTE: The gutter repeats the nearest edge texel, so filtering across the rect border sees the
+    // same colours clamping would
+    for (unsigned Row = 0; Row < Height + 2 * Gutter; ++Row) {
+        unsigned SourceRow = Row < Gutter ? 0 : Row - Gutter >= Height ? Height - 1 : Row - Gutter;
+        unsigned char* Out = Layer + ((size_t)(entry.mY + Row) * array.mWidth + entry.mX) * 4;
+        for (unsigned Column = 0; Column < Width + 2 * Gutter; ++Column) {
+            unsigned SourceColumn = Column < Gutter ? 0 : Column - Gutter >= Width ? Width - 1 : Column - Gutter;
+            const unsigned char* Texel = Source + ((size_t)SourceRow * Width + SourceColumn) * Channels;
+            // NOTE: Expanded the way GL expands GL_RED and GL_RGB, so shading stays the same
+            Out[0] = Texel[0];
+            Out[1] = Channels > 1 ? Texel[1] : 0;
+            Out[2] = Channels > 2 ? Texel[2] : 0;
+            Out[3] = Channels > 3 ? Texel[3] : 255;
+            Out += 4;
+        }
+    }
+}
+
+void
+TexturePacker::Upload() {
+    PROFILE_ZONE("Texture array upload");
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        PackedArray& Array = mArrays[ArrayIdx];
+        Array.mTexture = GLTexture::Create();
+        Array.mSamplerObject = SamplerCache::Resolve(Array.mSampler);
+        // NOTE: Filtering and wrapping come from the array's sampler, the texture keeps only its
+        // level range. Nothing is allocated yet, SetAllocatedLevel creates the initial levels
+        Array.mAllocatedLevel = Array.mLevelCount;
+        Array.mResidentLevel = GetInitialLevel(ArrayIdx);
+        Array.mStreamedLayers = 0;
+        Array.mWantedLevel = Array.mResidentLevel;
+        Array.mIdleFrames = 0;
+        SetAllocatedLevel(ArrayIdx, Array.mResidentLevel);
+    }
+}
+
+void
+TexturePacker::Destroy() {
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        trackPixels(mArrays[ArrayIdx], false);
+    }
+    mEntries.clear();
+    mArrays.clear();
+    mRequestedLevels.reset();
+    mAtlasTextureCount = 0;
+}
+
+const TextureSlot&
+TexturePacker::GetSlot(unsigned handle) const {
+    return mEntries[handle].mSlot;
+}
+
+unsigned
+TexturePacker::GetTexture(unsigned array) const {
+    return array < mArrays.size() ? mArrays[array].mTexture.Get() : 0;
+}
+
+unsigned
+TexturePacker::GetSampler(unsigned array) const {
+    return array < mArrays.size() ? mArrays[array].mSampler : SamplerCache::INVALID_SAMPLER;
+}
+
+unsigned
+TexturePacker::GetSamplerObject(unsigned array) const {
+    return array < mArrays.size() ? mArrays[array].mSamplerObject : 0;
+}
+
+unsigned
+TexturePacker::GetArrayCount() const {
+    return mArrays.size();
+}
+
+unsigned
+TexturePacker::GetLayerCount() const {
+    unsigned Count = 0;
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        Count += mArrays[ArrayIdx].mLayerCount;
+    }
+    return Count;
+}
+
+unsigned
+TexturePacker::GetTextureCount() const {
+    return mEntries.size();
+}
+
+unsigned
+TexturePacker::GetAtlasTextureCount() const {
+    return mAtlasTextureCount;
+}
+
+void
+TexturePacker::RequestLevel(unsigned array, float uvPerPixel) {
+    if (array >= mArrays.size() || !(uvPerPixel > 0.0f)) {
+        return;
+    }
+
+    // NOTE: Trilinear filtering blends the level below log2 of the footprint with the one after it.
+    // Halving instead of log2 keeps huge footprints of draws behind the camera clamped
+    const PackedArray& Array = mArrays[array];
+    float Texels = uvPerPixel * std::max(Array.mWidth, Array.mHeight);
+    unsigned Level = 0;
+    while (Level + 1 < Array.mLevelCount && Texels >= 2.0f) {
+        Texels *= 0.5f;
+        ++Level;
+    }
+    std::atomic<unsigned>& Requested = mRequestedLevels[array];
+    unsigned Current = Requested.load(std::memory_order_relaxed);
+    while (Level < Current && !Requested.compare_exchange_weak(Current, Level, std::memory_order_relaxed)) {
+    }
+}
+
+void
+TexturePacker::RequestSlotLevel(unsigned handle, float uvPerPixel) {
+    const TextureSlot& Slot = GetSlot(handle);
+    RequestLevel(Slot.mArray, uvPerPixel * std::max(Slot.mRect.x, Slot.mRect.y));
+}
+
+unsigned
+TexturePacker::UpdateWantedLevel(unsigned array, unsigned evictDelay) {
+    PackedArray& Array = mArrays[array];
+    unsigned Initial = GetInitialLevel(array);
+    unsigned Requested = mRequestedLevels[array].exchange(NO_LEVEL_REQUEST, std::memory_order_relaxed);
+    unsigned Level = Requested < Initial ? Requested : Initial;
+    if (Level <= Array.mWantedLevel || ++Array.mIdleFrames >= evictDelay) {
+        Array.mWantedLevel = Level;
+        Array.mIdleFrames = 0;
+    }
+    return Array.mWantedLevel;
+}
+
+unsigned
+TexturePacker::GetLevelCount(unsigned array) const {
+    return mArrays[array].mLevelCount;
+}
+
+unsigned
+TexturePacker::GetInitialLevel(unsigned array) const {
+    const PackedArray& Array = mArrays[array];
+    unsigned Level = 0;
+    while (Level + 1 < Array.mLevelCount && std::max(getLevelWidth(Array, Level), getLevelHeight(Array, Level)) > STREAM_INITIAL_SIZE) {
+        ++Level;
+    }
+    return Level;
+}
+
+unsigned
+TexturePacker::GetAllocatedLevel(unsigned array) const {
+    return mArrays[array].mAllocatedLevel;
+}
+
+unsigned
+TexturePacker::GetResidentLevel(unsigned array) const {
+    return mArrays[array].mResidentLevel;
+}
+
+unsigned long long
+TexturePacker::GetLevelBytes(unsigned array, unsigned level) const {
+    const PackedArray& Array = mArrays[array];
+    unsigned long long Bytes = 0;
+    for (unsigned Level = level; Level < Array.mLevelCount; ++Level) {
+        Bytes += getLevelSize(Array, Level);
+    }
+    return Bytes;
+}
+
+unsigned long long
+TexturePacker::SetAllocatedLevel(unsigned array, unsigned level) {
+    PackedArray& Array = mArrays[array];
+    if (!Array.mTexture.Get() || level >= Array.mLevelCount || level == Array.mAllocatedLevel) {
+        return 0;
+    }
+
+    // NOTE: GL 3.3 can't free single levels of a texture, so the whole chain is redefined with
+    // level as its first. The name stays the same, recorded binds and meshes keep working
+    unsigned Last = Array.mLevelCount - 1;
+    unsigned PreviousLevels = Array.mAllocatedLevel < Array.mLevelCount ? Array.mLevelCount - Array.mAllocatedLevel : 0;
+    Array.mResidentLevel = std::max(Array.mResidentLevel, level);
+    Array.mStreamedLayers = 0;
+    unsigned long long Uploaded = 0;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, Array.mTexture.Get());
+    for (unsigned Level = level; Level <= Last; ++Level) {
+        bool Resident = Level >= Array.mResidentLevel;
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, Level - level, GL_RGBA8, getLevelWidth(Array, Level), getLevelHeight(Array, Level), Array.mLayerCount,
+            0, GL_RGBA, GL_UNSIGNED_BYTE, Resident ? Array.mPixels.data() + Array.mLevelOffsets[Level] : 0);
+        Uploaded += Resident ? getLevelSize(Array, Level) : 0;
+    }
+    // NOTE: Levels past the shorter chain are redefined empty, otherwise their storage stays around
+    for (unsigned GLLevel = Last - level + 1; GLLevel < PreviousLevels; ++GLLevel) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, GLLevel, GL_RGBA8, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, Array.mResidentLevel - level);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, Last - level);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    Array.mAllocatedLevel = level;
+
+    // NOTE: Resizing keeps the owner string, so residency changes inside a frame don't allocate
+    FrameStats::CountUploadBytes(Uploaded);
+    if (PreviousLevels) {
+        Array.mTexture.Resize(GetLevelBytes(array, level));
+    } else {
+        Array.mTexture.Track(MEMORY_TEXTURE, GetLevelBytes(array, level),
+            Array.mAtlas ? "Texture atlas" : "Texture array " + std::to_string(Array.mWidth) + "x" + std::to_string(Array.mHeight));
+    }
+    return Uploaded;
+}
+
+unsigned long long
+TexturePacker::StreamLayer(unsigned array) {
+    PackedArray& Array = mArrays[array];
+    if (!Array.mTexture.Get() || Array.mResidentLevel <= Array.mAllocatedLevel) {
+        return 0;
+    }
+
+    unsigned Level = Array.mResidentLevel - 1;
+    unsigned Width = getLevelWidth(Array, Level);
+    unsigned Height = getLevelHeight(Array, Level);
+    size_t LayerSize = (size_t)Width * Height * 4;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, Array.mTexture.Get());
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, Level - Array.mAllocatedLevel, 0, 0, Array.mStreamedLayers, Width, Height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+        Array.mPixels.data() + Array.mLevelOffsets[Level] + LayerSize * Array.mStreamedLayers);
+    // NOTE: Sampling only reaches the level once every layer of it holds pixels
+    if (++Array.mStreamedLayers == Array.mLayerCount) {
+        Array.mStreamedLayers = 0;
+        Array.mResidentLevel = Level;
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, Level - Array.mAllocatedLevel);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    FrameStats::CountUploadBytes(LayerSize);
+    return LayerSize;
+}
+
+MaterialBlock
+TexturePacker::MakeMaterial(unsigned diffuse, unsigned specular) const {
+    const TextureSlot& Diffuse = GetSlot(diffuse);
+    const TextureSlot& Specular = GetSlot(specular);
+    MaterialBlock Block;
+    Block.DiffuseRect = Diffuse.mRect;
+    Block.SpecularRect = Specular.mRect;
+    Block.Layers = glm::vec4((float)Diffuse.mLayer, (float)Specular.mLayer, 0.0f, 0.0f);
+    return Block;
+}
+
+glm::vec4
+TexturePacker::RebaseRect(const glm::vec4& rect, const glm::vec4& base) {
+    float ScaleX = rect.x / base.x;
+    float ScaleY = rect.y / base.y;
+    return glm::vec4(ScaleX, ScaleY, rect.z - base.z * ScaleX, rect.w - base.w * ScaleY);
+}
+
+unsigned
+TexturePacker::findArray(unsigned width, unsigned height, bool atlas) {
+    for (unsigned ArrayIdx = 0; ArrayIdx < mArrays.size(); ++ArrayIdx) {
+        const PackedArray& Array = mArrays[ArrayIdx];
+        if (Array.mWidth == width && Array.mHeight == height && Array.mAtlas == atlas) {
+            return ArrayIdx;
+        }
+    }
+
+    mArrays.push_back(PackedArray());
+    PackedArray& Array = mArrays.back();
+    Array.mWidth = width;
+    Array.mHeight = height;
+    Array.mAtlas = atlas;
+    Array.mLevelCount = 0;
+    Array.mLayerCount = 0;
+    Array.mAllocatedLevel = 0;
+    Array.mResidentLevel = 0;
+    Array.mStreamedLayers = 0;
+    Array.mWantedLevel = 0;
+    Array.mIdleFrames = 0;
+    // NOTE: Atlas pages can't wrap, their rects sit inside the page and gutters cover the edges
+    SamplerDesc Desc = { SAMPLER_FILTER_TRILINEAR, GL_NEAREST, (unsigned)(atlas ? GL_CLAMP_TO_EDGE : GL_REPEAT), 16, 0.0f };
+    Array.mSampler = SamplerCache::Get(Desc);
+    Array.mSamplerObject = 0;
+    return mArrays.size() - 1;
+}
+
+void
+TexturePacker::trackPixels(const PackedArray& array, bool track) {
+    if (array.mPixels.empty()) {
+        return;
+    }
+
+    // NOTE: Keyed by the buffer address, the copy has no GL name of its own
+    unsigned long long Id = (unsigned long long)(uintptr_t)array.mPixels.data();
+    if (track) {
+        MemoryTracker::Track(MEMORY_STAGING, Id, array.mPixels.size(), "Texture stream source");
+    } else {
+        MemoryTracker::Untrack(MEMORY_STAGING, Id);
+    }
+}
+
+unsigned
+TexturePacker::getLevelWidth(const PackedArray& array, unsigned level) {
+    return std::max(array.mWidth >> level, 1u);
+}
+
+unsigned
+TexturePacker::getLevelHeight(const PackedArray& array, unsigned level) {
+    return std::max(array.mHeight >> level, 1u);
+}
+
+unsigned long long
+TexturePacker::getLevelSize(const PackedArray& array, unsigned level) {
+    return (unsigned long long)getLevelWidth(array, level) * getLevelHeight(array, level) * 4 * array.mLayerCount;
+}
+
+unsigned
+TexturePacker::getWidth(const PackerEntry& entry) {
+    return entry.mImage ? entry.mImage->mWidth : 1;
+}
+
+unsigned
+TexturePacker::getHeight(const PackerEntry& entry) {
+    return entry.mImage ? entry.mImage->mHeight : 1;
+}
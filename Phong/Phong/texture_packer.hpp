@@ -0,0 +1,253 @@
+/**
+ * @file texture_packer.hpp
+ * @brief Packs material textures into texture array layers and atlas pages, so draws stop rebinding textures
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <glm/glm.hpp>
+#include "texture.hpp"
+#include "gl_handle.hpp"
+#include "sampler_cache.hpp"
+
+// NOTE: Where a packed texture ended up. Rect maps the texture's own UVs into the layer, xy scale and zw offset
+struct TextureSlot {
+    unsigned mArray;
+    unsigned mLayer;
+    glm::vec4 mRect;
+};
+
+// NOTE: Per draw texture placement, std140 layout of the PerMaterial uniform block
+struct MaterialBlock {
+    glm::vec4 DiffuseRect;
+    glm::vec4 SpecularRect;
+    // NOTE: x diffuse layer, y specular layer
+    glm::vec4 Layers;
+};
+
+/**
+ * @brief Collects decoded textures and places them into GL_TEXTURE_2D_ARRAY textures. Textures up to
+ * ATLAS_MAX_TEXTURE_SIZE that are never sampled outside [0, 1] are packed into atlas pages, with gutters
+ * of replicated edge texels and rects aligned so the first ATLAS_MIP_LEVELS mips never mix neighbours.
+ * Larger or repeating textures get a whole layer of an array shared with every texture of the same size.
+ * Everything is stored as RGBA8 so any two textures can share an array.
+ * Pack builds the whole mip chain in system memory and Upload only creates the levels up to
+ * STREAM_INITIAL_SIZE. Finer levels are streamed in and evicted again per array by a TextureStreamer,
+ * the texture's base level hides whatever isn't uploaded yet.
+ * Add and Pack need no GL context, Upload, Destroy and the residency changes do
+ */
+class TexturePacker {
+public:
+    static const unsigned ATLAS_PAGE_SIZE = 2048;
+    static const unsigned ATLAS_MAX_TEXTURE_SIZE = 1024;
+    static const unsigned ATLAS_MIP_LEVELS = 4;
+    // NOTE: One texel of gutter survives down to the last atlas mip
+    static const unsigned ATLAS_GUTTER = 1 << ATLAS_MIP_LEVELS;
+    // NOTE: Largest side of the finest level Upload creates, everything finer is streamed
+    static const unsigned STREAM_INITIAL_SIZE = 128;
+    static const unsigned NO_LEVEL_REQUEST = 0xFFFFFFFF;
+
+    TexturePacker();
+    ~TexturePacker();
+    TexturePacker(TexturePacker&& other) = default;
+    TexturePacker& operator=(TexturePacker&& other) = default;
+    TexturePacker(const TexturePacker&) = delete;
+    TexturePacker& operator=(const TexturePacker&) = delete;
+
+    /**
+     * @brief Queues a decoded image for packing
+     *
+     * @param image Decoded image, has to stay alive until Pack returns
+     * @param repeats Whether the texture is sampled outside [0, 1], which keeps it out of the atlas
+     * @returns Handle for GetSlot
+     */
+    unsigned Add(const TextureImage& image, bool repeats);
+
+    /**
+     * @brief Queues a single texel texture of one colour, for material slots without a texture.
+     * Its rect has zero scale, so every UV reads the colour
+     *
+     */
+    unsigned AddColor(unsigned char r, unsigned char g, unsigned char b);
+
+    /**
+     * @brief Places every queued texture and copies its pixels into the layers. The source images
+     * can be freed afterwards
+     *
+     */
+    void Pack();
+
+    /**
+     * @brief Creates the array textures with the levels up to STREAM_INITIAL_SIZE. The packed pixels
+     * stay in system memory as the source of the finer levels. Requires a current GL context
+     *
+     */
+    void Upload();
+
+    /**
+     * @brief Deletes the array textures and drops everything queued
+     *
+     */
+    void Destroy();
+
+    const TextureSlot& GetSlot(unsigned handle) const;
+
+    /**
+     * @brief GL name of an array, valid after Upload
+     *
+     */
+    unsigned GetTexture(unsigned array) const;
+
+    /**
+     * @brief SamplerCache id an array is sampled with. Atlas pages clamp, everything else repeats
+     *
+     */
+    unsigned GetSampler(unsigned array) const;
+
+    /**
+     * @brief GL name of the sampler an array is sampled with, valid after Upload
+     *
+     */
+    unsigned GetSamplerObject(unsigned array) const;
+    unsigned GetArrayCount() const;
+    unsigned GetLayerCount() const;
+    unsigned GetTextureCount() const;
+    unsigned GetAtlasTextureCount() const;
+
+    /**
+     * @brief Notes the finest level a draw samples from an array this frame. Thread safe, so
+     * chunks can request while they are recorded in parallel
+     *
+     * @param array Array index
+     * @param uvPerPixel Layer UV units one screen pixel covers, non positive values are ignored
+     */
+    void RequestLevel(unsigned array, float uvPerPixel);
+
+    /**
+     * @brief RequestLevel for the array of a slot, with UVs of the texture itself. Single colour
+     * slots never need more than their coarsest level and request nothing
+     *
+     */
+    void RequestSlotLevel(unsigned handle, float uvPerPixel);
+
+    /**
+     * @brief Consumes the requests of the frame and updates the level the array wants resident.
+     * Finer requests take effect right away, coarser ones only after evictDelay frames without
+     * a finer one, so textures don't thrash while the camera moves
+     *
+     * @returns Wanted level, never coarser than GetInitialLevel
+     */
+    unsigned UpdateWantedLevel(unsigned array, unsigned evictDelay);
+
+    unsigned GetLevelCount(unsigned array) const;
+
+    /**
+     * @brief Level Upload starts at, the coarsest the array is ever reduced to
+     *
+     */
+    unsigned GetInitialLevel(unsigned array) const;
+
+    /**
+     * @brief Finest level with storage on the GPU, level 0 of the GL texture
+     *
+     */
+    unsigned GetAllocatedLevel(unsigned array) const;
+
+    /**
+     * @brief Finest level holding pixels, the texture's base level points at it
+     *
+     */
+    unsigned GetResidentLevel(unsigned array) const;
+
+    /**
+     * @brief GPU bytes of the levels from level down to the last one, every layer included
+     *
+     */
+    unsigned long long GetLevelBytes(unsigned array, unsigned level) const;
+
+    /**
+     * @brief Redefines the texture to start at level. Coarser than now frees the finer levels
+     * right away, finer only allocates them, StreamLayer fills them in afterwards
+     *
+     * @returns Bytes uploaded, the resident levels are copied into the new storage
+     */
+    unsigned long long SetAllocatedLevel(unsigned array, unsigned level);
+
+    /**
+     * @brief Uploads one layer of the next finer allocated level. The base level moves once
+     * every layer of it is in
+     *
+     * @returns Bytes uploaded, 0 when every allocated level is resident
+     */
+    unsigned long long StreamLayer(unsigned array);
+
+    /**
+     * @brief Block for a draw sampling diffuse and specular from two slots with the mesh's own UVs
+     *
+     */
+    MaterialBlock MakeMaterial(unsigned diffuse, unsigned specular) const;
+
+    /**
+     * @brief Rect mapping the UVs of one slot into another, for meshes whose UVs were remapped
+     * into the first slot at import
+     *
+     */
+    static glm::vec4 RebaseRect(const glm::vec4& rect, const glm::vec4& base);
+
+private:
+    struct PackerEntry {
+        // NOTE: Pixels of the source image, or mColor for single colour entries
+        const TextureImage* mImage;
+        unsigned char mColor[4];
+        bool mRepeats;
+        TextureSlot mSlot;
+        // NOTE: Top left texel of the copy in its layer, gutter included
+        unsigned mX;
+        unsigned mY;
+    };
+
+    struct PackedArray {
+        unsigned mWidth;
+        unsigned mHeight;
+        bool mAtlas;
+        // NOTE: RGBA8 pixels of every level, each level holding all layers, finest first
+        std::vector<unsigned char> mPixels;
+        std::vector<size_t> mLevelOffsets;
+        unsigned mLevelCount;
+        unsigned mLayerCount;
+        unsigned mSampler;
+        // NOTE: Owned by the sampler cache, resolved once so recording and replay never look it up
+        unsigned mSamplerObject;
+        GLTexture mTexture;
+        unsigned mAllocatedLevel;
+        unsigned mResidentLevel;
+        // NOTE: Layers of the level above the resident one uploaded so far
+        unsigned mStreamedLayers;
+        unsigned mWantedLevel;
+        unsigned mIdleFrames;
+    };
+
+    std::vector<PackerEntry> mEntries;
+    std::vector<PackedArray> mArrays;
+    // NOTE: Finest level requested per array this frame, lowered with a CAS by recording threads
+    std::unique_ptr<std::atomic<unsigned>[]> mRequestedLevels;
+    unsigned mAtlasTextureCount;
+
+    unsigned findArray(unsigned width, unsigned height, bool atlas);
+    void packAtlas(std::vector<unsigned>& entries);
+    void copyEntry(const PackerEntry& entry, PackedArray& array);
+    void buildMips(PackedArray& array);
+    void trackPixels(const PackedArray& array, bool track);
+    static unsigned getLevelWidth(const PackedArray& array, unsigned level);
+    static unsigned getLevelHeight(const PackedArray& array, unsigned level);
+    static unsigned long long getLevelSize(const PackedArray& array, unsigned level);
+    static unsigned getWidth(const PackerEntry& entry);
+    static unsigned getHeight(const PackerEntry& entry);
+};
@@ -0,0 +1,177 @@
+#include "texture_streamer.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+// NOTE: Distance of the near plane, nothing closer is visible
+static const float NEAR_DISTANCE = 0.1f;
+
+TextureStreamer::TextureStreamer() {
+    mBudget = (unsigned long long)DEFAULT_BUDGET_MB * 1024 * 1024;
+    mStats = { 0 };
+    mStats.mBudgetBytes = mBudget;
+}
+
+void
+TextureStreamer::SetBudget(unsigned long long bytes) {
+    mBudget = bytes;
+    mStats.mBudgetBytes = bytes;
+}
+
+unsigned long long
+TextureStreamer::GetBudget() const {
+    return mBudget;
+}
+
+void
+TextureStreamer::Update(TexturePacker* const* packers, unsigned packerCount) {
+    PROFILE_FUNCTION();
+    mArrays.clear();
+    for (unsigned PackerIdx = 0; PackerIdx < packerCount; ++PackerIdx) {
+        TexturePacker* Packer = packers[PackerIdx];
+        for (unsigned ArrayIdx = 0; ArrayIdx < Packer->GetArrayCount(); ++ArrayIdx) {
+            if (!Packer->GetTexture(ArrayIdx)) {
+                continue;
+            }
+            StreamedArray Array = { Packer, ArrayIdx, Packer->UpdateWantedLevel(ArrayIdx, EVICT_DELAY_FRAMES), Packer->GetInitialLevel(ArrayIdx) };
+            mArrays.push_back(Array);
+        }
+    }
+    if (applyBudget() > mBudget) {
+        ++mStats.mOverBudgetFrames;
+    }
+
+    // NOTE: Evictions first, so the memory they free is gone before anything grows into it
+    unsigned long long Uploaded = 0;
+    for (unsigned Idx = 0; Idx < mArrays.size(); ++Idx) {
+        const StreamedArray& Array = mArrays[Idx];
+        unsigned Allocated = Array.mPacker->GetAllocatedLevel(Array.mArray);
+        if (Array.mLevel > Allocated) {
+            mStats.mEvictedLevels += Array.mLevel - Allocated;
+            Uploaded += Array.mPacker->SetAllocatedLevel(Array.mArray, Array.mLevel);
+        }
+    }
+    for (unsigned Idx = 0; Idx < mArrays.size(); ++Idx) {
+        const StreamedArray& Array = mArrays[Idx];
+        if (Array.mLevel < Array.mPacker->GetAllocatedLevel(Array.mArray)) {
+            Uploaded += Array.mPacker->SetAllocatedLevel(Array.mArray, Array.mLevel);
+        }
+    }
+    Uploaded = streamLayers(Uploaded);
+
+    mStats.mAllocatedBytes = 0;
+    mStats.mResidentBytes = 0;
+    mStats.mFullBytes = 0;
+    mStats.mSettledArrays = 0;
+    for (unsigned Idx = 0; Idx < mArrays.size(); ++Idx) {
+        const StreamedArray& Array = mArrays[Idx];
+        unsigned Resident = Array.mPacker->GetResidentLevel(Array.mArray);
+        mStats.mAllocatedBytes += Array.mPacker->GetLevelBytes(Array.mArray, Array.mPacker->GetAllocatedLevel(Array.mArray));
+        mStats.mResidentBytes += Array.mPacker->GetLevelBytes(Array.mArray, Resident);
+        mStats.mFullBytes += Array.mPacker->GetLevelBytes(Array.mArray, 0);
+        mStats.mSettledArrays += Resident == Array.mLevel;
+    }
+    mStats.mArrayCount = mArrays.size();
+    mStats.mFrameUploadBytes = Uploaded;
+    mStats.mUploadBytes += Uploaded;
+    ++mStats.mFrames;
+}
+
+unsigned long long
+TextureStreamer::applyBudget() {
+    unsigned long long Total = 0;
+    for (unsigned Idx = 0; Idx < mArrays.size(); ++Idx) {
+        Total += mArrays[Idx].mPacker->GetLevelBytes(mArrays[Idx].mArray, mArrays[Idx].mLevel);
+    }
+
+    // NOTE: Drops the finest level that frees the most until everything fits. Large textures
+    // seen up close lose detail before small ones lose all of theirs
+    while (Total > mBudget) {
+        StreamedArray* Largest = 0;
+        unsigned long long LargestBytes = 0;
+        for (unsigned Idx = 0; Idx < mArrays.size(); ++Idx) {
+            StreamedArray& Array = mArrays[Idx];
+            if (Array.mLevel >= Array.mInitialLevel) {
+                continue;
+            }
+            unsigned long long Bytes = Array.mPacker->GetLevelBytes(Array.mArray, Array.mLevel)
+                - Array.mPacker->GetLevelBytes(Array.mArray, Array.mLevel + 1);
+            if (Bytes > LargestBytes) {
+                Largest = &Array;
+                LargestBytes = Bytes;
+            }
+        }
+        if (!Largest) {
+            break;
+        }
+        ++Largest->mLevel;
+        Total -= LargestBytes;
+    }
+    return Total;
+}
+
+unsigned long long
+TextureStreamer::streamLayers(unsigned long long uploaded) {
+    // NOTE: One layer per array and pass, so every array makes progress. The first layer goes up
+    // even when growing the storage already used the frame's budget, or big levels would never arrive
+    bool Streamed = false;
+    for (bool Progress = true; Progress && (uploaded < FRAME_UPLOAD_BYTES || !Streamed); ) {
+        Progress = false;
+        for (unsigned Idx = 0; Idx < mArrays.size() && (uploaded < FRAME_UPLOAD_BYTES || !Streamed); ++Idx) {
+            const StreamedArray& Array = mArrays[Idx];
+            unsigned Resident = Array.mPacker->GetResidentLevel(Array.mArray);
+            unsigned long long Bytes = Array.mPacker->StreamLayer(Array.mArray);
+            if (!Bytes) {
+                continue;
+            }
+            Progress = Streamed = true;
+            uploaded += Bytes;
+            mStats.mStreamedLevels += Array.mPacker->GetResidentLevel(Array.mArray) < Resident;
+        }
+    }
+    return uploaded;
+}
+
+const TextureStreamStats&
+TextureStreamer::GetStats() const {
+    return mStats;
+}
+
+void
+TextureStreamer::Report(std::ostream& output) const {
+    unsigned Frames = mStats.mFrames ? mStats.mFrames : 1;
+    std::ios::fmtflags Flags = output.flags();
+    output << std::fixed << std::setprecision(2);
+    output << "Texture streaming: " << mStats.mResidentBytes / (1024.0 * 1024.0) << " MB resident, "
+        << mStats.mAllocatedBytes / (1024.0 * 1024.0) << " MB allocated of " << mStats.mFullBytes / (1024.0 * 1024.0)
+        << " MB full chains, budget " << mStats.mBudgetBytes / (1024.0 * 1024.0) << " MB, " << mStats.mSettledArrays << "/"
+        << mStats.mArrayCount << " arrays settled, " << mStats.mUploadBytes / (1024.0 * 1024.0) << " MB uploaded ("
+        << mStats.mUploadBytes / 1024.0 / Frames << " KB/frame), " << mStats.mStreamedLevels << " levels streamed, "
+        << mStats.mEvictedLevels << " evicted, " << mStats.mOverBudgetFrames << " frames over budget" << std::endl;
+    output.flags(Flags);
+}
+
+float
+TextureStreamer::GetPixelScale(const glm::mat4& projection, int viewportHeight) {
+    return projection[1][1] * viewportHeight * 0.5f;
+}
+
+float
+TextureStreamer::GetPixelsPerUnit(const glm::mat4& model, const glm::vec3& center, float radius, const glm::vec3& camera, float pixelScale) {
+    // NOTE: Non uniform scales stretch the texture differently per axis, the median axis stands in
+    // for the footprint the sampler picks its mip from
+    float Scales[3];
+    for (unsigned Axis = 0; Axis < 3; ++Axis) {
+        const glm::vec4& Column = model[Axis];
+        Scales[Axis] = std::sqrt(Column.x * Column.x + Column.y * Column.y + Column.z * Column.z);
+    }
+    std::sort(Scales, Scales + 3);
+
+    glm::vec4 World = model * glm::vec4(center, 1.0f);
+    float X = World.x - camera.x;
+    float Y = World.y - camera.y;
+    float Z = World.z - camera.z;
+    float Distance = std::max(std::sqrt(X * X + Y * Y + Z * Z) - radius * Scales[2], NEAR_DISTANCE);
+    return pixelScale * Scales[1] / Distance;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file texture_streamer.hpp
+ * @brief Streams texture mips in and out per array, driven by the mips draws sample, under a GPU memory budget
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <ostream>
+#include <glm/glm.hpp>
+#include "texture_packer.hpp"
+
+struct TextureStreamStats {
+    unsigned long long mBudgetBytes;
+    // NOTE: GPU bytes of the allocated levels, what the budget limits
+    unsigned long long mAllocatedBytes;
+    // NOTE: Part of the allocated bytes already holding pixels
+    unsigned long long mResidentBytes;
+    // NOTE: GPU bytes every array would take with all of its levels
+    unsigned long long mFullBytes;
+    unsigned mArrayCount;
+    // NOTE: Arrays whose resident level reached the level the budget grants them
+    unsigned mSettledArrays;
+    unsigned long long mFrameUploadBytes;
+    unsigned long long mUploadBytes;
+    unsigned long long mStreamedLevels;
+    unsigned long long mEvictedLevels;
+    // NOTE: Frames where even the initial levels didn't fit the budget
+    unsigned mOverBudgetFrames;
+    unsigned mFrames;
+};
+
+/**
+ * @brief Decides which levels of every packed texture array stay on the GPU. Draws request the
+ * level they sample while they are recorded, Update turns the requests into wanted levels,
+ * coarsens the arrays that free the most until the budget holds, evicts and then streams the
+ * finer levels in a layer at a time under a per frame upload budget. Requests and budgets are
+ * counted in levels and bytes, never time, so headless runs stay repeatable
+ */
+class TextureStreamer {
+public:
+    static const unsigned DEFAULT_BUDGET_MB = 128;
+    // NOTE: Bytes streamed per frame, a few milliseconds of PCIe bandwidth at worst
+    static const unsigned FRAME_UPLOAD_BYTES = 4 * 1024 * 1024;
+    // NOTE: Frames an array keeps levels nobody samples anymore, about two seconds at 60 FPS
+    static const unsigned EVICT_DELAY_FRAMES = 120;
+
+    TextureStreamer();
+
+    /**
+     * @brief Sets the GPU bytes all streamed arrays may take together. Initial levels are always
+     * kept, a budget below them is exceeded rather than leaving textures empty
+     *
+     * @param bytes Budget in bytes
+     */
+    void SetBudget(unsigned long long bytes);
+    unsigned long long GetBudget() const;
+
+    /**
+     * @brief Applies the requests of the frame to every uploaded array of the packers. Must run on
+     * the thread owning the GL context, after the frame's draws were recorded
+     *
+     * @param packers Packers to stream, arrays not uploaded yet are skipped
+     * @param packerCount Number of packers
+     */
+    void Update(TexturePacker* const* packers, unsigned packerCount);
+
+    const TextureStreamStats& GetStats() const;
+
+    /**
+     * @brief Prints residency and bandwidth totals
+     *
+     * @param output Stream to write to
+     */
+    void Report(std::ostream& output) const;
+
+    /**
+     * @brief Screen pixels a world unit covers at distance 1, scaled down by distance for each draw
+     *
+     * @param projection Perspective projection of the frame
+     * @param viewportHeight Height of the viewport in pixels
+     */
+    static float GetPixelScale(const glm::mat4& projection, int viewportHeight);
+
+    /**
+     * @brief Screen pixels one object space unit of a draw covers at its point nearest the camera
+     *
+     * @param model Model matrix of the draw
+     * @param center Object space center of the bounding sphere
+     * @param radius Object space radius of the bounding sphere
+     * @param camera World space camera position
+     * @param pixelScale GetPixelScale of the frame
+     */
+    static float GetPixelsPerUnit(const glm::mat4& model, const glm::vec3& center, float radius, const glm::vec3& camera, float pixelScale);
+
+private:
+    struct StreamedArray {
+        TexturePacker* mPacker;
+        unsigned mArray;
+        // NOTE: Wanted level, coarsened by the budget pass
+        unsigned mLevel;
+        unsigned mInitialLevel;
+    };
+
+    // NOTE: Rebuilt every Update, the capacity is kept so frames don't allocate
+    std::vector<StreamedArray> mArrays;
+    unsigned long long mBudget;
+    TextureStreamStats mStats;
+
+    unsigned long long applyBudget();
+    unsigned long long streamLayers(unsigned long long uploaded);
+};
@@ -0,0 +1,248 @@
+#include "upload_ring.hpp"
+#include "profiler.hpp"
+#include "frame_stats.hpp"
+#include "memory_tracker.hpp"
+#include <chrono>
+#include <cstring>
+
+UploadRing::UploadRing() {
+    mBuffer = 0;
+    mMapped = 0;
+    mStaging = 0;
+    mPersistent = false;
+    mFrameSize = 0;
+    mFramesInFlight = 0;
+    mRegion = 0;
+    mHead = 0;
+    mFlushed = 0;
+    mUniformAlignment = 256;
+    mFrameCount = 0;
+    for (unsigned FenceIdx = 0; FenceIdx < MAX_FRAMES_IN_FLIGHT; ++FenceIdx) {
+        mFences[FenceIdx] = 0;
+    }
+    mFrameStats = { 0 };
+    mTotalStats = { 0 };
+}
+
+UploadRing::~UploadRing() {
+    Destroy();
+}
+
+bool
+UploadRing::Init(unsigned frameSize, unsigned framesInFlight) {
+    Destroy();
+    mFramesInFlight = framesInFlight < 1 ? 1 : framesInFlight > MAX_FRAMES_IN_FLIGHT ? MAX_FRAMES_IN_FLIGHT : framesInFlight;
+
+    int Alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+    mUniformAlignment = Alignment > 0 ? Alignment : 256;
+    // NOTE: Each region starts on a uniform offset boundary so any allocation can be bound as a UBO range
+    mFrameSize = (frameSize + mUniformAlignment - 1) & ~(mUniformAlignment - 1);
+    unsigned TotalSize = mFrameSize * mFramesInFlight;
+
+    glGenBuffers(1, &mBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+    mPersistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+    if (mPersistent) {
+        GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, TotalSize, 0, Flags);
+        mMapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, TotalSize, Flags);
+        if (!mMapped) {
+            std::cerr << "[Warn] Persistent mapping failed, falling back to glBufferSubData uploads" << std::endl;
+            glDeleteBuffers(1, &mBuffer);
+            glGenBuffers(1, &mBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+            mPersistent = false;
+        }
+    }
+
+    if (!mPersistent) {
+        glBufferData(GL_ARRAY_BUFFER, TotalSize, 0, GL_STREAM_DRAW);
+        mStaging = new unsigned char[TotalSize];
+        mMapped = mStaging;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "[Err] Failed to create upload ring of " << TotalSize << " bytes" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    MemoryTracker::Track(MEMORY_STREAM_BUFFER, mBuffer, TotalSize, "Upload ring");
+    if (mStaging) {
+        MemoryTracker::Track(MEMORY_STAGING, mBuffer, TotalSize, "Upload ring");
+    }
+
+    mRegion = 0;
+    mHead = 0;
+    mFlushed = 0;
+    std::cout << "Upload ring: " << mFramesInFlight << " x " << mFrameSize << " bytes, "
+        << (mPersistent ? "persistent mapping" : "glBufferSubData fallback") << std::endl;
+    return true;
+}
+
+void
+UploadRing::Destroy() {
+    for (unsigned FenceIdx = 0; FenceIdx < MAX_FRAMES_IN_FLIGHT; ++FenceIdx) {
+        if (mFences[FenceIdx]) {
+            glDeleteSync(mFences[FenceIdx]);
+            mFences[FenceIdx] = 0;
+        }
+    }
+
+    if (mBuffer) {
+        if (mPersistent) {
+            glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        MemoryTracker::Untrack(MEMORY_STREAM_BUFFER, mBuffer);
+        MemoryTracker::Untrack(MEMORY_STAGING, mBuffer);
+        glDeleteBuffers(1, &mBuffer);
+        mBuffer = 0;
+    }
+
+    delete[] mStaging;
+    mStaging = 0;
+    mMapped = 0;
+}
+
+void
+UploadRing::BeginFrame() {
+    PROFILE_FUNCTION();
+    mRegion = (mRegion + 1) % mFramesInFlight;
+    mHead = 0;
+    mFlushed = 0;
+    mFrameStats = { 0 };
+    waitForFence(mFences[mRegion]);
+    ++mFrameCount;
+}
+
+void
+UploadRing::EndFrame() {
+    Flush();
+    if (mFences[mRegion]) {
+        glDeleteSync(mFences[mRegion]);
+    }
+    mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+UploadAllocation
+UploadRing::Allocate(unsigned size, unsigned alignment) {
+    UploadAllocation Result = { 0 };
+    unsigned Offset = (mHead + alignment - 1) & ~(alignment - 1);
+    if (!mMapped || Offset + size > mFrameSize) {
+        ++mFrameStats.mOverflows;
+        ++mTotalStats.mOverflows;
+        return Result;
+    }
+
+    mHead = Offset + size;
+    Result.mBuffer = mBuffer;
+    Result.mOffset = regionStart() + Offset;
+    Result.mSize = size;
+    Result.mData = mMapped + Result.mOffset;
+
+    ++mFrameStats.mAllocations;
+    ++mTotalStats.mAllocations;
+    mFrameStats.mBytesUploaded += size;
+    mTotalStats.mBytesUploaded += size;
+    FrameStats::CountUploadBytes(size);
+    return Result;
+}
+
+UploadAllocation
+UploadRing::Write(const void* data, unsigned size, unsigned alignment) {
+    UploadAllocation Result = Allocate(size, alignment);
+    if (!Result.mData) {
+        return Result;
+    }
+
+    memcpy(Result.mData, data, size);
+    if (!mPersistent) {
+        // NOTE: Anything allocated before this write has to reach the buffer first, as it precedes it
+        Flush();
+    }
+    return Result;
+}
+
+UploadAllocation
+UploadRing::WriteUniform(unsigned binding, const void* data, unsigned size) {
+    UploadAllocation Result = Write(data, size, mUniformAlignment);
+    if (Result.mData) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, Result.mBuffer, Result.mOffset, Result.mSize);
+        FrameStats::CountUniformUpload();
+    }
+    return Result;
+}
+
+void
+UploadRing::Flush() {
+    if (mPersistent || mFlushed == mHead) {
+        return;
+    }
+
+    unsigned Start = regionStart() + mFlushed;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, Start, mHead - mFlushed, mStaging + Start);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    mFlushed = mHead;
+}
+
+unsigned
+UploadRing::GetBuffer() const {
+    return mBuffer;
+}
+
+unsigned
+UploadRing::GetUniformAlignment() const {
+    return mUniformAlignment;
+}
+
+bool
+UploadRing::IsPersistent() const {
+    return mPersistent;
+}
+
+const UploadRingStats&
+UploadRing::GetFrameStats() const {
+    return mFrameStats;
+}
+
+const UploadRingStats&
+UploadRing::GetTotalStats() const {
+    return mTotalStats;
+}
+
+unsigned
+UploadRing::GetFrameCount() const {
+    return mFrameCount;
+}
+
+unsigned
+UploadRing::regionStart() const {
+    return mRegion * mFrameSize;
+}
+
+void
+UploadRing::waitForFence(GLsync& fence) {
+    if (!fence) {
+        return;
+    }
+
+    GLenum Status = glClientWaitSync(fence, 0, 0);
+    if (Status == GL_TIMEOUT_EXPIRED) {
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+        // NOTE: One second timeout per iteration, a lost device should not hang the loop silently
+        do {
+            Status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while (Status == GL_TIMEOUT_EXPIRED);
+        double Stall = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count();
+        mFrameStats.mStallTime += Stall;
+        mTotalStats.mStallTime += Stall;
+    }
+
+    glDeleteSync(fence);
+    fence = 0;
+}
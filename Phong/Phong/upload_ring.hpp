@@ -0,0 +1,149 @@
+/**
+ * @file upload_ring.hpp
+ * @brief Persistently mapped ring buffer for per-frame dynamic data
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <GL/glew.h>
+#include <iostream>
+
+/**
+ * @brief A range of the ring reserved for the current frame
+ *
+ * mData is the CPU write pointer, mOffset and mSize describe the range inside
+ * the GL buffer mBuffer. An allocation with mData == 0 means the frame region
+ * is exhausted.
+ */
+struct UploadAllocation {
+    void* mData;
+    unsigned mBuffer;
+    unsigned mOffset;
+    unsigned mSize;
+};
+
+struct UploadRingStats {
+    unsigned mAllocations;
+    unsigned long long mBytesUploaded;
+    unsigned mOverflows;
+    // NOTE: Seconds the CPU spent blocked on the fence of the region being reused
+    double mStallTime;
+};
+
+class UploadRing {
+public:
+    static const unsigned MAX_FRAMES_IN_FLIGHT = 3;
+
+    UploadRing();
+    ~UploadRing();
+
+    /**
+     * @brief Creates the buffer and maps it. Uses glBufferStorage with a persistent,
+     * coherent mapping when available and falls back to glBufferSubData otherwise
+     *
+     * @param frameSize Bytes available to a single frame
+     * @param framesInFlight Number of frame regions the GPU may still be reading from (1-3)
+     *
+     * @returns true - Success, false - Failure
+     */
+    bool Init(unsigned frameSize, unsigned framesInFlight);
+
+    /**
+     * @brief Unmaps and deletes the buffer and all pending fences
+     *
+     */
+    void Destroy();
+
+    /**
+     * @brief Moves to the next frame region, waiting for the GPU to finish reading it
+     *
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Fences the current frame region. Call after the last draw that uses it
+     *
+     */
+    void EndFrame();
+
+    /**
+     * @brief Reserves aligned space in the current frame region. The returned pointer is
+     * written to directly. In fallback mode the data is only sent to the GL once Flush is called
+     *
+     * @param size Size in bytes
+     * @param alignment Required offset alignment, must be a power of two
+     *
+     * @returns Allocation, mData is 0 if the region is exhausted
+     */
+    UploadAllocation Allocate(unsigned size, unsigned alignment);
+
+    /**
+     * @brief Reserves space and copies data into it. Visible to the GL immediately in both modes
+     *
+     * @param data Source data
+     * @param size Size in bytes
+     * @param alignment Required offset alignment, must be a power of two
+     *
+     * @returns Allocation, mData is 0 if the region is exhausted
+     */
+    UploadAllocation Write(const void* data, unsigned size, unsigned alignment);
+
+    /**
+     * @brief Write aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT and binds the range to a block binding
+     *
+     * @param binding Uniform block binding point
+     * @param data Source data
+     * @param size Size in bytes
+     *
+     * @returns Allocation, mData is 0 if the region is exhausted
+     */
+    UploadAllocation WriteUniform(unsigned binding, const void* data, unsigned size);
+
+    /**
+     * @brief Sends data written through Allocate since the last flush. No-op when persistently mapped
+     *
+     */
+    void Flush();
+
+    unsigned GetBuffer() const;
+    unsigned GetUniformAlignment() const;
+    bool IsPersistent() const;
+
+    /**
+     * @brief Returns statistics of the frame started by the last BeginFrame call
+     *
+     * @returns Frame statistics
+     */
+    const UploadRingStats& GetFrameStats() const;
+
+    /**
+     * @brief Returns statistics accumulated over all frames
+     *
+     * @returns Total statistics
+     */
+    const UploadRingStats& GetTotalStats() const;
+    unsigned GetFrameCount() const;
+
+private:
+    unsigned mBuffer;
+    unsigned char* mMapped;
+    unsigned char* mStaging;
+    bool mPersistent;
+    unsigned mFrameSize;
+    unsigned mFramesInFlight;
+    unsigned mRegion;
+    unsigned mHead;
+    unsigned mFlushed;
+    unsigned mUniformAlignment;
+    unsigned mFrameCount;
+    GLsync mFences[MAX_FRAMES_IN_FLIGHT];
+    UploadRingStats mFrameStats;
+    UploadRingStats mTotalStats;
+
+    unsigned regionStart() const;
+    void waitForFence(GLsync& fence);
+};